@@ -16,7 +16,9 @@ std::map<std::string, std::function<void()>> features {
    { "hash", hash_benchmarking },
    { "blake2", blake2_benchmarking },
    { "bls", bls_benchmarking },
-   { "merkle", merkle_benchmarking }
+   { "merkle", merkle_benchmarking },
+   { "block_compression", block_compression_benchmarking },
+   { "resource_limits", resource_limits_benchmarking }
 };
 
 // values to control cout format
@@ -69,7 +71,7 @@ bytes to_bytes(const std::string& source) {
 };
 
 void benchmarking(const std::string& name, const std::function<void()>& func,
-                  std::optional<size_t> opt_num_runs /* = {} */) {
+                  std::optional<size_t> opt_num_runs /* = {} */, size_t ops_per_run /* = 1 */) {
    uint64_t total{0};
    uint64_t min{std::numeric_limits<uint64_t>::max()};
    uint64_t max{0};
@@ -86,7 +88,7 @@ void benchmarking(const std::string& name, const std::function<void()>& func,
       max = std::max(max, duration);
    }
 
-   print_results(name, runs, total, min, max);
+   print_results(name, runs, total/ops_per_run, min/ops_per_run, max/ops_per_run);
 }
 
 } // benchmark
@@ -24,7 +24,11 @@ void hash_benchmarking();
 void blake2_benchmarking();
 void bls_benchmarking();
 void merkle_benchmarking();
+void block_compression_benchmarking();
+void resource_limits_benchmarking();
 
-void benchmarking(const std::string& name, const std::function<void()>& func, std::optional<size_t> num_runs = {});
+// ops_per_run: number of operations done by one call of func, reported times are per operation
+void benchmarking(const std::string& name, const std::function<void()>& func, std::optional<size_t> num_runs = {},
+                  size_t ops_per_run = 1);
 
 } // benchmark
@@ -0,0 +1,70 @@
+#include <benchmark.hpp>
+#include <eosio/testing/tester.hpp>
+#include <fc/compress/zlib.hpp>
+
+#include <iomanip>
+#include <iostream>
+
+using namespace eosio;
+using namespace eosio::chain;
+using namespace eosio::testing;
+
+// Benchmark compression of packed blocks as sent to syncing peers by net_plugin
+// (see p2p-sync-compression-level). Reports time per block for each compression
+// level along with the achieved compression ratio.
+//
+// To run a benchmarking session, in the build directory, type
+//    benchmark/benchmark -f block_compression
+
+namespace eosio::benchmark {
+
+// produce blocks full of newaccount actions, representative of typical action/authority heavy blocks
+std::vector<bytes> create_packed_blocks(uint32_t num_blocks, uint32_t accounts_per_block) {
+   // prevent logging from interwined with output benchmark results
+   fc::logger::get(DEFAULT_LOGGER).set_log_level(fc::log_level::off);
+
+   tester chain;
+   std::vector<bytes> blocks;
+   blocks.reserve(num_blocks);
+   uint64_t n = 0;
+   for (uint32_t b = 0; b < num_blocks; ++b) {
+      vector<account_name> names;
+      for (uint32_t a = 0; a < accounts_per_block; ++a, ++n) {
+         std::string s = "cmp";
+         for (uint64_t v = n; s.size() < 12; v /= 26)
+            s += static_cast<char>('a' + v % 26);
+         names.emplace_back(s);
+      }
+      chain.create_accounts(names);
+      blocks.emplace_back(fc::raw::pack(*chain.produce_block()));
+   }
+   return blocks;
+}
+
+void block_compression_benchmarking() {
+   const std::vector<bytes> blocks = create_packed_blocks(20, 100);
+   size_t total_size = 0;
+   for (const auto& b : blocks)
+      total_size += b.size();
+
+   for (int level : {1, 3, 6, 9}) {
+      std::vector<bytes> compressed(blocks.size());
+      benchmarking("zlib level " + std::to_string(level) + " compress", [&]() {
+         for (size_t i = 0; i < blocks.size(); ++i)
+            compressed[i] = fc::zlib_compress(blocks[i], level);
+      }, {}, blocks.size());
+      benchmarking("zlib level " + std::to_string(level) + " decompress", [&]() {
+         for (size_t i = 0; i < blocks.size(); ++i)
+            fc::zlib_decompress(compressed[i], blocks[i].size());
+      }, {}, blocks.size());
+
+      size_t compressed_size = 0;
+      for (const auto& c : compressed)
+         compressed_size += c.size();
+      std::cout << "   " << blocks.size() << " blocks, " << total_size << " bytes, compressed " << compressed_size
+                << " bytes, ratio " << std::fixed << std::setprecision(2) << double(total_size) / compressed_size
+                << std::endl;
+   }
+}
+
+} // namespace eosio::benchmark
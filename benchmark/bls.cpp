@@ -4,6 +4,7 @@
 #include <eosio/testing/tester.hpp>
 #include <test_contracts.hpp>
 #include <bls12-381/bls12-381.hpp>
+#include <fc/crypto/bls_utils.hpp>
 #include <random>
 
 //This program isn't unit tests. But libtester, because of the way it depends on boost test, will ultimately require implementation of
@@ -431,6 +432,59 @@ void benchmark_bls_fp_exp() {
    benchmarking("bls_fp_exp", benchmarked_func);
 }
 
+// finalizer vote verification benchmarking utility. Reports the per vote cost of
+// verifying each vote of a block individually and of verifying all of them as one batch.
+void benchmark_bls_vote_verify_impl(uint32_t num_finalizers) {
+   using namespace fc::crypto::blslib;
+
+   // every 10th finalizer votes weak, so the batch has two distinct digests like real votes of a block
+   const fc::sha256 strong_digest = fc::sha256::hash(std::to_string(num_finalizers));
+   std::vector<uint8_t> strong_msg{strong_digest.data(), strong_digest.data() + strong_digest.data_size()};
+   std::vector<uint8_t> weak_msg = strong_msg;
+   weak_msg.insert(weak_msg.end(), {'W', 'E', 'A', 'K'});
+
+   std::vector<bls_public_key> pubkeys;
+   std::vector<bls_signature> sigs;
+   std::vector<std::span<const uint8_t>> msgs;
+   pubkeys.reserve(num_finalizers);
+   sigs.reserve(num_finalizers);
+   msgs.reserve(num_finalizers);
+   for (auto i = 0u; i < num_finalizers; ++i) {
+      bls_private_key sk = bls_private_key::generate();
+      const std::vector<uint8_t>& msg = (i % 10 == 9) ? weak_msg : strong_msg;
+      pubkeys.push_back(sk.get_public_key());
+      sigs.push_back(sk.sign(msg));
+      msgs.emplace_back(msg);
+   }
+   std::vector<const bls_public_key*> pubkey_ptrs;
+   std::vector<const bls_signature*> sig_ptrs;
+   for (auto i = 0u; i < num_finalizers; ++i) {
+      pubkey_ptrs.push_back(&pubkeys[i]);
+      sig_ptrs.push_back(&sigs[i]);
+   }
+
+   auto individual_func = [&]() {
+      for (auto i = 0u; i < num_finalizers; ++i) {
+         [[maybe_unused]] bool ok = verify(pubkeys[i], msgs[i], sigs[i]);
+         assert(ok);
+      }
+   };
+   auto batch_func = [&]() {
+      [[maybe_unused]] bool ok = verify_batch(pubkey_ptrs, msgs, sig_ptrs);
+      assert(ok);
+   };
+
+   const std::string finalizers = std::to_string(num_finalizers) + " finalizers";
+   benchmarking("bls vote verify " + finalizers, individual_func, {}, num_finalizers);
+   benchmarking("bls vote batch verify " + finalizers, batch_func, {}, num_finalizers);
+}
+
+// per vote verification cost for typical finalizer set sizes
+void benchmark_bls_vote_verify() {
+   for (uint32_t n : {21u, 100u, 1000u})
+      benchmark_bls_vote_verify_impl(n);
+}
+
 // register benchmarking functions
 void bls_benchmarking() {
    benchmark_bls_g1_add();
@@ -448,5 +502,6 @@ void bls_benchmarking() {
    benchmark_bls_fp_mod();
    benchmark_bls_fp_mul();
    benchmark_bls_fp_exp();
+   benchmark_bls_vote_verify();
 }
 } // namespace benchmark
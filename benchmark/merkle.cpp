@@ -1,6 +1,7 @@
 #include <benchmark.hpp>
 #include <eosio/chain/incremental_merkle.hpp>
 #include <eosio/chain/incremental_merkle_legacy.hpp>
+#include <eosio/chain/merkle_builder.hpp>
 #include <random>
 
 namespace eosio::benchmark {
@@ -54,6 +55,33 @@ void benchmark_incr_merkle(uint32_t size_boost) {
    benchmarking(msg_header + "savanna:", [&]() { incr(incremental_merkle_tree()); }, num_runs);
 }
 
+void benchmark_merkle_builder(uint32_t size_boost) {
+   using namespace std::string_literals;
+   const size_t num_digests = size_boost * 1000ull; // don't use exact powers of 2 as it is a special case
+
+   const std::vector<digest_type> digests = create_test_digests(num_digests);
+
+   auto num_str = std::to_string(size_boost);
+   while(num_str.size() < 4)
+      num_str.insert(0, 1, ' ');
+   auto msg_header = "Bldr, "s + num_str + ",000 digests,  "s;
+   uint32_t num_runs = std::min(get_num_runs(), std::max(1u, get_num_runs() / size_boost));
+
+   // digests folded in as they are produced, in batches of 10 (actions of a transaction), then the root
+   auto build = [&](merkle_builder::algorithm alg) {
+      merkle_builder builder(alg);
+      deque<digest_type> ids;
+      for (size_t i = 0; i < digests.size(); i += 10) {
+         ids.insert(ids.end(), digests.begin() + i, digests.begin() + std::min(i + 10, digests.size()));
+         builder.update(ids);
+      }
+      return builder.root(ids);
+   };
+
+   benchmarking(msg_header + "legacy: ", [&]() { build(merkle_builder::algorithm::legacy); }, num_runs);
+   benchmarking(msg_header + "savanna:", [&]() { build(merkle_builder::algorithm::savanna); }, num_runs);
+}
+
 // register benchmarking functions
 void merkle_benchmarking() {
    benchmark_calc_merkle(1000); // calculate_merkle of very large sequence (1,000,000 digests)
@@ -64,6 +92,10 @@ void merkle_benchmarking() {
    benchmark_incr_merkle(100);  // incremental_merkle of very large sequence (100,000 digests)
    benchmark_incr_merkle(25);   // incremental_merkle of large sequence (25,000 digests)
    benchmark_incr_merkle(1);    // incremental_merkle of small sequence (1000 digests)
+   std::cout << "\n";
+
+   benchmark_merkle_builder(50); // merkle_builder of large sequence (50,000 digests)
+   benchmark_merkle_builder(1);  // merkle_builder of small sequence (1000 digests)
 }
 
 }
\ No newline at end of file
@@ -0,0 +1,71 @@
+#include <benchmark.hpp>
+#include <eosio/chain/resource_limits.hpp>
+#include <eosio/chain/resource_limits_private.hpp>
+#include <chainbase/chainbase.hpp>
+#include <fc/filesystem.hpp>
+
+#include <iostream>
+
+using namespace eosio::chain;
+using namespace eosio::chain::resource_limits;
+
+// Benchmark the resource usage accounting of a block, as done by the controller for every transaction: each
+// transaction updates the usage of its billed accounts in its own undo session, squashed into the block's. The usage
+// is accumulated in memory and written to the resource usage rows once per account in process_block_usage. Blocks
+// bill their transactions round robin to a varying number of accounts, from a single hot account to all accounts.
+// Reports time per block along with the resource usage rows in the undo state of the transactions and of the block.
+//
+// To run a benchmarking session, in the build directory, type
+//    benchmark/benchmark -f resource_limits
+
+namespace eosio::benchmark {
+
+static size_t usage_undo_entries(const chainbase::database& db) {
+   auto undo = db.get_index<resource_usage_index>().last_undo_session();
+   return std::distance(undo.old_values.begin(), undo.old_values.end());
+}
+
+void resource_limits_benchmarking() {
+   constexpr uint32_t num_accounts   = 1000;
+   constexpr uint32_t trxs_per_block = 1000;
+   constexpr uint32_t block_num      = 100;
+
+   fc::temp_directory tempdir;
+   chainbase::database db(tempdir.path(), chainbase::database::read_write, 64*1024*1024);
+   resource_limits_manager rlm(db, [](bool) { return nullptr; });
+   rlm.add_indices();
+   rlm.initialize_database();
+   for (uint32_t a = 1; a <= num_accounts; ++a) {
+      rlm.initialize_account(account_name(a), false);
+      rlm.set_account_limits(account_name(a), -1, -1, -1, false);
+   }
+   rlm.process_account_limit_updates();
+
+   for (uint32_t hot_accounts : {1u, 10u, 100u, num_accounts}) {
+      size_t trx_undo_entries = 0;
+      size_t block_undo_entries = 0;
+      // the block is undone once accounted, so every run starts from the same state
+      auto account_block = [&]() {
+         auto block_session = db.start_undo_session(true);
+         trx_undo_entries = 0;
+         for (uint32_t t = 0; t < trxs_per_block; ++t) {
+            const flat_set<account_name> accounts{account_name(t % hot_accounts + 1)};
+            auto trx_session = db.start_undo_session(true);
+            rlm.update_account_usage(accounts, block_num);
+            rlm.add_transaction_usage(accounts, 100, 100, block_num, false);
+            trx_undo_entries += usage_undo_entries(db);
+            trx_session.squash();
+            rlm.squash_transaction_usage();
+         }
+         rlm.process_block_usage(block_num);
+         block_undo_entries = usage_undo_entries(db);
+         block_session.undo();
+      };
+
+      benchmarking(std::to_string(hot_accounts) + " accounts block", account_block);
+      std::cout << "   " << trxs_per_block << " transactions, " << trx_undo_entries
+                << " usage undo entries in transactions, " << block_undo_entries << " in block" << std::endl;
+   }
+}
+
+} // namespace eosio::benchmark
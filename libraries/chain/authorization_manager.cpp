@@ -102,8 +102,9 @@ namespace eosio { namespace chain {
             return;
          }
 
-         snapshot->write_section<section_t>([this]( auto& section ){
-            decltype(utils)::walk(_db, [this, &section]( const auto &row ) {
+         const size_t num_parts = snapshot->num_section_parts();
+         snapshot->write_section_parts<section_t>(num_parts, [this, num_parts]( auto& section, size_t part ){
+            decltype(utils)::walk_part(_db, part, num_parts, [this, &section]( const auto &row ) {
                section.add_row(row, _db);
             });
          });
@@ -147,6 +148,8 @@ namespace eosio { namespace chain {
          creation_time = _control.pending_block_time();
       }
 
+      authorization_state_changed();
+
       const auto& perm_usage = _db.create<permission_usage_object>([&](auto& p) {
          p.last_used = creation_time;
       });
@@ -183,6 +186,8 @@ namespace eosio { namespace chain {
          creation_time = _control.pending_block_time();
       }
 
+      authorization_state_changed();
+
       const auto& perm_usage = _db.create<permission_usage_object>([&](auto& p) {
          p.last_used = creation_time;
       });
@@ -207,6 +212,8 @@ namespace eosio { namespace chain {
          EOS_ASSERT(k.key.which() < _db.get<protocol_state_object>().num_supported_key_types, unactivated_key_type,
            "Unactivated key type used when modifying permission");
 
+      authorization_state_changed();
+
       _db.modify( permission, [&](permission_object& po) {
          auto dm_logger = _control.get_deep_mind_logger(is_trx_transient);
 
@@ -230,6 +237,8 @@ namespace eosio { namespace chain {
       EOS_ASSERT( range.first == range.second, action_validate_exception,
                   "Cannot remove a permission which has children. Remove the children first.");
 
+      authorization_state_changed();
+
       _db.get_mutable_index<permission_usage_index>().remove_object( permission.usage_id._id );
 
       if (auto dm_logger = _control.get_deep_mind_logger(is_trx_transient)) {
@@ -239,6 +248,23 @@ namespace eosio { namespace chain {
       _db.remove( permission );
    }
 
+   void authorization_manager::clear_authorization_cache() {
+      _authorization_cache.clear();
+      _minimum_permission_cache.clear();
+      _authorization_cache_suspended = false;
+   }
+
+   void authorization_manager::authorization_state_changed() {
+      _authorization_cache.clear();
+      _minimum_permission_cache.clear();
+      _authorization_cache_suspended = true;
+   }
+
+   bool authorization_manager::use_authorization_cache()const {
+      // read-only transactions check authorizations on their own threads outside of the write window
+      return !_authorization_cache_suspended && _control.is_write_window();
+   }
+
    void authorization_manager::update_permission_usage( const permission_object& permission ) {
       const auto& puo = _db.get<permission_usage_object, by_id>( permission.usage_id );
       _db.modify( puo, [&](permission_usage_object& p) {
@@ -302,14 +328,26 @@ namespace eosio { namespace chain {
       }
 
       try {
+         const bool use_cache = use_authorization_cache();
+         const linked_permission_key key{authorizer_account, scope, act_name};
+         if( use_cache ) {
+            if( auto itr = _minimum_permission_cache.find(key); itr != _minimum_permission_cache.end() )
+               return itr->second;
+         }
+
+         std::optional<permission_name> min_permission;
          std::optional<permission_name> linked_permission = lookup_linked_permission(authorizer_account, scope, act_name);
          if( !linked_permission )
-            return config::active_name;
-
-         if( *linked_permission == config::eosio_any_name )
-            return std::optional<permission_name>();
-
-         return linked_permission;
+            min_permission = config::active_name;
+         else if( *linked_permission != config::eosio_any_name )
+            min_permission = linked_permission;
+
+         if( use_cache ) {
+            if( _minimum_permission_cache.size() >= max_authorization_cache_size )
+               _minimum_permission_cache.clear();
+            _minimum_permission_cache.emplace(key, min_permission);
+         }
+         return min_permission;
       } FC_CAPTURE_AND_RETHROW((authorizer_account)(scope)(act_name))
    }
 
@@ -462,6 +500,38 @@ namespace eosio { namespace chain {
 
    std::function<void()> authorization_manager::_noop_checktime{&noop_checktime};
 
+   authorization_manager::permission_check_results*
+   authorization_manager::cached_permission_checks( const flat_set<public_key_type>&  provided_keys,
+                                                    const flat_set<permission_level>& provided_permissions )const
+   {
+      if( !use_authorization_cache() )
+         return nullptr;
+
+      if( _authorization_cache.size() >= max_authorization_cache_size )
+         _authorization_cache.clear();
+      return &_authorization_cache[authorization_cache_key{
+         provided_keys, provided_permissions, _control.get_global_properties().configuration.max_authority_depth
+      }];
+   }
+
+   template<typename Checker>
+   bool authorization_manager::check_permission( Checker& checker, permission_check_results* cached_results,
+                                                 const permission_level& permission, fc::microseconds provided_delay )const
+   {
+      if( !cached_results )
+         return checker.satisfied( permission, provided_delay );
+
+      auto key = std::make_pair( permission, provided_delay );
+      if( auto itr = cached_results->find( key ); itr != cached_results->end() ) {
+         checker.use_keys( itr->second.used_keys );
+         return itr->second.satisfied;
+      }
+
+      permission_check_result result;
+      result.satisfied = checker.satisfied( permission, provided_delay, result.used_keys );
+      return cached_results->emplace( std::move(key), std::move(result) ).first->second.satisfied;
+   }
+
    void
    authorization_manager::check_authorization( const vector<action>&                actions,
                                                const flat_set<public_key_type>&     provided_keys,
@@ -492,6 +562,8 @@ namespace eosio { namespace chain {
                                         checktime
                                       );
 
+      permission_check_results* cached_results = cached_permission_checks( provided_keys, provided_permissions );
+
       map<permission_level, fc::microseconds> permissions_to_satisfy;
 
       for( const auto& act : actions ) {
@@ -550,7 +622,7 @@ namespace eosio { namespace chain {
       // ascending order of the actor name with ties broken by ascending order of the permission name.
       for( const auto& p : permissions_to_satisfy ) {
          checktime(); // TODO: this should eventually move into authority_checker instead
-         EOS_ASSERT( checker.satisfied( p.first, p.second ) || check_but_dont_fail, unsatisfied_authorization,
+         EOS_ASSERT( check_permission( checker, cached_results, p.first, p.second ) || check_but_dont_fail, unsatisfied_authorization,
                      "transaction declares authority '${auth}', "
                      "but does not have signatures for it under a provided delay of ${provided_delay} ms, "
                      "provided permissions ${provided_permissions}, provided keys ${provided_keys}, "
@@ -585,6 +657,8 @@ namespace eosio { namespace chain {
 
       auto delay_max_limit = fc::seconds( _control.get_global_properties().configuration.max_transaction_delay );
 
+      auto effective_provided_delay = ( provided_delay >= delay_max_limit ) ? fc::microseconds::maximum() : provided_delay;
+
       auto checker = make_auth_checker( [&](const permission_level& p) -> const shared_authority* {
                                           if(const permission_object* po = find_permission(p))
                                              return &po->auth;
@@ -594,11 +668,13 @@ namespace eosio { namespace chain {
                                         _control.get_global_properties().configuration.max_authority_depth,
                                         provided_keys,
                                         provided_permissions,
-                                        ( provided_delay >= delay_max_limit ) ? fc::microseconds::maximum() : provided_delay,
+                                        effective_provided_delay,
                                         checktime
                                       );
 
-      EOS_ASSERT( checker.satisfied({account, permission}), unsatisfied_authorization,
+      permission_check_results* cached_results = cached_permission_checks( provided_keys, provided_permissions );
+
+      EOS_ASSERT( check_permission( checker, cached_results, {account, permission}, effective_provided_delay ), unsatisfied_authorization,
                   "permission '${auth}' was not satisfied under a provided delay of ${provided_delay} ms, "
                   "provided permissions ${provided_permissions}, provided keys ${provided_keys}, "
                   "and a delay max limit of ${delay_max_limit_ms} ms",
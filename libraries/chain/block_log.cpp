@@ -5,7 +5,9 @@
 #include <eosio/chain/log_data_base.hpp>
 #include <eosio/chain/log_index.hpp>
 #include <fc/bitutil.hpp>
+#include <fc/compress/zlib.hpp>
 #include <fc/io/raw.hpp>
+#include <future>
 #include <mutex>
 #include <string>
 
@@ -26,7 +28,10 @@ namespace eosio { namespace chain {
    constexpr uint32_t block_log::max_supported_version = genesis_state_or_chain_id_version;
 
    namespace detail {
-      constexpr uint32_t pruned_version_flag = 1 << 31;
+      constexpr uint32_t pruned_version_flag     = 1 << 31;
+      constexpr uint32_t compressed_version_flag = 1 << 30; ///< each block entry is an independently compressed frame
+      constexpr uint32_t version_flags           = pruned_version_flag | compressed_version_flag;
+      constexpr int      compressed_block_level  = 6;       ///< zlib level used when appending to a compressed log
    }
 
    // copy up to n bytes from src to dest
@@ -55,8 +60,9 @@ namespace eosio { namespace chain {
       uint32_t                                   first_block_num = 0;
       std::variant<genesis_state, chain_id_type> chain_context;
 
-      uint32_t version() const { return ver & ~detail::pruned_version_flag; }
+      uint32_t version() const { return ver & ~detail::version_flags; }
       bool     is_currently_pruned() const { return ver & detail::pruned_version_flag; }
+      bool     is_compressed() const { return ver & detail::compressed_version_flag; }
 
       chain_id_type chain_id() const {
          return std::visit(overloaded{ [](const chain_id_type& id) { return id; },
@@ -173,10 +179,62 @@ namespace eosio { namespace chain {
          std::exception_ptr inner;
       };
 
+      /// In a compressed block log each entry is this header followed by the zlib compressed packed block and the
+      /// usual trailing position. The block number is kept uncompressed so entries can be validated without inflating.
+      struct compressed_entry_header {
+         uint32_t block_num         = 0;
+         uint32_t compressed_size   = 0;
+         uint32_t uncompressed_size = 0;
+      };
+      static_assert(sizeof(compressed_entry_header) == 3 * sizeof(uint32_t));
+
+      std::vector<char> pack_compressed_entry(uint32_t block_num, const std::vector<char>& packed_block, int level) {
+         const std::vector<char> compressed = fc::zlib_compress(packed_block, level);
+         const compressed_entry_header header{ block_num, static_cast<uint32_t>(compressed.size()),
+                                               static_cast<uint32_t>(packed_block.size()) };
+         std::vector<char> entry(sizeof(header) + compressed.size());
+         memcpy(entry.data(), &header, sizeof(header));
+         memcpy(entry.data() + sizeof(header), compressed.data(), compressed.size());
+         return entry;
+      }
+
+      /// @return the packed block of a compressed block log entry
+      template <typename Stream>
+      std::vector<char> read_compressed_entry(Stream&& ds, uint32_t expect_block_num) {
+         compressed_entry_header header;
+         ds.read(reinterpret_cast<char*>(&header), sizeof(header));
+         if (expect_block_num != 0) {
+            EOS_ASSERT(header.block_num == expect_block_num, block_log_exception,
+                       "Wrong block was read from block log.",
+                       ("returned", header.block_num)("expected", expect_block_num));
+         }
+         EOS_ASSERT(header.compressed_size <= MAX_SIZE_OF_BYTE_ARRAYS && header.uncompressed_size <= MAX_SIZE_OF_BYTE_ARRAYS,
+                    block_log_exception, "Invalid compressed block entry size for block ${n}", ("n", header.block_num));
+
+         std::vector<char> compressed(header.compressed_size);
+         ds.read(compressed.data(), compressed.size());
+         std::vector<char> packed = fc::zlib_decompress(compressed, header.uncompressed_size);
+         EOS_ASSERT(packed.size() == header.uncompressed_size, block_log_exception,
+                    "Compressed block ${n} inflated to ${s} bytes, expected ${e}",
+                    ("n", header.block_num)("s", packed.size())("e", header.uncompressed_size));
+         return packed;
+      }
+
+      template <typename Stream, typename T>
+      void unpack_block_entry(Stream&& ds, bool compressed, T& v) {
+         if (compressed) {
+            const std::vector<char>     packed = read_compressed_entry(ds, 0);
+            fc::datastream<const char*> packed_ds(packed.data(), packed.size());
+            fc::raw::unpack(packed_ds, v);
+         } else {
+            fc::raw::unpack(ds, v);
+         }
+      }
+
       template <typename Stream>
-      signed_block_ptr read_block(Stream&& ds, uint32_t expect_block_num = 0) {
+      signed_block_ptr read_block(Stream&& ds, bool compressed, uint32_t expect_block_num = 0) {
          auto block = std::make_shared<signed_block>();
-         fc::raw::unpack(ds, *block);
+         unpack_block_entry(ds, compressed, *block);
          if (expect_block_num != 0) {
             EOS_ASSERT(!!block && block->block_num() == expect_block_num, block_log_exception,
                        "Wrong block was read from block log.");
@@ -186,9 +244,9 @@ namespace eosio { namespace chain {
       }
 
       template <typename Stream>
-      signed_block_header read_block_header(Stream&& ds, uint32_t expect_block_num) {
+      signed_block_header read_block_header(Stream&& ds, bool compressed, uint32_t expect_block_num) {
          signed_block_header bh;
-         fc::raw::unpack(ds, bh);
+         unpack_block_entry(ds, compressed, bh);
 
          EOS_ASSERT(bh.block_num() == expect_block_num, block_log_exception,
                     "Wrong block header was read from block log.",
@@ -197,6 +255,21 @@ namespace eosio { namespace chain {
          return bh;
       }
 
+      /// Read a block log entry of entry_size bytes, less its trailing position, without unpacking the block
+      template <typename Stream>
+      std::vector<char> read_serialized_block(Stream&& ds, bool compressed, uint64_t entry_size, uint32_t expect_block_num) {
+         EOS_ASSERT(entry_size > sizeof(uint64_t), block_log_exception, "Invalid block log entry size",
+                    ("size", entry_size)("block_num", expect_block_num));
+         if (compressed)
+            return read_compressed_entry(ds, expect_block_num);
+         std::vector<char> packed(entry_size - sizeof(uint64_t));
+         ds.read(packed.data(), packed.size());
+
+         fc::datastream<const char*> header_ds(packed.data(), packed.size());
+         read_block_header(header_ds, false, expect_block_num);
+         return packed;
+      }
+
       /// Provide the read only view of the blocks.log file
       class block_log_data : public chain::log_data_base<block_log_data> {
          block_log_preamble preamble;
@@ -228,6 +301,7 @@ namespace eosio { namespace chain {
          uint32_t      number_of_blocks();
          chain_id_type chain_id() { return preamble.chain_id(); }
          bool          is_currently_pruned() const { return preamble.is_currently_pruned(); }
+         bool          is_compressed() const { return preamble.is_compressed(); }
          uint64_t      end_of_block_position() const { return is_currently_pruned() ? size() - sizeof(uint32_t) : size(); }
 
          std::optional<genesis_state> get_genesis_state() {
@@ -248,6 +322,10 @@ namespace eosio { namespace chain {
             EOS_ASSERT(position <= size(), block_log_exception, "Invalid block position ${position}",
                        ("position", position));
 
+            // compressed entries start with the block number, see compressed_entry_header
+            if (is_compressed())
+               return read_data_at<uint32_t>(file, position);
+
             int      blknum_offset  = 14;
             uint32_t prev_block_num = read_data_at<uint32_t>(file, position + blknum_offset);
             return fc::endian_reverse_u32(prev_block_num) + 1;
@@ -259,6 +337,56 @@ namespace eosio { namespace chain {
          }
 
          uint64_t remaining() const { return size() - file.tellp(); }
+
+         /// @return the start position of the block entry ending at end_pos, as recorded in its trailer
+         uint64_t block_position_before(uint64_t end_pos) { return read_data_at<uint64_t>(file, end_pos - sizeof(uint64_t)); }
+
+         /**
+          *  Check whether a block entry ends at end_pos, without an index. The trailer before end_pos must point to
+          *  an entry start whose own preceding trailer points to the entry of the previous block number.
+          **/
+         bool is_block_entry_end(uint64_t end_pos) {
+            const uint64_t first_pos = first_block_position();
+            if (end_pos <= first_pos + sizeof(uint64_t) || end_pos > end_of_block_position())
+               return false;
+            const uint64_t pos = block_position_before(end_pos);
+            if (pos < first_pos || pos + sizeof(uint64_t) >= end_pos)
+               return false;
+            const uint32_t block_num = block_num_at(pos);
+            if (pos == first_pos)
+               return block_num == first_block_num();
+            if (block_num <= first_block_num())
+               return false;
+            const uint64_t prev_pos = block_position_before(pos);
+            if (prev_pos < first_pos || prev_pos + sizeof(uint64_t) >= pos)
+               return false;
+            return block_num_at(prev_pos) + 1 == block_num;
+         }
+
+         /// @return the first block entry end at or after from_pos, end_of_block_position() if there is none
+         uint64_t find_block_entry_end(uint64_t from_pos) {
+            const uint64_t     first_pos = first_block_position();
+            const uint64_t     end_pos   = end_of_block_position();
+            std::vector<char>  buf(1024 * 1024);
+            for (uint64_t window = std::max(from_pos, first_pos + sizeof(uint64_t)); window < end_pos;
+                 window += buf.size() - sizeof(uint64_t)) {
+               // buf holds [window - 8, window - 8 + len), candidate q has its trailer at buf[q - window]
+               const uint64_t len = std::min<uint64_t>(buf.size(), end_pos - (window - sizeof(uint64_t)));
+               file.seek(window - sizeof(uint64_t));
+               file.read(buf.data(), len);
+               for (uint64_t offset = 0; offset + sizeof(uint64_t) <= len; ++offset) {
+                  uint64_t pos;
+                  memcpy(&pos, buf.data() + offset, sizeof(pos));
+                  const uint64_t q = window + offset;
+                  // cheap filter before touching the file again
+                  if (pos >= first_pos && pos + sizeof(uint64_t) < q && is_block_entry_end(q))
+                     return q;
+               }
+               if (len < buf.size())
+                  break;
+            }
+            return end_pos;
+         }
          /**
           *  Validate a block log entry WITHOUT deserializing the entire block data.
           **/
@@ -281,7 +409,7 @@ namespace eosio { namespace chain {
             uint64_t pos = file.tellp();
 
             try {
-               fc::raw::unpack(file, entry);
+               unpack_block_entry(file, is_compressed(), entry);
             } catch (...) { throw bad_block_exception{ std::current_exception() }; }
 
             const block_header& header = entry;
@@ -440,6 +568,158 @@ namespace eosio { namespace chain {
          }
       }
 
+      /**
+       *  Build the index of a blocks.log with num_threads threads. The log is split into equal byte ranges; each thread
+       *  finds the first entry boundary after its range and walks the position trailers back to the start of its range,
+       *  writing the positions of the blocks that start in its range. The block ranges are then checked to be contiguous.
+       **/
+      void construct_index_parallel(const std::filesystem::path& block_file_name,
+                                    const std::filesystem::path& index_file_name, uint32_t num_threads) {
+         block_log_data log_data(block_file_name);
+         const uint32_t num_blocks = log_data.number_of_blocks();
+         if (num_threads <= 1 || num_blocks < num_threads || log_data.is_currently_pruned()) {
+            log_data.construct_index(index_file_name);
+            return;
+         }
+
+         const uint64_t first_pos       = log_data.first_block_position();
+         const uint64_t end_pos         = log_data.end_of_block_position();
+         const uint32_t first_block_num = log_data.first_block_num();
+         const uint64_t chunk_size      = (end_pos - first_pos) / num_threads;
+         ilog("Will write new blocks.index file ${file} for ${n} blocks using ${t} threads",
+              ("file", index_file_name)("n", num_blocks)("t", num_threads));
+
+         {
+            fc::cfile index_file;
+            index_file.set_file_path(index_file_name);
+            index_file.open(fc::cfile::truncate_rw_mode);
+         }
+         std::filesystem::resize_file(index_file_name, uint64_t(num_blocks) * sizeof(uint64_t));
+
+         struct chunk_result {
+            uint32_t lowest_block_num  = 0;
+            uint32_t highest_block_num = 0;
+            uint32_t count             = 0;
+         };
+
+         auto index_chunk = [&](uint64_t begin, uint64_t end) {
+            block_log_data log(block_file_name);
+            fc::cfile      index_file;
+            index_file.set_file_path(index_file_name);
+            index_file.open(fc::cfile::update_rw_mode);
+
+            // positions are found in descending block order, write them out in contiguous batches
+            chunk_result          result;
+            std::vector<uint64_t> positions;
+            auto                  flush_positions = [&]() {
+               if (positions.empty())
+                  return;
+               std::reverse(positions.begin(), positions.end());
+               index_file.seek(uint64_t(result.lowest_block_num - first_block_num) * sizeof(uint64_t));
+               index_file.write(reinterpret_cast<const char*>(positions.data()), positions.size() * sizeof(uint64_t));
+               positions.clear();
+            };
+
+            uint64_t current   = end == end_pos ? end_pos : log.find_block_entry_end(end);
+            uint32_t block_num = 0;
+            while (current > first_pos) {
+               const uint64_t pos = log.block_position_before(current);
+               EOS_ASSERT(pos >= first_pos && pos < current, block_log_exception,
+                          "Block log file formatting is incorrect, it contains a block position value: ${pos}, which is "
+                          "not in the range of [${begin_pos},${last_pos})",
+                          ("pos", pos)("begin_pos", first_pos)("last_pos", current));
+               if (pos < begin)
+                  break;
+               block_num = block_num == 0 ? log.block_num_at(pos) : block_num - 1;
+               EOS_ASSERT(block_num >= first_block_num && block_num - first_block_num < num_blocks, block_log_exception,
+                          "Unexpected block number ${n} at position ${pos}", ("n", block_num)("pos", pos));
+               if (pos < end) {
+                  if (result.count++ == 0)
+                     result.highest_block_num = block_num;
+                  result.lowest_block_num = block_num;
+                  positions.push_back(pos);
+                  if (positions.size() == 1024 * 1024)
+                     flush_positions();
+               }
+               current = pos;
+            }
+            flush_positions();
+            return result;
+         };
+
+         std::vector<std::future<chunk_result>> futures;
+         for (uint32_t i = 0; i < num_threads; ++i) {
+            const uint64_t begin = first_pos + i * chunk_size;
+            const uint64_t end   = i + 1 == num_threads ? end_pos : begin + chunk_size;
+            futures.push_back(std::async(std::launch::async, index_chunk, begin, end));
+         }
+
+         // stitch, the chunks must cover every block exactly once in order
+         uint32_t next_block_num = first_block_num;
+         for (auto& f : futures) {
+            const chunk_result result = f.get();
+            if (result.count == 0)
+               continue;
+            EOS_ASSERT(result.lowest_block_num == next_block_num &&
+                             result.highest_block_num - result.lowest_block_num + 1 == result.count,
+                       block_log_exception,
+                       "Parallel index construction found blocks ${l}-${h} where block ${n} was expected next",
+                       ("l", result.lowest_block_num)("h", result.highest_block_num)("n", next_block_num));
+            next_block_num = result.highest_block_num + 1;
+         }
+         EOS_ASSERT(next_block_num - first_block_num == num_blocks, block_log_exception,
+                    "Parallel index construction found ${f} of ${n} blocks",
+                    ("f", next_block_num - first_block_num)("n", num_blocks));
+      }
+
+      /**
+       *  Deserialize blocks [first_block_num, last_block_num] checking their block number, position trailer and
+       *  linkage to the previous block of the range.
+       *
+       *  @returns The previous of the first block and the id of the last block, for linking adjacent ranges
+       **/
+      std::pair<block_id_type, block_id_type> verify_block_range(const std::filesystem::path& block_dir,
+                                                                 uint32_t first_block_num, uint32_t last_block_num) {
+         block_log_bundle log_bundle(block_dir, false);
+         const bool       compressed = log_bundle.log_data.is_compressed();
+         const uint32_t   log_first  = log_bundle.log_data.first_block_num();
+
+         uint64_t      pos = log_bundle.log_index.nth_block_position(first_block_num - log_first);
+         auto&         ds  = log_bundle.log_data.ro_stream_at(pos);
+         signed_block  entry;
+         block_id_type first_previous, id;
+         for (uint32_t block_num = first_block_num; block_num <= last_block_num; ++block_num) {
+            const uint64_t index_pos = log_bundle.log_index.nth_block_position(block_num - log_first);
+            EOS_ASSERT(pos == index_pos, block_log_exception,
+                       "Block ${num} is at position ${pos} but blocks.index has ${index_pos}",
+                       ("num", block_num)("pos", pos)("index_pos", index_pos));
+            unpack_block_entry(ds, compressed, entry);
+
+            const block_id_type previous_id = id;
+            id = entry.calculate_id();
+            EOS_ASSERT(block_header::num_from_id(id) == block_num, block_log_exception,
+                       "Expected block ${num} at position ${pos} but found block ${found}",
+                       ("num", block_num)("pos", pos)("found", block_header::num_from_id(id)));
+            if (block_num == first_block_num)
+               first_previous = entry.previous;
+            else
+               EOS_ASSERT(entry.previous == previous_id, block_log_exception,
+                          "Block ${num} (${id}) does not link back to previous block. "
+                          "Expected previous: ${expected}. Actual previous: ${actual}.",
+                          ("num", block_num)("id", id)("expected", previous_id)("actual", entry.previous));
+
+            uint64_t trailer_pos;
+            ds.read(reinterpret_cast<char*>(&trailer_pos), sizeof(trailer_pos));
+            EOS_ASSERT(trailer_pos == pos, block_log_exception,
+                       "the block position for block ${num} at the end of a block entry is incorrect",
+                       ("num", block_num));
+            pos = ds.tellp();
+            if (block_num % 1000000 == 0)
+               ilog("Verified block ${num}", ("num", block_num));
+         }
+         return { first_previous, id };
+      }
+
    } // namespace
 
    struct block_log_verifier {
@@ -486,6 +766,9 @@ namespace eosio { namespace chain {
 
          virtual signed_block_ptr                   read_block_by_num(uint32_t block_num)        = 0;
          virtual std::optional<signed_block_header> read_block_header_by_num(uint32_t block_num) = 0;
+         virtual std::vector<char>                  read_serialized_block_by_num(uint32_t block_num) = 0;
+         virtual std::vector<std::vector<char>>     read_serialized_block_range(uint32_t first_block_num,
+                                                                                uint32_t last_block_num) = 0;
 
          virtual uint32_t version() const = 0;
 
@@ -519,6 +802,10 @@ namespace eosio { namespace chain {
 
          signed_block_ptr read_block_by_num(uint32_t block_num) final { return {}; };
          std::optional<signed_block_header> read_block_header_by_num(uint32_t block_num) final { return {}; };
+         std::vector<char> read_serialized_block_by_num(uint32_t block_num) final { return {}; }
+         std::vector<std::vector<char>> read_serialized_block_range(uint32_t first_block_num, uint32_t last_block_num) final {
+            return {};
+         }
 
          uint32_t         version() const final { return 0; }
          signed_block_ptr read_head() final { return {}; };
@@ -552,7 +839,7 @@ namespace eosio { namespace chain {
                } else {
                   std::filesystem::resize_file(index_file.get_file_path(), 0);
                }
-               preamble.ver = preamble.version();
+               preamble.ver &= ~pruned_version_flag;
             }
          }
 
@@ -563,6 +850,7 @@ namespace eosio { namespace chain {
          virtual void             post_append(uint64_t pos) {}
          virtual signed_block_ptr retry_read_block_by_num(uint32_t block_num) { return {}; }
          virtual std::optional<signed_block_header> retry_read_block_header_by_num(uint32_t block_num) { return {}; }
+         virtual std::vector<char> retry_read_serialized_block_by_num(uint32_t block_num) { return {}; }
 
          void append(const signed_block_ptr& b, const block_id_type& id,
                      const std::vector<char>& packed_block) override {
@@ -581,7 +869,12 @@ namespace eosio { namespace chain {
                           block_log_append_fail, "Append to index file occuring at wrong position.",
                           ("position", (uint64_t)index_file.tellp())(
                                 "expected", (b->block_num() - preamble.first_block_num) * sizeof(uint64_t)));
-               block_file.write(packed_block.data(), packed_block.size());
+               if (preamble.is_compressed()) {
+                  const auto entry = pack_compressed_entry(b->block_num(), packed_block, compressed_block_level);
+                  block_file.write(entry.data(), entry.size());
+               } else {
+                  block_file.write(packed_block.data(), packed_block.size());
+               }
                block_file.write((char*)&pos, sizeof(pos));
                index_file.write((char*)&pos, sizeof(pos));
                index_file.flush();
@@ -608,7 +901,7 @@ namespace eosio { namespace chain {
                uint64_t pos = get_block_pos(block_num);
                if (pos != block_log::npos) {
                   block_file.seek(pos);
-                  return read_block(block_file, block_num);
+                  return read_block(block_file, preamble.is_compressed(), block_num);
                }
                return retry_read_block_by_num(block_num);
             }
@@ -620,13 +913,83 @@ namespace eosio { namespace chain {
                uint64_t pos = get_block_pos(block_num);
                if (pos != block_log::npos) {
                   block_file.seek(pos);
-                  return read_block_header(block_file, block_num);
+                  return read_block_header(block_file, preamble.is_compressed(), block_num);
                }
                return retry_read_block_header_by_num(block_num);
             }
             FC_LOG_AND_RETHROW()
          }
 
+         // position one past the last block entry of the working block file
+         uint64_t end_of_block_file() {
+            block_file.seek_end(0);
+            uint64_t end = block_file.tellp();
+            if (preamble.is_currently_pruned() && head)
+               end -= sizeof(uint32_t);
+            return end;
+         }
+
+         // end position of the entry of block_num, which must be in the working block file
+         uint64_t end_of_block_pos(uint32_t block_num) {
+            if (block_num < block_header::num_from_id(head->id))
+               return get_block_pos(block_num + 1);
+            return end_of_block_file();
+         }
+
+         std::vector<char> read_serialized_block_by_num(uint32_t block_num) final {
+            try {
+               uint64_t pos = get_block_pos(block_num);
+               if (pos != block_log::npos) {
+                  const uint64_t end = end_of_block_pos(block_num);
+                  block_file.seek(pos);
+                  return read_serialized_block(block_file, preamble.is_compressed(), end - pos, block_num);
+               }
+               return retry_read_serialized_block_by_num(block_num);
+            }
+            FC_LOG_AND_RETHROW()
+         }
+
+         std::vector<std::vector<char>> read_serialized_block_range(uint32_t first_block_num,
+                                                                    uint32_t last_block_num) final {
+            try {
+               std::vector<std::vector<char>> result;
+               if (!head)
+                  return result;
+               last_block_num = std::min(last_block_num, block_header::num_from_id(head->id));
+
+               // blocks before the working block file, e.g. in retained partitioned logs, are read one at a time
+               uint32_t block_num = first_block_num;
+               for (; block_num <= last_block_num && block_num < working_block_file_first_block_num(); ++block_num) {
+                  auto packed = retry_read_serialized_block_by_num(block_num);
+                  if (packed.empty())
+                     return result;
+                  result.push_back(std::move(packed));
+               }
+               if (block_num > last_block_num)
+                  return result;
+
+               const uint32_t        count = last_block_num - block_num + 1;
+               std::vector<uint64_t> positions(count + 1);
+               index_file.seek(sizeof(uint64_t) * (block_num - index_first_block_num()));
+               index_file.read((char*)positions.data(), count * sizeof(uint64_t));
+               positions[count] = end_of_block_pos(last_block_num);
+
+               std::vector<char> entries(positions[count] - positions[0]);
+               block_file.seek(positions[0]);
+               block_file.read(entries.data(), entries.size());
+
+               result.reserve(result.size() + count);
+               for (uint32_t i = 0; i < count; ++i) {
+                  fc::datastream<const char*> ds(entries.data() + (positions[i] - positions[0]),
+                                                 positions[i + 1] - positions[i]);
+                  result.push_back(read_serialized_block(ds, preamble.is_compressed(), positions[i + 1] - positions[i],
+                                                         block_num + i));
+               }
+               return result;
+            }
+            FC_LOG_AND_RETHROW()
+         }
+
          void open(const std::filesystem::path& data_dir) {
 
             if (!std::filesystem::is_directory(data_dir))
@@ -716,7 +1079,7 @@ namespace eosio { namespace chain {
          void reset(uint32_t first_bnum, std::variant<genesis_state, chain_id_type>&& chain_context, uint32_t version) {
 
             block_file.open(fc::cfile::truncate_rw_mode);
-            preamble.ver             = version | (preamble.ver & pruned_version_flag);
+            preamble.ver             = version | (preamble.ver & version_flags);
             preamble.first_block_num = first_bnum;
             preamble.chain_context   = std::move(chain_context);
             preamble.write_to(block_file);
@@ -754,7 +1117,7 @@ namespace eosio { namespace chain {
             auto pos = read_head_position();
             if (pos != block_log::npos) {
                block_file.seek(pos);
-               return read_block(block_file, 0);
+               return read_block(block_file, preamble.is_compressed(), 0);
             } else {
                return {};
             }
@@ -792,7 +1155,7 @@ namespace eosio { namespace chain {
             //  block recovery can get through some blocks.
             size_t copy_to_pos = convert_existing_header_to_vacuumed(first_block_num);
 
-            preamble.ver = block_log::max_supported_version;
+            preamble.ver = block_log::max_supported_version | (preamble.ver & compressed_version_flag);
 
             // if there is no head block though, bail now, otherwise first_block_num won't actually be available
             //  and it'll mess this all up. Be sure to still remove the 4 byte trailer though.
@@ -867,6 +1230,8 @@ namespace eosio { namespace chain {
             fc::raw::unpack(block_file, old_first_block_num);
             EOS_ASSERT(is_pruned_log_and_mask_version(old_version), block_log_exception,
                        "Trying to vacuumed a non-pruned block log");
+            const uint32_t new_version = block_log::max_supported_version | (old_version & compressed_version_flag);
+            old_version &= ~compressed_version_flag;
 
             if (block_log::contains_genesis_state(old_version, old_first_block_num)) {
                // we'll always write a v3 log, but need to possibly mutate the genesis_state to a chainid should we have
@@ -876,7 +1241,7 @@ namespace eosio { namespace chain {
                fc::raw::unpack(ds, gs);
 
                block_file.seek(0);
-               fc::raw::pack(block_file, block_log::max_supported_version);
+               fc::raw::pack(block_file, new_version);
                fc::raw::pack(block_file, first_block_num);
                if (first_block_num == 1) {
                   EOS_ASSERT(old_first_block_num == 1, block_log_exception, "expected an old first blocknum of 1");
@@ -890,7 +1255,7 @@ namespace eosio { namespace chain {
                fc::raw::unpack(block_file, chainid);
 
                block_file.seek(0);
-               fc::raw::pack(block_file, block_log::max_supported_version);
+               fc::raw::pack(block_file, new_version);
                fc::raw::pack(block_file, first_block_num);
                fc::raw::pack(block_file, chainid);
                fc::raw::pack(block_file, totem);
@@ -1007,7 +1372,7 @@ namespace eosio { namespace chain {
             block_file.set_file_path(block_file_path);
             index_file.set_file_path(index_file_path);
 
-            preamble.ver             = block_log::max_supported_version;
+            preamble.ver             = block_log::max_supported_version | (preamble.ver & compressed_version_flag);
             preamble.chain_context   = preamble.chain_id();
             preamble.first_block_num = this->head->ptr->block_num() + 1;
             preamble.write_to(block_file);
@@ -1028,14 +1393,22 @@ namespace eosio { namespace chain {
          signed_block_ptr retry_read_block_by_num(uint32_t block_num) final {
             auto ds = catalog.ro_stream_for_block(block_num);
             if (ds)
-               return read_block(*ds, block_num);
+               return read_block(*ds, catalog.log_data.is_compressed(), block_num);
             return {};
          }
 
          std::optional<signed_block_header> retry_read_block_header_by_num(uint32_t block_num) final {
             auto ds = catalog.ro_stream_for_block(block_num);
             if (ds)
-               return read_block_header(*ds, block_num);
+               return read_block_header(*ds, catalog.log_data.is_compressed(), block_num);
+            return {};
+         }
+
+         std::vector<char> retry_read_serialized_block_by_num(uint32_t block_num) final {
+            auto extent = catalog.get_block_extent(block_num);
+            if (extent)
+               return read_serialized_block(catalog.log_data.ro_stream_at(extent->first),
+                                            catalog.log_data.is_compressed(), extent->second - extent->first, block_num);
             return {};
          }
 
@@ -1086,7 +1459,7 @@ namespace eosio { namespace chain {
 
                // update version
                this->block_file.seek(0);
-               fc::raw::pack(this->block_file, preamble.version() | pruned_version_flag);
+               fc::raw::pack(this->block_file, preamble.ver | pruned_version_flag);
 
                // and write out the trailing block count
                this->block_file.seek_end(0);
@@ -1235,6 +1608,19 @@ namespace eosio { namespace chain {
       return my->read_block_header_by_num(block_num);
    }
 
+   std::vector<char> block_log::read_serialized_block_by_num(uint32_t block_num) const {
+      std::lock_guard g(my->mtx);
+      return my->read_serialized_block_by_num(block_num);
+   }
+
+   std::vector<std::vector<char>> block_log::read_serialized_block_range(uint32_t first_block_num,
+                                                                         uint32_t last_block_num) const {
+      if (first_block_num > last_block_num)
+         return {};
+      std::lock_guard g(my->mtx);
+      return my->read_serialized_block_range(first_block_num, last_block_num);
+   }
+
    block_id_type block_log::read_block_id_by_num(uint32_t block_num) const {
       // read_block_header_by_num acquires mutex
       auto bh = read_block_header_by_num(block_num);
@@ -1268,13 +1654,43 @@ namespace eosio { namespace chain {
    }
 
    // static
-   void block_log::construct_index(const std::filesystem::path& block_file_name, const std::filesystem::path& index_file_name) {
+   void block_log::construct_index(const std::filesystem::path& block_file_name, const std::filesystem::path& index_file_name,
+                                   uint32_t num_threads) {
 
       ilog("Will read existing blocks.log file ${file}", ("file", block_file_name));
       ilog("Will write new blocks.index file ${file}", ("file", index_file_name));
 
-      block_log_data log_data(block_file_name);
-      log_data.construct_index(index_file_name);
+      construct_index_parallel(block_file_name, index_file_name, num_threads);
+   }
+
+   // static
+   void block_log::verify_blocklog(const std::filesystem::path& block_dir, uint32_t num_threads) {
+      block_log_bundle log_bundle(block_dir);
+      const uint32_t   first_block_num = log_bundle.log_data.first_block_num();
+      const uint32_t   num_blocks      = log_bundle.log_index.num_blocks();
+      if (num_blocks == 0)
+         return;
+      num_threads = std::clamp(num_threads, 1u, num_blocks);
+      ilog("Verifying ${n} blocks starting at block ${first} using ${t} threads",
+           ("n", num_blocks)("first", first_block_num)("t", num_threads));
+
+      const uint32_t blocks_per_thread = num_blocks / num_threads;
+      std::vector<std::future<std::pair<block_id_type, block_id_type>>> futures;
+      for (uint32_t i = 0; i < num_threads; ++i) {
+         const uint32_t first = first_block_num + i * blocks_per_thread;
+         const uint32_t last  = i + 1 == num_threads ? first_block_num + num_blocks - 1 : first + blocks_per_thread - 1;
+         futures.push_back(std::async(std::launch::async, verify_block_range, block_dir, first, last));
+      }
+
+      // stitch, the first block of each range must link to the last block of the range before it
+      block_id_type last_id;
+      for (uint32_t i = 0; i < num_threads; ++i) {
+         const auto [first_previous, range_last_id] = futures[i].get();
+         EOS_ASSERT(i == 0 || first_previous == last_id, block_log_exception,
+                    "Block ${num} does not link back to previous block. Expected previous: ${expected}. Actual previous: ${actual}.",
+                    ("num", first_block_num + i * blocks_per_thread)("expected", last_id)("actual", first_previous));
+         last_id = range_last_id;
+      }
    }
 
    std::tuple<uint64_t, uint32_t, std::string>
@@ -1459,6 +1875,18 @@ namespace eosio { namespace chain {
       return detail::is_pruned_log_and_mask_version(version);
    }
 
+   // static
+   bool block_log::is_compressed_log(const std::filesystem::path& data_dir) {
+      uint32_t version = 0;
+      try {
+         fc::cfile log_file;
+         log_file.set_file_path(data_dir / "blocks.log");
+         log_file.open("rb");
+         fc::raw::unpack(log_file, version);
+      } catch (...) { return false; }
+      return version & detail::compressed_version_flag;
+   }
+
    void extract_blocklog_i(block_log_bundle& log_bundle, const std::filesystem::path& new_block_filename, const std::filesystem::path& new_index_filename,
                            uint32_t first_block_num, uint32_t num_blocks) {
 
@@ -1495,7 +1923,8 @@ namespace eosio { namespace chain {
       }
 
       block_log_preamble preamble;
-      preamble.ver             = block_log::max_supported_version;
+      preamble.ver             = block_log::max_supported_version |
+                                 (log_bundle.log_data.get_preamble().ver & detail::compressed_version_flag);
       preamble.first_block_num = first_block_num;
       preamble.chain_context   = log_bundle.log_data.chain_id();
       preamble.write_to(new_block_file);
@@ -1684,6 +2113,7 @@ namespace eosio { namespace chain {
       fc::temp_directory    temp_dir;
       std::filesystem::path temp_path   = temp_dir.path();
       uint32_t              start_block = 0, end_block = 0;
+      bool                  merged_compressed = false;
 
       std::filesystem::path     temp_block_log   = temp_path / "blocks.log";
       std::filesystem::path     temp_block_index = temp_path / "blocks.index";
@@ -1692,9 +2122,10 @@ namespace eosio { namespace chain {
 
       for (auto const& [first_block_num, val] : catalog.collection) {
          if (std::filesystem::exists(temp_block_log)) {
-            if (first_block_num == end_block + 1) {
-               block_log_data log_data;
-               log_data.open(val.filename_base + ".log");
+            block_log_data log_data;
+            log_data.open(val.filename_base + ".log");
+            // block entries can only be concatenated when both files use the same entry format
+            if (first_block_num == end_block + 1 && log_data.is_compressed() == merged_compressed) {
                if (!file.is_open())
                   file.open(fc::cfile::update_rw_mode);
                file.seek_end(0);
@@ -1708,8 +2139,8 @@ namespace eosio { namespace chain {
                continue;
 
             } else
-               wlog("${file}.log cannot be merged with previous block log file because of the discontinuity of blocks, "
-                    "skip merging.",
+               wlog("${file}.log cannot be merged with previous block log file because of the discontinuity of blocks "
+                    "or a different block log format, skip merging.",
                     ("file", val.filename_base));
             // there is a version or block number gap between the stride files
             move_blocklog_files(temp_path, dest_dir, start_block, end_block);
@@ -1717,6 +2148,7 @@ namespace eosio { namespace chain {
 
          std::filesystem::copy(val.filename_base + ".log", temp_block_log);
          std::filesystem::copy(val.filename_base + ".index", temp_block_index);
+         merged_compressed = block_log_data(temp_block_log).is_compressed();
          start_block = first_block_num;
          end_block   = val.last_block_num;
       }
@@ -1729,4 +2161,67 @@ namespace eosio { namespace chain {
       }
    }
 
+   // static
+   void block_log::convert_blocklog(const std::filesystem::path& block_dir, const std::filesystem::path& dest_dir,
+                                    int compression_level) {
+      EOS_ASSERT(compression_level >= 0 && compression_level <= 9, block_log_exception,
+                 "Invalid compression level ${l}, must be between 0 and 9", ("l", compression_level));
+      EOS_ASSERT(block_dir != dest_dir, block_log_exception, "block_dir and dest_dir need to be different directories");
+      // the retained blocks of a pruned log do not start at the first block of its index, vacuum them into a regular log first
+      EOS_ASSERT(!is_pruned_log(block_dir), block_log_unsupported_version,
+                 "${dir} holds a pruned block log, which can not be converted. Vacuum it first with 'spring-util block-log vacuum'",
+                 ("dir", (block_dir / "blocks.log").generic_string()));
+
+      block_log_bundle log_bundle(block_dir);
+      const bool       source_compressed = log_bundle.log_data.is_compressed();
+      const bool       compress          = compression_level > 0;
+
+      if (!std::filesystem::exists(dest_dir))
+         std::filesystem::create_directories(dest_dir);
+
+      block_log_preamble preamble = log_bundle.log_data.get_preamble();
+      preamble.ver                = preamble.version() | (compress ? detail::compressed_version_flag : 0);
+
+      fc::datastream<fc::cfile> new_block_file;
+      new_block_file.set_file_path(dest_dir / "blocks.log");
+      new_block_file.open(fc::cfile::truncate_rw_mode);
+      preamble.write_to(new_block_file);
+      new_block_file.seek_end(0);
+
+      fc::cfile new_index_file;
+      new_index_file.set_file_path(dest_dir / "blocks.index");
+      new_index_file.open(fc::cfile::truncate_rw_mode);
+
+      const uint32_t first_block_num = log_bundle.log_data.first_block_num();
+      const uint32_t num_blocks      = log_bundle.log_index.num_blocks();
+      ilog("Converting ${n} blocks of ${src} to ${dest}, compression level ${l}",
+           ("n", num_blocks)("src", log_bundle.block_file_name)("dest", new_block_file.get_file_path())("l", compression_level));
+
+      for (uint32_t n = 0; n < num_blocks; ++n) {
+         const uint64_t pos = log_bundle.log_index.nth_block_position(n);
+         const uint64_t end = n + 1 < num_blocks ? log_bundle.log_index.nth_block_position(n + 1)
+                                                 : log_bundle.log_data.end_of_block_position();
+         const std::vector<char> packed_block = read_serialized_block(log_bundle.log_data.ro_stream_at(pos),
+                                                                      source_compressed, end - pos, first_block_num + n);
+
+         const uint64_t new_pos = new_block_file.tellp();
+         if (compress) {
+            const auto entry = pack_compressed_entry(first_block_num + n, packed_block, compression_level);
+            new_block_file.write(entry.data(), entry.size());
+         } else {
+            new_block_file.write(packed_block.data(), packed_block.size());
+         }
+         new_block_file.write((const char*)&new_pos, sizeof(new_pos));
+         new_index_file.write((const char*)&new_pos, sizeof(new_pos));
+
+         if ((n & 0xfffff) == 0 && n > 0)
+            ilog("blocks remaining to convert: ${blocks_left}", ("blocks_left", num_blocks - n));
+      }
+      new_block_file.flush();
+      new_index_file.flush();
+
+      ilog("Converted blocks.log of ${s} bytes to ${t} bytes",
+           ("s", log_bundle.log_data.size())("t", std::filesystem::file_size(new_block_file.get_file_path())));
+   }
+
 }} // namespace eosio::chain
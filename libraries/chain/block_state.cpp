@@ -196,6 +196,72 @@ vote_status block_state::aggregate_vote(uint32_t connection_id, const vote_messa
    }
 }
 
+// Called from vote threads
+std::vector<vote_status> block_state::aggregate_votes(std::span<const std::pair<uint32_t, const vote_message*>> votes) {
+   const auto& finalizers = active_finalizer_policy->finalizers;
+   std::vector<vote_status> result(votes.size(), vote_status::success);
+   if (votes.size() == 1) {
+      result[0] = aggregate_vote(votes[0].first, *votes[0].second);
+      return result;
+   }
+
+   // index into finalizers of each vote, -1 if vote does not need signature verification
+   std::vector<ssize_t> indexes(votes.size(), -1);
+   std::vector<const bls_public_key*> pubkeys;
+   std::vector<std::span<const uint8_t>> digests;
+   std::vector<const bls_signature*> sigs;
+   pubkeys.reserve(votes.size());
+   digests.reserve(votes.size());
+   sigs.reserve(votes.size());
+
+   for (size_t i = 0; i < votes.size(); ++i) {
+      const auto& [connection_id, vote] = votes[i];
+      auto it = std::find_if(finalizers.begin(),
+                             finalizers.end(),
+                             [&](const auto& finalizer) { return finalizer.public_key == vote->finalizer_key; });
+      if (it == finalizers.end()) {
+         fc_wlog(vote_logger, "connection - ${c} finalizer_key ${k} in vote is not in finalizer policy",
+                 ("c", connection_id)("k", vote->finalizer_key.to_string().substr(8,16)));
+         result[i] = vote_status::unknown_public_key;
+         continue;
+      }
+      auto index = std::distance(finalizers.begin(), it);
+      if (pending_qc.has_voted(vote->strong, index)) {
+         fc_dlog(vote_logger, "connection - ${c} block_num: ${bn}, duplicate", ("c", connection_id)("bn", block_num()));
+         result[i] = vote_status::duplicate;
+         continue;
+      }
+      indexes[i] = index;
+      pubkeys.push_back(&vote->finalizer_key);
+      digests.push_back(vote->strong ? strong_digest.to_uint8_span() : std::span<const uint8_t>(weak_digest));
+      sigs.push_back(&vote->sig);
+   }
+
+   if (pubkeys.empty())
+      return result;
+
+   const bool batch_verified = pubkeys.size() > 1 && fc::crypto::blslib::verify_batch(pubkeys, digests, sigs);
+   if (!batch_verified && pubkeys.size() > 1)
+      fc_dlog(vote_logger, "block_num: ${bn}, batch verification of ${n} votes failed, verifying individually",
+              ("bn", block_num())("n", pubkeys.size()));
+
+   for (size_t i = 0; i < votes.size(); ++i) {
+      if (indexes[i] < 0)
+         continue;
+      const auto& [connection_id, vote] = votes[i];
+      auto index = indexes[i];
+      if (batch_verified) {
+         result[i] = pending_qc.add_verified_vote(connection_id, block_num(), vote->strong, index, vote->sig,
+                                                  finalizers[index].weight);
+      } else {
+         auto digest = vote->strong ? strong_digest.to_uint8_span() : std::span<const uint8_t>(weak_digest);
+         result[i] = pending_qc.add_vote(connection_id, block_num(), vote->strong, digest, index,
+                                         vote->finalizer_key, vote->sig, finalizers[index].weight);
+      }
+   }
+   return result;
+}
+
 vote_status_t block_state::has_voted(const bls_public_key& key) const {
    const auto& finalizers = active_finalizer_policy->finalizers;
    auto it = std::find_if(finalizers.begin(),
@@ -151,6 +151,12 @@ vote_status pending_quorum_certificate::add_vote(uint32_t connection_id, block_n
       return vote_status::invalid_signature;
    }
 
+   return add_verified_vote(connection_id, block_num, strong, index, sig, weight);
+}
+
+// thread safe
+vote_status pending_quorum_certificate::add_verified_vote(uint32_t connection_id, block_num_type block_num,
+                                                          bool strong, size_t index, const bls_signature& sig, uint64_t weight) {
    std::unique_lock g(*_mtx);
    state_t pre_state = pending_state;
    vote_status s = strong ? add_strong_vote(index, sig, weight)
@@ -9,6 +9,8 @@
 
 #include <boost/range/algorithm/find.hpp>
 #include <boost/algorithm/cxx11/all_of.hpp>
+#include <boost/container/flat_map.hpp>
+#include <boost/container/small_vector.hpp>
 
 #include <functional>
 
@@ -67,7 +69,10 @@ namespace detail {
             permission_satisfied
          };
 
-         typedef map<permission_level, permission_cache_status> permission_cache_type;
+         // authorities rarely reference more than a few permissions, so keep them inline and sorted instead of in a node based map
+         typedef boost::container::flat_map<permission_level, permission_cache_status, std::less<permission_level>,
+                                            boost::container::small_vector<std::pair<permission_level, permission_cache_status>, 8>>
+                 permission_cache_type;
 
          bool satisfied( const permission_level& permission,
                          fc::microseconds override_provided_delay,
@@ -93,6 +98,38 @@ namespace detail {
             return ( visitor(permission_level_weight{permission, 1}) > 0 );
          }
 
+         /**
+          * Like satisfied( permission, override_provided_delay ), but also sets keys_used to the provided keys, in the order of
+          * provided_keys, which satisfy permission. These do not depend on the keys used by earlier calls, so a result can be
+          * reused by another checker with the same provided keys, permissions and recursion depth limit through use_keys().
+          */
+         bool satisfied( const permission_level& permission,
+                         fc::microseconds override_provided_delay,
+                         vector<bool>& keys_used
+                       )
+         {
+            vector<bool> prior_used_keys(_used_keys.size(), false);
+            std::swap(prior_used_keys, _used_keys);
+            auto used_keys_merger = fc::make_scoped_exit( [&]() {
+               keys_used = _used_keys;
+               for( size_t i = 0; i < prior_used_keys.size(); ++i ) {
+                  if( prior_used_keys[i] )
+                     _used_keys[i] = true;
+               }
+            });
+
+            return satisfied( permission, override_provided_delay );
+         }
+
+         /// marks keys, in the order of provided_keys, as used
+         void use_keys( const vector<bool>& keys ) {
+            EOS_ASSERT( keys.size() == _used_keys.size(), authorization_exception, "mismatched number of provided keys" );
+            for( size_t i = 0; i < keys.size(); ++i ) {
+               if( keys[i] )
+                  _used_keys[i] = true;
+            }
+         }
+
          template<typename AuthorityType>
          bool satisfied( const AuthorityType& authority,
                          fc::microseconds override_provided_delay,
@@ -223,7 +260,6 @@ namespace detail {
                if( !status ) {
                   if( recursion_depth < checker.recursion_depth_limit ) {
                      bool r = false;
-                     typename permission_cache_type::iterator itr = cached_permissions.end();
 
                      std::invoke_result_t<decltype(checker.permission_to_authority), const permission_level> auth = nullptr;
                      try {
@@ -234,15 +270,15 @@ namespace detail {
                      if(!auth)
                         return total_weight;
 
-                     auto res = cached_permissions.emplace( permission.permission, being_evaluated );
-                     itr = res.first;
+                     cached_permissions.emplace( permission.permission, being_evaluated );
                      r = checker.satisfied( *auth, cached_permissions, recursion_depth + 1 );
 
+                     // the permissions evaluated by the recursion invalidate iterators in to cached_permissions
                      if( r ) {
                         total_weight += permission.weight;
-                        itr->second = permission_satisfied;
+                        cached_permissions[permission.permission] = permission_satisfied;
                      } else {
-                        itr->second = permission_unsatisfied;
+                        cached_permissions[permission.permission] = permission_unsatisfied;
                      }
                   }
                } else if( *status == permission_satisfied ) {
@@ -6,6 +6,7 @@
 
 #include <utility>
 #include <functional>
+#include <map>
 
 namespace eosio { namespace chain {
 
@@ -115,12 +116,60 @@ namespace eosio { namespace chain {
                                                     )const;
 
 
+         /**
+          * Forget the authorization checks cached since the start of the previous block, and resume caching if it was
+          * suspended by authorization_state_changed(). Called by controller at the start of each block.
+          */
+         void clear_authorization_cache();
+
+         /**
+          * Called when a permission or permission link is created, modified or removed. The change may be undone along
+          * with its transaction, so the cache is cleared and not used again until the next block.
+          */
+         void authorization_state_changed();
+
          static std::function<void()> _noop_checktime;
 
       private:
          const controller&    _control;
          chainbase::database& _db;
 
+         // Results of check_authorization of transactions of the block, reused by the next transactions which check the
+         // same permissions with the same provided keys, so that hot accounts with multi-level authorities do not walk
+         // their permissions again and again. Only used by the main thread in the write window.
+         struct authorization_cache_key {
+            flat_set<public_key_type>  provided_keys;
+            flat_set<permission_level> provided_permissions;
+            uint16_t                   max_authority_depth = 0;
+
+            friend bool operator<( const authorization_cache_key& a, const authorization_cache_key& b ) {
+               return std::tie(a.max_authority_depth, a.provided_permissions, a.provided_keys) <
+                      std::tie(b.max_authority_depth, b.provided_permissions, b.provided_keys);
+            }
+         };
+         struct permission_check_result {
+            bool         satisfied = false;
+            vector<bool> used_keys; // in the order of the provided keys
+         };
+         using permission_check_results = std::map<std::pair<permission_level, fc::microseconds>, permission_check_result>;
+         using linked_permission_key    = std::tuple<account_name, scope_name, action_name>;
+
+         static constexpr size_t max_authorization_cache_size = 16*1024;
+
+         mutable std::map<authorization_cache_key, permission_check_results>              _authorization_cache;
+         mutable std::map<linked_permission_key, std::optional<permission_name>>          _minimum_permission_cache;
+         bool                                                                             _authorization_cache_suspended = false;
+
+         bool use_authorization_cache()const;
+
+         // @return the cached results of checks with these provided keys and permissions, or nullptr if not caching
+         permission_check_results* cached_permission_checks( const flat_set<public_key_type>&  provided_keys,
+                                                             const flat_set<permission_level>& provided_permissions )const;
+
+         template<typename Checker>
+         bool check_permission( Checker& checker, permission_check_results* cached_results, const permission_level& permission,
+                                fc::microseconds provided_delay )const;
+
          void             check_updateauth_authorization( const updateauth& update, const vector<permission_level>& auths )const;
          void             check_deleteauth_authorization( const deleteauth& del, const vector<permission_level>& auths )const;
          void             check_linkauth_authorization( const linkauth& link, const vector<permission_level>& auths )const;
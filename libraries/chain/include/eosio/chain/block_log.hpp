@@ -36,6 +36,10 @@ namespace eosio { namespace chain {
     * how many blocks at the end of the log are valid. Any earlier blocks in the log are assumed destroyed
     * and unreadable due to reclamation for purposes of saving space.
     *
+    * An optional "compressed" format, created with convert_blocklog(), stores each block as an independently
+    * zlib compressed frame preceded by its block number and sizes. The positions and index are unchanged, so
+    * random access still takes a single index lookup and read. Blocks appended to a compressed log are compressed.
+    *
     * Object thread-safe. Not safe to have multiple block_log objects to same data_dir.
     */
 
@@ -57,6 +61,19 @@ namespace eosio { namespace chain {
          std::optional<signed_block_header> read_block_header_by_num(uint32_t block_num)const;
          block_id_type    read_block_id_by_num(uint32_t block_num)const;
 
+         /**
+          * Return the serialized (fc::raw packed) signed_block exactly as stored in the log, without
+          * deserializing it. Empty if block_num is not in the log.
+          */
+         std::vector<char> read_serialized_block_by_num(uint32_t block_num)const;
+
+         /**
+          * Return the serialized blocks [first_block_num, last_block_num] as stored in the log. Blocks in the
+          * current log file are read with a single index read and a single block file read. The result stops
+          * at the first block not available in the log, so it may be shorter than requested.
+          */
+         std::vector<std::vector<char>> read_serialized_block_range(uint32_t first_block_num, uint32_t last_block_num)const;
+
          signed_block_ptr read_block_by_id(const block_id_type& id)const {
             return read_block_by_num(block_header::num_from_id(id));
          }
@@ -94,7 +111,18 @@ namespace eosio { namespace chain {
          extract_chain_id(const std::filesystem::path& data_dir,
                           const std::filesystem::path& retained_dir = std::filesystem::path{});
 
-         static void construct_index(const std::filesystem::path& block_file_name, const std::filesystem::path& index_file_name);
+         /**
+          * @param num_threads more than one splits blocks.log into byte ranges indexed concurrently, the entry boundaries
+          *        of each range are located from the position trailers
+          */
+         static void construct_index(const std::filesystem::path& block_file_name, const std::filesystem::path& index_file_name,
+                                     uint32_t num_threads = 1);
+
+         /**
+          * Deserialize every block of blocks.log in block_dir, checking block numbers, ids, position trailers, the index and
+          * the previous linkage. Contiguous block ranges are verified concurrently by num_threads threads.
+          */
+         static void verify_blocklog(const std::filesystem::path& block_dir, uint32_t num_threads);
 
          static bool contains_genesis_state(uint32_t version, uint32_t first_block_num);
 
@@ -121,6 +149,16 @@ namespace eosio { namespace chain {
 
          static void split_blocklog(const std::filesystem::path& block_dir, const std::filesystem::path& dest_dir, uint32_t stride);
          static void merge_blocklogs(const std::filesystem::path& block_dir, const std::filesystem::path& dest_dir);
+
+         static bool is_compressed_log(const std::filesystem::path& data_dir);
+
+         /**
+          * Rewrite blocks.log and blocks.index of block_dir into dest_dir.
+          * @param compression_level 1-9 stores each block as an independently zlib compressed entry so that random
+          *        access stays a single index lookup and read; 0 writes an uncompressed log.
+          */
+         static void convert_blocklog(const std::filesystem::path& block_dir, const std::filesystem::path& dest_dir,
+                                      int compression_level);
    private:
          std::unique_ptr<detail::block_log_impl> my;
    };
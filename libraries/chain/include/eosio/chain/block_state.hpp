@@ -88,6 +88,7 @@ private:
    // ------ data members caching information available elsewhere ----------------------
    bool                       pub_keys_recovered = false;
    deque<transaction_metadata_ptr> cached_trxs;
+   std::vector<recover_keys_shared_future> recovering_trxs; // key recovery of packed trxs started when added to fork_db
    digest_type                action_mroot; // For finality_data sent to SHiP
    std::optional<digest_type> base_digest;  // For finality_data sent to SHiP, computed on demand in get_finality_data()
 
@@ -140,6 +141,9 @@ public:
 
    // connection_id only for logging
    vote_status aggregate_vote(uint32_t connection_id, const vote_message& vote); // aggregate vote into pending_qc
+   // aggregate votes for this block into pending_qc verifying all signatures with one batch check,
+   // falls back to per vote verification if the batch check fails. Returns a status for each vote in order.
+   std::vector<vote_status> aggregate_votes(std::span<const std::pair<uint32_t, const vote_message*>> votes);
    vote_status_t has_voted(const bls_public_key& key) const;
    vote_info_vec get_votes() const;                          // for testing, returns vote info from pending_qc
    void verify_qc(const valid_quorum_certificate& qc) const; // verify given qc is valid with respect block_state
@@ -53,6 +53,11 @@ namespace eosio::chain {
       const producer_authority_schedule*     pending_schedule_auth() const { return &block_header_state_legacy::pending_schedule.schedule; }
       const deque<transaction_metadata_ptr>& trxs_metas()            const { return _cached_trxs; }
 
+      // heuristic for determination if we are syncing or replaying for optimizations
+      bool is_recent() const {
+         return timestamp() > fc::time_point::now() - fc::seconds(30);
+      }
+
       
       using fork_db_block_state_accessor_t = block_state_legacy_accessor;
    private: // internal use only, not thread safe
@@ -82,6 +87,8 @@ namespace eosio::chain {
       /// this data is redundant with the data stored in block, but facilitates
       /// recapturing transactions when we pop a block
       deque<transaction_metadata_ptr>                    _cached_trxs;
+      /// key recovery of packed trxs started when added to fork_db, consumed by apply_block
+      std::vector<recover_keys_shared_future>            recovering_trxs;
 
       // to be used during Legacy to Savanna transistion where action_mroot
       // needs to be converted from Legacy merkle to Savanna merkle
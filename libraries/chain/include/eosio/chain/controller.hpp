@@ -14,6 +14,8 @@
 
 #include <boost/signals2/signal.hpp>
 
+#include <map>
+
 
 namespace chainbase {
    class database;
@@ -101,6 +103,8 @@ namespace eosio::chain {
             uint32_t                 terminate_at_block     = 0;
             bool                     integrity_hash_on_start= false;
             bool                     integrity_hash_on_stop = false;
+            bool                     sync_prefetch          = false;
+            uint32_t                 sync_recover_keys_blocks = 32; //< keys of trxs are recovered for this many blocks ahead of head while syncing
 
             wasm_interface::vm_type  wasm_runtime = chain::config::default_wasm_runtime;
             eosvmoc::config          eosvmoc_config;
@@ -286,6 +290,9 @@ namespace eosio::chain {
 
          // thread-safe
          signed_block_ptr fetch_block_by_number( uint32_t block_num )const;
+         // thread-safe, packed signed_block; irreversible blocks are returned as stored in the block log
+         // without unpacking. Empty if block_num is not available.
+         std::vector<char> fetch_serialized_block_by_number( uint32_t block_num )const;
          // thread-safe
          signed_block_ptr fetch_block_by_id( const block_id_type& id )const;
          // thread-safe
@@ -350,6 +357,9 @@ namespace eosio::chain {
          // thread safe, for testing
          std::optional<finalizer_policy> active_finalizer_policy(const block_id_type& id) const;
 
+         // for testing, key recovery started for the trxs of the fork database blocks not yet applied, by block number
+         std::map<uint32_t, std::vector<recover_keys_shared_future>> get_recovering_keys() const;
+
          bool light_validation_allowed() const;
          bool skip_auth_check()const;
          bool skip_trx_checks()const;
@@ -384,6 +394,12 @@ namespace eosio::chain {
 #endif
 #ifdef EOSIO_EOS_VM_OC_RUNTIME_ENABLED
          bool is_eos_vm_oc_enabled() const;
+         // thread safe, as of the last irreversible block, without codes
+         wasm_interface::eosvmoc_stats get_eos_vm_oc_metrics() const;
+         // with up to limit codes of the most cpu; main thread, write window only
+         wasm_interface::eosvmoc_stats get_eos_vm_oc_stats(uint32_t limit) const;
+         // while producing blocks, EOS VM OC compiles are limited to eos-vm-oc-compile-threads; main thread only
+         void limit_eos_vm_oc_compile_threads(bool limit);
 #endif
 
          static std::optional<uint64_t> convert_exception_to_error_code( const fc::exception& e );
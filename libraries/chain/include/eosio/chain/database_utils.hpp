@@ -1,6 +1,7 @@
 #pragma once
 
 #include <eosio/chain/types.hpp>
+#include <eosio/chain/multi_index_includes.hpp>
 #include <fc/io/raw.hpp>
 #include <softfloat.hpp>
 
@@ -24,6 +25,29 @@ namespace eosio::chain {
             }
          }
 
+         /**
+          * Walks, in id order, part part_index of num_parts parts of the rows of the index; the parts cover about
+          * equal ranges of ids, so that walking every part in order is the same as walk()
+          */
+         template<typename F>
+         static void walk_part( const chainbase::database& db, size_t part_index, size_t num_parts, F function ) {
+            using id_type = typename index_t::value_type::id_type;
+            const auto& idx = db.get_index<Index, by_id>();
+            if (idx.begin() == idx.end())
+               return;
+
+            const int64_t first = idx.begin()->id._id;
+            const int64_t last  = std::prev(idx.end())->id._id;
+            auto part_begin = [&](size_t i) {
+               return id_type(first + static_cast<int64_t>(static_cast<__int128>(last - first + 1) * i / num_parts));
+            };
+            auto begin_itr = part_index == 0 ? idx.begin() : idx.lower_bound(part_begin(part_index));
+            auto end_itr   = part_index + 1 >= num_parts ? idx.end() : idx.lower_bound(part_begin(part_index + 1));
+            for (auto itr = begin_itr; itr != end_itr; ++itr) {
+               function(*itr);
+            }
+         }
+
          template<typename Secondary, typename Key, typename F>
          static void walk_range( const chainbase::database& db, const Key& begin_key, const Key& end_key, F function ) {
             const auto& idx = db.get_index<Index, Secondary>();
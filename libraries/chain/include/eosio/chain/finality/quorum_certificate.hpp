@@ -118,9 +118,20 @@ namespace eosio::chain {
                            const bls_signature& sig,
                            uint64_t weight);
 
+      // thread safe, sig must already be verified against the finalizer digest by the caller
+      vote_status add_verified_vote(uint32_t connection_id,
+                                    block_num_type block_num,
+                                    bool strong,
+                                    size_t index,
+                                    const bls_signature& sig,
+                                    uint64_t weight);
+
       // thread safe
       bool has_voted(size_t index) const;
 
+      // thread safe
+      bool has_voted(bool strong, size_t index) const { std::lock_guard g(*_mtx); return has_voted_no_lock(strong, index); }
+
       // for debugging, thread safe
       template<class CB>
       void visit_votes(const CB& cb) const {
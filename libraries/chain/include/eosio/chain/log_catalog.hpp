@@ -159,6 +159,17 @@ struct log_catalog {
       }
    }
 
+   /// @return [begin, end) file positions in log_data of the log entry for block_num
+   std::optional<std::pair<uint64_t, uint64_t>> get_block_extent(uint32_t block_num) {
+      auto pos = get_block_position(block_num);
+      if (!pos)
+         return {};
+      const uint32_t n   = block_num - log_data.first_block_num();
+      const uint64_t end = n + 1 < log_index.num_blocks() ? log_index.nth_block_position(n + 1)
+                                                          : log_data.end_of_block_position();
+      return std::make_pair(*pos, end);
+   }
+
    fc::datastream<fc::cfile>* ro_stream_for_block(uint32_t block_num) {
       auto pos = get_block_position(block_num);
       if (pos) {
@@ -0,0 +1,137 @@
+#pragma once
+#include <eosio/chain/merkle.hpp>
+#include <eosio/chain/merkle_legacy.hpp>
+
+namespace eosio::chain {
+
+/**
+ * Computes the merkle root of a growing sequence of leaf digests, folding the leaves into the tree as they are
+ * produced so that only O(log n) hashes are left to do when the root is needed.
+ *
+ * The leaves themselves are owned by the caller (e.g. the `deque` of action receipt digests of the building block),
+ * the builder keeps every complete interior node: `levels[k]` holds the roots of the complete subtrees of
+ * 2^(k+1) leaves, so a level only ever grows at its end. Sibling pairs which became complete since the last update
+ * are hashed level by level in one batch through `fc::sha256::hash_pairs`.
+ *
+ * `root()` returns the same digest as `calculate_merkle` (savanna) or `calculate_merkle_legacy` (legacy) of the
+ * leaves, and `resize()` truncates the tree to a previous leaf count when a transaction is rolled back.
+ */
+class merkle_builder {
+public:
+   enum class algorithm { legacy, savanna };
+
+   explicit merkle_builder(algorithm alg) : alg(alg) {}
+
+   algorithm get_algorithm() const { return alg; }
+   size_t    num_leaves() const { return leaves; }
+
+   /// fold leaves [num_leaves(), ids.size()) into the tree
+   template <class Cont>
+   void update(const Cont& ids) {
+      assert(ids.size() >= leaves);
+      if (ids.size() == leaves)
+         return;
+
+      // level 0: pairs of leaves. Only the new, complete pairs are hashed.
+      const size_t first_pair = leaves / 2;
+      const size_t last_pair  = ids.size() / 2;
+      leaves = ids.size();
+      if (first_pair == last_pair)
+         return;
+      if (levels.empty())
+         levels.emplace_back();
+      siblings.clear();
+      for (size_t i = first_pair * 2; i < last_pair * 2; ++i)
+         siblings.push_back(ids[i]);
+      hash_siblings(levels[0]);
+
+      // higher levels: fold the complete pairs of the level below
+      for (size_t k = 1; levels[k - 1].size() / 2 > (k < levels.size() ? levels[k].size() : 0); ++k) {
+         if (k == levels.size())
+            levels.emplace_back();
+         const auto& below = levels[k - 1];
+         siblings.assign(below.begin() + levels[k].size() * 2, below.begin() + (below.size() / 2) * 2);
+         hash_siblings(levels[k]);
+      }
+   }
+
+   /// drop all leaves past the first n, n must not exceed num_leaves()
+   void resize(size_t n) {
+      assert(n <= leaves);
+      leaves = n;
+      for (size_t k = 0; k < levels.size(); ++k)
+         levels[k].resize(std::min(levels[k].size(), n >> (k + 1)));
+   }
+
+   /// merkle root of ids, which must extend the leaves already folded in
+   template <class Cont>
+   digest_type root(const Cont& ids) {
+      update(ids);
+      return alg == algorithm::savanna ? savanna_root(ids) : legacy_root(ids);
+   }
+
+private:
+   // complete node at level k (level 0 being the leaves), index i
+   template <class Cont>
+   const digest_type& node(const Cont& ids, size_t k, size_t i) const {
+      return k == 0 ? ids[i] : levels[k - 1][i];
+   }
+
+   void hash_siblings(std::vector<digest_type>& level) {
+      if (alg == algorithm::legacy) {
+         for (size_t i = 0; i < siblings.size(); i += 2) {
+            siblings[i]     = detail::make_legacy_left_digest(siblings[i]);
+            siblings[i + 1] = detail::make_legacy_right_digest(siblings[i + 1]);
+         }
+      }
+      const size_t first = level.size();
+      level.resize(first + siblings.size() / 2);
+      digest_type::hash_pairs(siblings, std::span<digest_type>(level.data() + first, siblings.size() / 2));
+   }
+
+   // calculate_merkle splits the leaves at the largest power of two, so the root combines, from the right, the
+   // complete subtree of each set bit of the leaf count
+   template <class Cont>
+   digest_type savanna_root(const Cont& ids) const {
+      if (leaves == 0)
+         return {};
+      std::optional<digest_type> right;
+      for (size_t k = 0, end = leaves; end; ++k) {
+         if ((leaves >> k) & 1) {
+            end -= size_t(1) << k;
+            const auto& n = node(ids, k, end >> k);
+            right = right ? detail::hash_combine(n, *right) : n;
+         }
+      }
+      return *right;
+   }
+
+   // calculate_merkle_legacy duplicates the last node of a level with an odd count. At most the last node of each
+   // level is not complete, so only that tail is computed here.
+   template <class Cont>
+   digest_type legacy_root(const Cont& ids) const {
+      if (leaves == 0)
+         return {};
+      auto combine = [](const digest_type& l, const digest_type& r) {
+         return digest_type::hash(detail::make_legacy_digest_pair(l, r));
+      };
+      std::optional<digest_type> tail;
+      size_t complete = leaves;
+      size_t k        = 0;
+      for (; complete + (tail ? 1 : 0) > 1; ++k) {
+         if (complete % 2)
+            tail = combine(node(ids, k, complete - 1), tail ? *tail : node(ids, k, complete - 1));
+         else if (tail)
+            tail = combine(*tail, *tail);
+         complete /= 2;
+      }
+      return tail ? *tail : node(ids, k, 0);
+   }
+
+   algorithm                             alg;
+   size_t                                leaves = 0;
+   std::vector<std::vector<digest_type>> levels;
+   std::vector<digest_type>              siblings;
+};
+
+} /// eosio::chain
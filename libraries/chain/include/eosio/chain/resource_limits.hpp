@@ -6,6 +6,7 @@
 #include <eosio/chain/snapshot.hpp>
 #include <eosio/chain/block_timestamp.hpp>
 #include <chainbase/chainbase.hpp>
+#include <memory>
 #include <set>
 
 namespace eosio { namespace chain {
@@ -64,10 +65,8 @@ namespace eosio { namespace chain {
    class resource_limits_manager {
       public:
 
-         explicit resource_limits_manager(chainbase::database& db, std::function<deep_mind_handler*(bool is_trx_transient)> get_deep_mind_logger)
-         :_db(db),_get_deep_mind_logger(get_deep_mind_logger)
-         {
-         }
+         explicit resource_limits_manager(chainbase::database& db, std::function<deep_mind_handler*(bool is_trx_transient)> get_deep_mind_logger);
+         ~resource_limits_manager();
 
          void add_indices();
          void initialize_database();
@@ -77,8 +76,18 @@ namespace eosio { namespace chain {
          void initialize_account( const account_name& account, bool is_trx_transient );
          void set_block_parameters( const elastic_limit_parameters& cpu_limit_parameters, const elastic_limit_parameters& net_limit_parameters );
 
+         /**
+          * The cpu and net usage of accounts is accumulated in memory for the pending block, and only written to their
+          * resource_usage_object by process_block_usage. The usage updates of a transaction are not undone along with
+          * its undo session: whoever undoes the session of a transaction that updated usage calls
+          * undo_transaction_usage, and squash_transaction_usage once it is squashed. undo_block_usage drops the usage
+          * of an aborted block.
+          */
          void update_account_usage( const flat_set<account_name>& accounts, uint32_t ordinal );
          void add_transaction_usage( const flat_set<account_name>& accounts, uint64_t cpu_usage, uint64_t net_usage, uint32_t ordinal, bool is_trx_transient = false );
+         void squash_transaction_usage();
+         void undo_transaction_usage();
+         void undo_block_usage();
 
          void add_pending_ram_usage( const account_name account, int64_t ram_delta, bool is_trx_transient = false );
          void verify_account_ram_usage( const account_name accunt )const;
@@ -113,8 +122,11 @@ namespace eosio { namespace chain {
          int64_t get_account_ram_usage( const account_name& name ) const;
 
       private:
+         struct pending_usage;
+
          chainbase::database&         _db;
          std::function<deep_mind_handler*(bool is_trx_transient)> _get_deep_mind_logger;
+         std::unique_ptr<pending_usage> _pending_usage;
    };
 } } } /// eosio::chain
 
@@ -4,8 +4,12 @@
 #include <eosio/chain/exceptions.hpp>
 #include <fc/variant_object.hpp>
 #include <boost/core/demangle.hpp>
+#include <deque>
+#include <functional>
+#include <future>
 #include <ostream>
 #include <memory>
+#include <optional>
 
 namespace eosio { namespace chain {
    /**
@@ -14,6 +18,17 @@ namespace eosio { namespace chain {
     */
    static const uint32_t current_snapshot_version = 1;
 
+   /// the layouts of a binary snapshot, with the same sections and rows
+   enum class snapshot_container {
+      binary,     ///< sections one after the other, found by scanning their headers
+      compressed  ///< zlib compressed chunks of the sections followed by a table of contents
+   };
+
+   /**
+    * Rewrites a binary snapshot, in either container, in to the given container without unpacking its rows
+    */
+   void convert_snapshot( std::istream& in, std::ostream& out, snapshot_container to );
+
    namespace detail {
       template<typename T>
       struct snapshot_section_traits {
@@ -72,6 +87,7 @@ namespace eosio { namespace chain {
       struct abstract_snapshot_row_writer {
          virtual void write(ostream_wrapper& out) const = 0;
          virtual void write(fc::sha256::encoder& out) const = 0;
+         virtual void write(fc::datastream<std::vector<char>>& out) const = 0;
          virtual fc::variant to_variant() const = 0;
          virtual std::string row_type_name() const = 0;
       };
@@ -94,6 +110,10 @@ namespace eosio { namespace chain {
             write_stream(out);
          }
 
+         void write(fc::datastream<std::vector<char>>& out) const override {
+            write_stream(out);
+         }
+
          fc::variant to_variant() const override {
             fc::variant var;
             fc::to_variant(data, var);
@@ -145,12 +165,74 @@ namespace eosio { namespace chain {
             write_section(detail::snapshot_section_traits<T>::section_name(), f);
          }
 
+         /**
+          * Writes a section whose rows are added by f(section, part_index) for each of num_parts parts, in order.
+          * When parallel section parts are enabled and this writer packs its rows, the parts are packed concurrently
+          * while the finished ones are appended in order, so f must only read shared state. Otherwise the parts are
+          * written one after the other on the calling thread.
+          */
+         template<typename F>
+         void write_section_parts(const std::string& section_name, size_t num_parts, F f) {
+            if (num_parts > 1 && parallel_section_parts()) {
+               write_packed_section_parts(section_name, num_parts, f);
+            } else {
+               write_section(section_name, [&]( auto& section ) {
+                  for (size_t part = 0; part < num_parts; ++part)
+                     f(section, part);
+               });
+            }
+         }
+
+         template<typename T, typename F>
+         void write_section_parts(size_t num_parts, F f) {
+            write_section_parts(detail::snapshot_section_traits<T>::section_name(), num_parts, f);
+         }
+
+         /// number of parts large sections should be split in to for write_section_parts()
+         size_t num_section_parts() const {
+            return parallel_section_parts() ? num_threads * section_parts_per_thread : 1;
+         }
+
+         using post_function = std::function<void(std::function<void()>)>;
+
+         /**
+          * Packs the parts of write_section_parts() on num_threads threads, post queues a task on one of them.
+          * An empty post disables it again.
+          */
+         void set_parallel_section_parts(post_function post, size_t num_threads) {
+            post_part = std::move(post);
+            this->num_threads = post_part ? num_threads : 0;
+         }
+
       virtual ~snapshot_writer(){};
 
       protected:
          virtual void write_start_section( const std::string& section_name ) = 0;
          virtual void write_row( const detail::abstract_snapshot_row_writer& row_writer ) = 0;
          virtual void write_end_section() = 0;
+
+         /// @return true if write_packed_rows() is implemented
+         virtual bool supports_packed_rows() const { return false; }
+
+         /// appends row_count rows, as packed by fc::raw::pack, to the current section
+         virtual void write_packed_rows( const std::vector<char>& rows, uint64_t row_count ) {
+            EOS_THROW(snapshot_exception, "Snapshot writer does not support packed rows");
+         }
+
+      private:
+         friend void convert_snapshot( std::istream& in, std::ostream& out, snapshot_container to );
+
+         bool parallel_section_parts() const { return num_threads > 0 && supports_packed_rows(); }
+
+         void write_packed_section_parts(const std::string& section_name, size_t num_parts,
+                                         const std::function<void(section_writer&, size_t)>& f);
+
+         // a large section is split in to many more parts than threads, so that the parts waiting to be written keep
+         // little of the snapshot in memory and a slow part does not leave the other threads idle
+         static constexpr size_t section_parts_per_thread = 64;
+
+         post_function post_part;
+         size_t        num_threads = 0;
    };
 
    using snapshot_writer_ptr = std::shared_ptr<snapshot_writer>;
@@ -331,6 +413,10 @@ namespace eosio { namespace chain {
 
          static const uint32_t magic_number = 0x30510550;
 
+      protected:
+         bool supports_packed_rows() const override { return true; }
+         void write_packed_rows( const std::vector<char>& rows, uint64_t row_count ) override;
+
       private:
          detail::ostream_wrapper snapshot;
          std::streampos          header_pos;
@@ -338,6 +424,62 @@ namespace eosio { namespace chain {
          uint64_t                row_count;
    };
 
+   namespace detail {
+      struct compressed_snapshot_chunk {
+         uint64_t offset          = 0; ///< from the start of the snapshot
+         uint32_t compressed_size = 0;
+         uint32_t size            = 0;
+      };
+
+      struct compressed_snapshot_section {
+         std::string                            name;
+         uint64_t                               row_count = 0;
+         std::vector<compressed_snapshot_chunk> chunks;
+      };
+
+      struct pending_snapshot_chunk {
+         size_t                         section = 0;
+         uint32_t                       size    = 0;
+         std::future<std::vector<char>> compressed;
+      };
+   }
+
+   /**
+    * Binary snapshot in the compressed container. The packed rows of each section are split in chunks of about
+    * chunk_size bytes, which are zlib compressed independently and concurrently. The chunks are followed by a table
+    * of contents of the sections and their chunks, and then by the offset of the table of contents:
+    *
+    *    magic_number, version, chunk..., table of contents, table of contents offset (uint64_t)
+    */
+   class ostream_compressed_snapshot_writer : public snapshot_writer {
+      public:
+         explicit ostream_compressed_snapshot_writer(std::ostream& snapshot, int compression_level = 6);
+
+         void write_start_section( const std::string& section_name ) override;
+         void write_row( const detail::abstract_snapshot_row_writer& row_writer ) override;
+         void write_end_section( ) override;
+         void finalize();
+
+         static const uint32_t magic_number = 0x30510551;
+         static constexpr size_t chunk_size = 16 * 1024 * 1024;
+
+      protected:
+         bool supports_packed_rows() const override { return true; }
+         void write_packed_rows( const std::vector<char>& rows, uint64_t row_count ) override;
+
+      private:
+         void flush_chunk(size_t size);
+         void write_chunk();
+
+         detail::ostream_wrapper                          snapshot;
+         std::streampos                                   header_pos;
+         int                                              compression_level;
+         fc::datastream<std::vector<char>>                chunk;
+         std::deque<detail::pending_snapshot_chunk>       pending_chunks; // being compressed, oldest first
+         std::vector<detail::compressed_snapshot_section> sections;
+         bool                                             in_section = false;
+   };
+
    class ostream_json_snapshot_writer : public snapshot_writer {
       public:
          explicit ostream_json_snapshot_writer(std::ostream& snapshot);
@@ -354,9 +496,15 @@ namespace eosio { namespace chain {
          uint64_t                row_count;
    };
 
+   /**
+    * Reads a binary snapshot in either container. The rows of a section are read ahead, and in the compressed container
+    * decompressed, on other threads while the caller unpacks them from memory, so that reading the snapshot overlaps
+    * with inserting its rows.
+    */
    class istream_snapshot_reader : public snapshot_reader {
       public:
          explicit istream_snapshot_reader(std::istream& snapshot);
+         ~istream_snapshot_reader();
 
          void validate() const override;
          void set_section( const string& section_name ) override;
@@ -366,12 +514,24 @@ namespace eosio { namespace chain {
          void return_to_header() override;
 
       private:
+         friend void convert_snapshot( std::istream& in, std::ostream& out, snapshot_container to );
+
          bool validate_section() const;
+         void validate_table_of_contents() const;
+
+         /// names and row counts of the sections, in the order they were written
+         std::vector<std::pair<std::string, uint64_t>> section_list();
 
          std::istream&  snapshot;
          std::streampos header_pos;
          uint64_t       num_rows;
          uint64_t       cur_row;
+
+         /// table of contents of the compressed container
+         std::optional<std::vector<detail::compressed_snapshot_section>> sections;
+
+         std::unique_ptr<std::streambuf> read_ahead;
+         std::unique_ptr<std::istream>   rows;
    };
 
    class istream_json_snapshot_reader : public snapshot_reader {
@@ -401,9 +561,16 @@ namespace eosio { namespace chain {
          void write_end_section( ) override;
          void finalize();
 
+      protected:
+         bool supports_packed_rows() const override { return true; }
+         void write_packed_rows( const std::vector<char>& rows, uint64_t row_count ) override;
+
       private:
          fc::sha256::encoder&  enc;
 
    };
 
 }}
+
+FC_REFLECT(eosio::chain::detail::compressed_snapshot_chunk, (offset)(compressed_size)(size))
+FC_REFLECT(eosio::chain::detail::compressed_snapshot_section, (name)(row_count)(chunks))
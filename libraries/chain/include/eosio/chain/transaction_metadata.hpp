@@ -13,6 +13,7 @@ namespace eosio { namespace chain {
 class transaction_metadata;
 using transaction_metadata_ptr = std::shared_ptr<transaction_metadata>;
 using recover_keys_future = std::future<transaction_metadata_ptr>;
+using recover_keys_shared_future = std::shared_future<transaction_metadata_ptr>;
 
 /**
  *  This data structure should store context-free cached data about a transaction such as
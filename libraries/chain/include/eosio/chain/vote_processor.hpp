@@ -16,6 +16,8 @@ namespace eosio::chain {
 
 /**
  * Process votes in a dedicated thread pool.
+ * Votes are queued and then drained one block at a time so that all votes for a block that have arrived
+ * are verified with a single batch signature check, see block_state::aggregate_votes.
  */
 class vote_processor_t {
    // Even 3000 vote structs are less than 1MB per connection.
@@ -25,6 +27,7 @@ class vote_processor_t {
    static constexpr fc::microseconds too_old = fc::seconds(5);
 
    struct by_block_num;
+   struct by_block_id;
    struct by_connection;
    struct by_last_received;
 
@@ -40,6 +43,7 @@ class vote_processor_t {
    using vote_index_type = boost::multi_index_container< vote,
       indexed_by<
          ordered_non_unique< tag<by_block_num>, const_mem_fun<vote, block_num_type, &vote::block_num>, std::greater<> >, // descending
+         ordered_non_unique< tag<by_block_id>, const_mem_fun<vote, const block_id_type&, &vote::id> >,
          ordered_non_unique< tag<by_connection>, member<vote, uint32_t, &vote::connection_id> >,
          ordered_non_unique< tag<by_last_received>, member<vote, fc::time_point, &vote::received> >
       >
@@ -102,32 +106,43 @@ private:
    }
 
    // called with locked mtx, returns with a locked mutex
+   // Drains queued votes one block at a time, all votes of a block are aggregated with one batch signature check.
+   // Other vote threads queue more votes while mtx is unlocked, so batches grow with the vote rate.
    void process_any_queued_for_later(std::unique_lock<std::mutex>& g) {
       if (index.empty())
          return;
       remove_too_old();
       remove_before_lib();
-      auto& idx = index.get<by_last_received>();
+      auto& idx = index.get<by_block_id>();
       std::vector<vote> unprocessed;
-      for (auto i = idx.begin(); i != idx.end();) {
+      std::vector<vote> batch;
+      std::vector<std::pair<uint32_t, const vote_message*>> batch_votes;
+      while (!idx.empty()) {
          if (stopped)
             return;
-         vote v = std::move(*i);
-         idx.erase(i);
-         auto bsp = get_block(v.msg->block_id, g);
+         const block_id_type id = idx.begin()->id();
+         auto [begin, end] = idx.equal_range(id);
+         batch.assign(begin, end);
+         idx.erase(begin, end);
+         auto bsp = get_block(id, g);
          // g is unlocked
          if (bsp) {
-            vote_status s = bsp->aggregate_vote(v.connection_id, *v.msg);
-            emit(v.connection_id, s, v.msg);
+            batch_votes.clear();
+            for (const auto& v : batch)
+               batch_votes.emplace_back(v.connection_id, v.msg.get());
+            std::vector<vote_status> status = bsp->aggregate_votes(batch_votes);
+            for (size_t i = 0; i < batch.size(); ++i)
+               emit(batch[i].connection_id, status[i], batch[i].msg);
 
             g.lock();
-            if (auto& num = num_messages[v.connection_id]; num != 0)
-               --num;
+            for (const auto& v : batch) {
+               if (auto& num = num_messages[v.connection_id]; num != 0)
+                  --num;
+            }
          } else {
-            unprocessed.push_back(std::move(v));
+            std::move(batch.begin(), batch.end(), std::back_inserter(unprocessed));
             g.lock();
          }
-         i = idx.begin(); // need to update since unlocked in loop
       }
       for (auto& v : unprocessed) {
          index.insert(std::move(v));
@@ -230,23 +245,9 @@ public:
                  ("n", num_msgs)("max", max_votes_per_connection)("c", connection_id));
             emit(connection_id, vote_status::max_exceeded, msg);
          } else {
-            block_state_ptr bsp = get_block(msg->block_id, g);
-            // g is unlocked
-
-            if (!bsp) {
-               // queue up for later processing
-               g.lock();
-               queue_for_later(connection_id, msg);
-            } else {
-               vote_status s = bsp->aggregate_vote(connection_id, *msg);
-               emit(connection_id, s, msg);
-
-               g.lock();
-               if (auto& num = num_messages[connection_id]; num != 0)
-                  --num;
-
-               process_any_queued_for_later(g);
-            }
+            // queue and drain, votes for the same block queued by other vote threads are verified as one batch
+            queue_for_later(connection_id, msg);
+            process_any_queued_for_later(g);
          }
 
       };
@@ -5,6 +5,10 @@
 #include <eosio/chain/exceptions.hpp>
 #include <functional>
 
+namespace boost { namespace asio {
+   class io_context;
+}}
+
 namespace eosio { namespace chain {
 
    class apply_context;
@@ -57,6 +61,36 @@ namespace eosio { namespace chain {
 
          // returns true if EOS VM OC is enabled
          bool is_eos_vm_oc_enabled() const;
+
+         struct eosvmoc_code_stats {
+            digest_type code_hash;
+            uint8_t     vm_version = 0;
+            uint64_t    executions = 0;
+            uint64_t    cpu_us     = 0;
+            bool        cached     = false;
+         };
+
+         // usage driven EOS VM OC tier-up; all 0 when EOS VM OC tier-up is not enabled
+         struct eosvmoc_stats {
+            uint32_t compile_threshold    = 0;
+            uint64_t compile_threads      = 0; // current limit on concurrent compiles
+            uint64_t tracked_codes        = 0; // codes with usage statistics
+            uint64_t hot_codes            = 0; // tracked codes past compile_threshold
+            uint64_t cached_codes         = 0;
+            uint64_t queued_compiles      = 0;
+            uint64_t outstanding_compiles = 0;
+            uint64_t evictions            = 0;
+            std::vector<eosvmoc_code_stats> codes; // most cpu first
+         };
+
+         // thread safe, as of the last call to current_lib, without codes
+         eosvmoc_stats get_eosvmoc_metrics() const;
+
+         // with up to limit codes; main thread, write window only
+         eosvmoc_stats get_eosvmoc_stats(uint32_t limit) const;
+
+         // limit EOS VM OC tier-up to its configured compile threads instead of its burst threads; main thread only
+         void limit_eosvmoc_compile_threads(bool limit);
 #endif
 
          //call before dtor to skip what can be minutes of dtor overhead with some runtimes; can cause leaks
@@ -74,9 +108,17 @@ namespace eosio { namespace chain {
          //Calls apply or error on a given code
          void apply(const digest_type& code_hash, const uint8_t& vm_type, const uint8_t& vm_version, apply_context& context);
 
+         //start preparing code expected to be applied in block_num while the current block executes. Queues EOS VM OC
+         //compilation if OC would be used for it, otherwise instantiates the module on thread_pool. Main thread, write window only.
+         void prefetch(const digest_type& code_hash, const uint8_t& vm_type, const uint8_t& vm_version, bool use_eos_vm_oc,
+                       uint32_t block_num, boost::asio::io_context& thread_pool);
+
          //Returns true if the code is cached
          bool is_code_cached(const digest_type& code_hash, const uint8_t& vm_type, const uint8_t& vm_version) const;
 
+         //Returns true if the code is cached and was instantiated by prefetch, for testing
+         bool is_code_prefetched(const digest_type& code_hash, const uint8_t& vm_type, const uint8_t& vm_version) const;
+
          // If substitute_apply is set, then apply calls it before doing anything else. If substitute_apply returns true,
          // then apply returns immediately. Provided function must be multi-thread safe.
          std::function<bool(const digest_type& code_hash, uint8_t vm_type, uint8_t vm_version, apply_context& context)> substitute_apply;
@@ -103,3 +145,8 @@ namespace eosio{ namespace chain {
 }}
 
 FC_REFLECT_ENUM( eosio::chain::wasm_interface::vm_type, (eos_vm)(eos_vm_jit)(eos_vm_oc) )
+#ifdef EOSIO_EOS_VM_OC_RUNTIME_ENABLED
+FC_REFLECT( eosio::chain::wasm_interface::eosvmoc_code_stats, (code_hash)(vm_version)(executions)(cpu_us)(cached) )
+FC_REFLECT( eosio::chain::wasm_interface::eosvmoc_stats, (compile_threshold)(compile_threads)(tracked_codes)(hot_codes)(cached_codes)(queued_compiles)
+                                                         (outstanding_compiles)(evictions)(codes) )
+#endif
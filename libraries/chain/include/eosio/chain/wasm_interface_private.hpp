@@ -12,6 +12,7 @@
 #include <eosio/chain/code_object.hpp>
 #include <eosio/chain/global_property_object.hpp>
 #include <eosio/chain/exceptions.hpp>
+#include <eosio/chain/thread_utils.hpp>
 #include <fc/scoped_exit.hpp>
 
 #include "IR/Module.h"
@@ -22,6 +23,9 @@
 #include <eosio/chain/webassembly/eos-vm.hpp>
 #include <eosio/vm/allocator.hpp>
 
+#include <atomic>
+#include <future>
+#include <map>
 #include <mutex>
 
 using namespace fc;
@@ -38,6 +42,7 @@ namespace eosio { namespace chain {
       struct wasm_cache_entry {
          digest_type                                          code_hash;
          uint32_t                                             last_block_num_used;
+         std::shared_ptr<const std::vector<char>>             code; // code of a prefetched module, outlives module
          std::unique_ptr<wasm_instantiated_module_interface>  module;
          uint8_t                                              vm_type = 0;
          uint8_t                                              vm_version = 0;
@@ -47,9 +52,12 @@ namespace eosio { namespace chain {
 
 #ifdef EOSIO_EOS_VM_OC_RUNTIME_ENABLED
 struct eosvmoc_tier {
+   // usage is halved this often, so that code no longer used gives way to code in use
+   static constexpr uint32_t usage_decay_interval_blocks = 2*60*60; // one hour
+
    // Called from main thread
    eosvmoc_tier(const std::filesystem::path& d, const eosvmoc::config& c, const chainbase::database& db)
-      : cc(d, c, db) {
+      : compile_threshold(c.compile_threshold), cc(d, c, db, &usage) {
       // Construct exec and mem for the main thread
       exec = std::make_unique<eosvmoc::executor>(cc);
       mem  = std::make_unique<eosvmoc::memory>(wasm_constraints::maximum_linear_memory/wasm_constraints::wasm_page_size);
@@ -61,6 +69,87 @@ struct eosvmoc_tier {
       mem  = std::make_unique<eosvmoc::memory>(eosvmoc::memory::sliced_pages_for_ro_thread);
    }
 
+   // Called from any thread; read-only threads only run outside of the write window.
+   // Returns true if the code has been executed often enough to be compiled.
+   bool count_execution(const eosvmoc::code_tuple& code, bool is_write_window) {
+      auto count = [&]() { return ++usage[code].executions >= compile_threshold; };
+      if (is_write_window)
+         return count();
+      std::lock_guard g(usage_mutex);
+      return count();
+   }
+
+   void add_cpu(const eosvmoc::code_tuple& code, fc::microseconds cpu, bool is_write_window) {
+      if (is_write_window) {
+         usage[code].cpu_us += cpu.count();
+      } else {
+         std::lock_guard g(usage_mutex);
+         usage[code].cpu_us += cpu.count();
+      }
+   }
+
+   // Called from main thread in write window
+   bool is_hot(const eosvmoc::code_tuple& code) const {
+      auto it = usage.find(code);
+      return it != usage.end() && it->second.executions >= compile_threshold;
+   }
+
+   // Called from main thread in write window
+   void current_lib(uint32_t lib) {
+      if (lib >= next_usage_decay_block) {
+         next_usage_decay_block = lib + usage_decay_interval_blocks;
+         std::erase_if(usage, [](auto& e) {
+            e.second.executions /= 2;
+            e.second.cpu_us /= 2;
+            return e.second.executions == 0;
+         });
+      }
+
+      wasm_interface::eosvmoc_stats m = stats(0);
+      std::lock_guard g(metrics_mutex);
+      metrics = m;
+   }
+
+   // Called from main thread in write window
+   wasm_interface::eosvmoc_stats stats(uint32_t limit) const {
+      wasm_interface::eosvmoc_stats result{
+         .compile_threshold    = compile_threshold,
+         .compile_threads      = cc.compile_threads(),
+         .tracked_codes        = usage.size(),
+         .cached_codes         = cc.cached_codes(),
+         .queued_compiles      = cc.queued_compiles(),
+         .outstanding_compiles = cc.outstanding_compiles(),
+         .evictions            = cc.evictions()
+      };
+      for (const auto& [code, u] : usage) {
+         if (u.executions >= compile_threshold)
+            ++result.hot_codes;
+         if (limit) {
+            result.codes.push_back({ .code_hash = code.code_id, .vm_version = code.vm_version, .executions = u.executions,
+                                     .cpu_us = u.cpu_us, .cached = cc.is_cached(code.code_id, code.vm_version) });
+         }
+      }
+      auto most_cpu = [](const auto& a, const auto& b) { return a.cpu_us > b.cpu_us; };
+      const size_t count = std::min<size_t>(limit, result.codes.size());
+      std::partial_sort(result.codes.begin(), result.codes.begin() + count, result.codes.end(), most_cpu);
+      result.codes.resize(count);
+      return result;
+   }
+
+   wasm_interface::eosvmoc_stats get_metrics() const {
+      std::lock_guard g(metrics_mutex);
+      return metrics;
+   }
+
+   const uint32_t compile_threshold;
+   // protected by usage_mutex outside of the write window
+   eosvmoc::code_usage_map usage;
+   std::mutex usage_mutex;
+   uint32_t next_usage_decay_block = 0;
+
+   mutable std::mutex metrics_mutex;
+   wasm_interface::eosvmoc_stats metrics;
+
    eosvmoc::code_cache_async cc;
 
    // Each thread requires its own exec and mem. Defined in wasm_interface.cpp
@@ -101,7 +190,13 @@ struct eosvmoc_tier {
 #endif
       }
 
-      ~wasm_interface_impl() = default;
+      ~wasm_interface_impl() {
+         // keeps the queued prefetches from starting and waits for the ones instantiating, they use runtime_interface
+         for (auto& [key, prefetch] : prefetched_modules) {
+            if (prefetch.claimed->exchange(true))
+               prefetch.module.wait();
+         }
+      }
 
       bool is_code_cached(const digest_type& code_hash, const uint8_t& vm_type, const uint8_t& vm_version) const {
          // This method is only called from tests; performance is not critical.
@@ -111,6 +206,13 @@ struct eosvmoc_tier {
          return it != wasm_instantiation_cache.end();
       }
 
+      bool is_code_prefetched(const digest_type& code_hash, const uint8_t& vm_type, const uint8_t& vm_version) const {
+         // Only called from tests, the code of a cached module is only kept when it was instantiated by a prefetch.
+         std::lock_guard g(instantiation_cache_mutex);
+         wasm_cache_index::iterator it = wasm_instantiation_cache.find( boost::make_tuple(code_hash, vm_type, vm_version) );
+         return it != wasm_instantiation_cache.end() && it->code;
+      }
+
       void code_block_num_last_used(const digest_type& code_hash, const uint8_t& vm_type, const uint8_t& vm_version, const uint32_t& block_num) {
          // The caller of this method apply_eosio_setcode has asserted that
          // the transaction is not read-only, implying we are
@@ -132,10 +234,17 @@ struct eosvmoc_tier {
          const auto first_it = wasm_instantiation_cache.get<by_last_block_num>().begin();
          const auto last_it  = wasm_instantiation_cache.get<by_last_block_num>().upper_bound(lib);
 #ifdef EOSIO_EOS_VM_OC_RUNTIME_ENABLED
-         if(eosvmoc) for(auto it = first_it; it != last_it; it++)
-            eosvmoc->cc.free_code(it->code_hash, it->vm_version);
+         if(eosvmoc) {
+            for(auto it = first_it; it != last_it; it++)
+               eosvmoc->cc.free_code(it->code_hash, it->vm_version);
+            eosvmoc->current_lib(lib);
+         }
 #endif
          wasm_instantiation_cache.get<by_last_block_num>().erase(first_it, last_it);
+         // drop finished prefetches for blocks now irreversible, the block that would have used them was forked out
+         std::erase_if(prefetched_modules, [lib](const auto& e) {
+            return e.second.block_num <= lib && e.second.module.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+         });
       }
 
 #ifdef EOSIO_EOS_VM_OC_RUNTIME_ENABLED
@@ -187,12 +296,69 @@ struct eosvmoc_tier {
             trx_context.resume_billing_timer();
          });
          trx_context.pause_billing_timer();
+         std::shared_ptr<const std::vector<char>> code;
+         std::unique_ptr<wasm_instantiated_module_interface> module = take_prefetched_module(code_hash, vm_type, vm_version, code);
+         if (!module)
+            module = runtime_interface->instantiate_module(codeobject->code.data(), codeobject->code.size(), code_hash, vm_type, vm_version);
          wasm_instantiation_cache.modify(it, [&](auto& c) {
-            c.module = runtime_interface->instantiate_module(codeobject->code.data(), codeobject->code.size(), code_hash, vm_type, vm_version);
+            c.code = std::move(code);
+            c.module = std::move(module);
          });
          return it->module;
       }
 
+      // Called from the main thread in write window. Starts instantiating code on thread_pool so that
+      // the first get_instantiated_module for it only has to wait for the remainder of the instantiation.
+      void prefetch_instantiated_module(const digest_type& code_hash, const uint8_t& vm_type, const uint8_t& vm_version,
+                                        uint32_t block_num, boost::asio::io_context& thread_pool) {
+         auto key = std::make_tuple(code_hash, vm_type, vm_version);
+         if (wasm_instantiation_cache.find(boost::make_tuple(code_hash, vm_type, vm_version)) != wasm_instantiation_cache.end() ||
+             prefetched_modules.contains(key))
+            return;
+         const code_object* codeobject = db.find<code_object,by_code_hash>(boost::make_tuple(code_hash, vm_type, vm_version));
+         if (!codeobject)
+            return;
+         // copy, the code_object may be modified by the block being applied while instantiating
+         // and kept for the lifetime of the module, runtimes may reference it
+         auto code = std::make_shared<const std::vector<char>>(codeobject->code.data(), codeobject->code.data() + codeobject->code.size());
+         auto claimed = std::make_shared<std::atomic<bool>>(false);
+         prefetched_modules.emplace(key, prefetched_module{
+            .block_num = block_num,
+            .code = code,
+            .claimed = claimed,
+            .module = post_async_task(thread_pool, [claimed, runtime=runtime_interface.get(), code, code_hash, vm_type, vm_version]() {
+               if (claimed->exchange(true))
+                  return std::unique_ptr<wasm_instantiated_module_interface>{}; // instantiated by its user meanwhile, or cancelled
+               return runtime->instantiate_module(code->data(), code->size(), code_hash, vm_type, vm_version);
+            })
+         });
+      }
+
+      // Locked by the caller if required. Returns nullptr if not prefetched, if the prefetch has not started yet or if it
+      // failed, otherwise sets code to the code the module was instantiated from. Only waits for a prefetch instantiating,
+      // one still queued on the thread pool is claimed so that the caller instantiates the module itself.
+      std::unique_ptr<wasm_instantiated_module_interface> take_prefetched_module(const digest_type& code_hash, const uint8_t& vm_type,
+                                                                                 const uint8_t& vm_version,
+                                                                                 std::shared_ptr<const std::vector<char>>& code) {
+         if (prefetched_modules.empty())
+            return {};
+         auto pit = prefetched_modules.find(std::make_tuple(code_hash, vm_type, vm_version));
+         if (pit == prefetched_modules.end())
+            return {};
+         auto prefetch = std::move(pit->second);
+         prefetched_modules.erase(pit);
+         if (!prefetch.claimed->exchange(true))
+            return {};
+         try {
+            auto module = prefetch.module.get();
+            if (module)
+               code = std::move(prefetch.code);
+            return module;
+         } catch (...) {
+            return {}; // instantiate on this thread and report any error from there
+         }
+      }
+
       std::unique_ptr<wasm_runtime_interface> runtime_interface;
 
       typedef boost::multi_index_container<
@@ -211,6 +377,17 @@ struct eosvmoc_tier {
       mutable std::mutex instantiation_cache_mutex;
       wasm_cache_index wasm_instantiation_cache;
 
+      // instantiations started by prefetch_instantiated_module, moved into wasm_instantiation_cache on first use.
+      // Protected the same way as wasm_instantiation_cache.
+      struct prefetched_module {
+         uint32_t                                                         block_num; // block expected to use the module
+         std::shared_ptr<const std::vector<char>>                         code;
+         std::shared_ptr<std::atomic<bool>>                               claimed; // by the task when it starts, by its user or destructor before
+         std::future<std::unique_ptr<wasm_instantiated_module_interface>> module;
+      };
+      using prefetch_key_t = std::tuple<digest_type, uint8_t, uint8_t>;
+      std::map<prefetch_key_t, prefetched_module> prefetched_modules;
+
       const chainbase::database& db;
       const wasm_interface::vm_type wasm_runtime_time;
 
@@ -6,6 +6,7 @@
 #include <eosio/chain/webassembly/eos-vm-oc/ipc_helpers.hpp>
 #include <boost/multi_index_container.hpp>
 #include <boost/multi_index/hashed_index.hpp>
+#include <boost/multi_index/ordered_index.hpp>
 #include <boost/multi_index/sequenced_index.hpp>
 #include <boost/multi_index/composite_key.hpp>
 #include <boost/multi_index/key_extractors.hpp>
@@ -35,16 +36,72 @@ using allocator_t = bip::rbtree_best_fit<bip::null_mutex_family, bip::offset_ptr
 
 struct config;
 
+/**
+ * Entry of a code cache export: the compiled code of a contract and its code_descriptor, less the locations in the
+ * code cache the code is loaded at. The code is position independent, so it can be loaded in to any code cache of a
+ * node with the same current_codegen_version.
+ */
+struct exported_code {
+   digest_type                         code_hash;
+   uint8_t                             vm_version = 0;
+   eosvmoc_optional_offset_or_import_t start;
+   unsigned                            apply_offset = 0;
+   int                                 starting_memory_pages = 0;
+   unsigned                            initdata_prologue_size = 0;
+   std::vector<char>                   code;
+   std::vector<char>                   initdata;
+};
+
+/**
+ * A code cache export is a code_cache_export_header followed by num_entries of a packed exported_code, each as a
+ * std::vector<char> followed by its sha256, ordered most recently used first.
+ */
+struct code_cache_export_header {
+   static constexpr uint64_t id_value        = 0x58434f4d56534f45ULL; //"EOSVMOCX" little endian
+   static constexpr uint32_t current_version = 1;
+
+   uint64_t id              = id_value;
+   uint32_t version         = current_version;
+   uint8_t  codegen_version = current_codegen_version;
+   uint32_t num_entries     = 0;
+};
+
+// how much code has been used, for choosing the code worth compiling and keeping in the code cache
+struct code_usage {
+   uint64_t executions = 0;
+   uint64_t cpu_us     = 0; // cumulative time of the executions
+};
+using code_usage_map = std::unordered_map<code_tuple, code_usage>;
+
+/**
+ * Exports the code cache of state_dir, which must not be in use, for eosvmoc::config::import_file of other nodes.
+ * @return number of entries exported
+ */
+size_t export_code_cache(const std::filesystem::path& state_dir, const std::filesystem::path& export_file);
 
 class code_cache_base {
    public:
-      code_cache_base(const std::filesystem::path& data_dir, const eosvmoc::config& eosvmoc_config, const chainbase::database& db);
+      // compiles are prioritized, and evicted, by usage if not null; otherwise first come first served and least recently used
+      // usage is only read in the write window
+      code_cache_base(const std::filesystem::path& data_dir, const eosvmoc::config& eosvmoc_config, const chainbase::database& db,
+                      const code_usage_map* usage = nullptr);
       ~code_cache_base();
 
       const int& fd() const { return _cache_fd; }
 
       void free_code(const digest_type& code_id, const uint8_t& vm_version);
 
+      // write window only
+      size_t   cached_codes() const         { return _cache_index.size(); }
+      size_t   queued_compiles() const      { return _queued_compiles.size(); }
+      size_t   outstanding_compiles() const { return _outstanding_compiles_and_poison.size(); }
+      uint64_t evictions() const            { return _evictions; }
+
+      // also from read-only threads, the cache only changes in the write window
+      bool     is_cached(const digest_type& code_id, const uint8_t& vm_version) const {
+         return _cache_index.get<by_hash>().count(boost::make_tuple(code_id, vm_version));
+      }
+
       // get_descriptor_for_code failure reasons
       enum class get_cd_failure {
          temporary, // oc compile not done yet, users like read-only trxs can retry
@@ -53,6 +110,7 @@ class code_cache_base {
 
    protected:
       struct by_hash;
+      struct by_priority;
 
       typedef boost::multi_index_container<
          code_descriptor,
@@ -79,48 +137,65 @@ class code_cache_base {
       local::datagram_protocol::socket _compile_monitor_read_socket{_ctx};
 
       //these are really only useful to the async code cache, but keep them here so free_code can be shared
+      struct queued_compile {
+         code_tuple code;
+         uint64_t   priority = 0; // expected benefit of compiling the code; the highest is compiled first
+      };
       using queued_compilies_t = boost::multi_index_container<
-         code_tuple,
+         queued_compile,
          indexed_by<
-            sequenced<>,
-            hashed_unique<tag<by_hash>,
-               composite_key< code_tuple,
-                  member<code_tuple, digest_type, &code_tuple::code_id>,
-                  member<code_tuple, uint8_t,     &code_tuple::vm_version>
-               >
-            >
+            ordered_non_unique<tag<by_priority>, member<queued_compile, uint64_t, &queued_compile::priority>, std::greater<uint64_t>>,
+            hashed_unique<tag<by_hash>, member<queued_compile, code_tuple, &queued_compile::code>, std::hash<code_tuple>>
          >
       >;
       queued_compilies_t _queued_compiles;
       std::unordered_map<code_tuple, bool> _outstanding_compiles_and_poison;
 
+      const code_usage_map* _usage;
+      uint64_t              _evictions = 0;
+      uint64_t compile_priority(const code_tuple& code, bool high_priority) const;
+
       size_t _free_bytes_eviction_threshold;
       void check_eviction_threshold(size_t free_bytes);
       void run_eviction_round();
 
       void set_on_disk_region_dirty(bool);
 
+      // loads the entries of a code cache export not already cached, most recently used first, until the code cache
+      // reaches its eviction threshold
+      void import_code_cache(char* code_mapping, const std::filesystem::path& import_file);
+
       template <typename T>
       void serialize_cache_index(fc::datastream<T>& ds);
 };
 
 class code_cache_async : public code_cache_base {
    public:
-      code_cache_async(const std::filesystem::path& data_dir, const eosvmoc::config& eosvmoc_config, const chainbase::database& db);
+      code_cache_async(const std::filesystem::path& data_dir, const eosvmoc::config& eosvmoc_config, const chainbase::database& db,
+                       const code_usage_map* usage = nullptr);
       ~code_cache_async();
 
       //If code is in cache: returns pointer & bumps to front of MRU list
-      //If code is not in cache, and not blacklisted, and not currently compiling: return nullptr and kick off compile
+      //If code is not in cache, and not blacklisted, and not currently compiling: return nullptr and kick off compile,
+      // queued by its usage (high_priority first) when all compile threads are busy
       //otherwise: return nullptr
       const code_descriptor* const get_descriptor_for_code(bool high_priority, const digest_type& code_id, const uint8_t& vm_version, bool is_write_window, get_cd_failure& failure);
 
+      //While limited, no more than eosvmoc::config::threads compiles are started, to keep cores free for block production;
+      // otherwise up to the burst threads. Compiles already running are not interrupted. Main thread only.
+      void   limit_compile_threads(bool limit) { _limit_threads = limit; }
+      size_t compile_threads() const { return _limit_threads ? _threads : std::max(_threads, _burst_threads); }
+
    private:
       std::thread _monitor_reply_thread;
       boost::lockfree::spsc_queue<wasm_compilation_result_message> _result_queue;
       void wait_on_compile_monitor_message();
       std::tuple<size_t, size_t> consume_compile_thread_queue();
+      void start_queued_compiles();
       std::unordered_set<code_tuple> _blacklist;
       size_t _threads;
+      size_t _burst_threads;
+      bool   _limit_threads = false;
 };
 
 class code_cache_sync : public code_cache_base {
@@ -133,3 +208,6 @@ class code_cache_sync : public code_cache_base {
 };
 
 }}}
+
+FC_REFLECT(eosio::chain::eosvmoc::exported_code, (code_hash)(vm_version)(start)(apply_offset)(starting_memory_pages)(initdata_prologue_size)(code)(initdata));
+FC_REFLECT(eosio::chain::eosvmoc::code_cache_export_header, (id)(version)(codegen_version)(num_entries));
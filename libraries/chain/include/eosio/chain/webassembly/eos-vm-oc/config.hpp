@@ -1,5 +1,6 @@
 #pragma once
 
+#include <filesystem>
 #include <istream>
 #include <ostream>
 #include <vector>
@@ -31,6 +32,15 @@ struct config {
 #endif
    std::optional<uint64_t> stack_size_limit {16u*1024u};
    std::optional<size_t>   generated_code_size_limit {16u*1024u*1024u};
+
+   // Only used by nodeos itself, so not passed to the compile monitor:
+   // export of a code cache (see export_code_cache()) loaded in to the code cache at startup; empty for none.
+   std::filesystem::path   import_file;
+   // number of executions of code before it is compiled; code of eosio.* accounts is compiled on first use
+   uint32_t                compile_threshold = 1u;
+   // number of concurrent compiles while not producing blocks, e.g. at startup and while syncing, when more than threads;
+   // 0 disables the burst
+   uint64_t                burst_threads = 0u;
 };
 
 //work around unexpected std::optional behavior
@@ -7,6 +7,8 @@
 #include <boost/tuple/tuple_io.hpp>
 #include <eosio/chain/database_utils.hpp>
 #include <algorithm>
+#include <map>
+#include <optional>
 
 namespace eosio { namespace chain { namespace resource_limits {
 
@@ -48,6 +50,39 @@ void resource_limits_state_object::update_virtual_net_limit( const resource_limi
    virtual_net_limit = update_elastic_limit(virtual_net_limit, average_block_net_usage.average(), cfg.net_limit_parameters);
 }
 
+/**
+ * The cpu and net usage of the accounts billed in the pending block, not yet written to their resource_usage_object
+ */
+struct resource_limits_manager::pending_usage {
+   struct account_usage {
+      usage_accumulator net_usage;
+      usage_accumulator cpu_usage;
+   };
+
+   std::map<account_name, account_usage> accounts;
+   // usage pending for the accounts updated by the transaction in progress before its first update of them
+   flat_map<account_name, std::optional<account_usage>> transaction_undo;
+
+   account_usage get( const resource_usage_object& row ) const {
+      auto itr = accounts.find( row.owner );
+      return itr != accounts.end() ? itr->second : account_usage{ row.net_usage, row.cpu_usage };
+   }
+
+   void set( const resource_usage_object& row, const account_usage& usage ) {
+      auto [itr, inserted] = accounts.try_emplace( row.owner, usage );
+      if( !transaction_undo.count( row.owner ) )
+         transaction_undo.emplace( row.owner, inserted ? std::optional<account_usage>{} : std::optional<account_usage>{itr->second} );
+      itr->second = usage;
+   }
+};
+
+resource_limits_manager::resource_limits_manager(chainbase::database& db, std::function<deep_mind_handler*(bool is_trx_transient)> get_deep_mind_logger)
+:_db(db),_get_deep_mind_logger(get_deep_mind_logger),_pending_usage(std::make_unique<pending_usage>())
+{
+}
+
+resource_limits_manager::~resource_limits_manager() = default;
+
 void resource_limits_manager::add_indices() {
    resource_index_set::add_indices(_db);
 }
@@ -73,8 +108,9 @@ void resource_limits_manager::initialize_database() {
 
 void resource_limits_manager::add_to_snapshot( const snapshot_writer_ptr& snapshot ) const {
    resource_index_set::walk_indices([this, &snapshot]( auto utils ){
-      snapshot->write_section<typename decltype(utils)::index_t::value_type>([this]( auto& section ){
-         decltype(utils)::walk(_db, [this, &section]( const auto &row ) {
+      const size_t num_parts = snapshot->num_section_parts();
+      snapshot->write_section_parts<typename decltype(utils)::index_t::value_type>(num_parts, [this, num_parts]( auto& section, size_t part ){
+         decltype(utils)::walk_part(_db, part, num_parts, [this, &section]( const auto &row ) {
             section.add_row(row, _db);
          });
       });
@@ -128,11 +164,15 @@ void resource_limits_manager::set_block_parameters(const elastic_limit_parameter
 void resource_limits_manager::update_account_usage(const flat_set<account_name>& accounts, uint32_t time_slot ) {
    const auto& config = _db.get<resource_limits_config_object>();
    for( const auto& a : accounts ) {
-      const auto& usage = _db.get<resource_usage_object,by_owner>( a );
-      _db.modify( usage, [&]( auto& bu ){
-          bu.net_usage.add( 0, time_slot, config.account_net_usage_average_window );
-          bu.cpu_usage.add( 0, time_slot, config.account_cpu_usage_average_window );
-      });
+      const auto& row = _db.get<resource_usage_object,by_owner>( a );
+      auto usage = _pending_usage->get( row );
+      // adding no usage in the slot the averages were last updated in changes nothing; this is the case for every
+      // transaction of an account after its first one of the block
+      if( usage.net_usage.last_ordinal == time_slot && usage.cpu_usage.last_ordinal == time_slot )
+         continue;
+      usage.net_usage.add( 0, time_slot, config.account_net_usage_average_window );
+      usage.cpu_usage.add( 0, time_slot, config.account_cpu_usage_average_window );
+      _pending_usage->set( row, usage );
    }
 }
 
@@ -142,20 +182,23 @@ void resource_limits_manager::add_transaction_usage(const flat_set<account_name>
 
    for( const auto& a : accounts ) {
 
-      const auto& usage = _db.get<resource_usage_object,by_owner>( a );
+      const auto& row = _db.get<resource_usage_object,by_owner>( a );
       int64_t unused;
       int64_t net_weight;
       int64_t cpu_weight;
       get_account_limits( a, unused, net_weight, cpu_weight );
 
-      _db.modify( usage, [&]( auto& bu ){
-          bu.net_usage.add( net_usage, time_slot, config.account_net_usage_average_window );
-          bu.cpu_usage.add( cpu_usage, time_slot, config.account_cpu_usage_average_window );
+      auto usage = _pending_usage->get( row );
+      usage.net_usage.add( net_usage, time_slot, config.account_net_usage_average_window );
+      usage.cpu_usage.add( cpu_usage, time_slot, config.account_cpu_usage_average_window );
+      _pending_usage->set( row, usage );
 
-         if (auto dm_logger = _get_deep_mind_logger(is_trx_transient)) {
-            dm_logger->on_update_account_usage(bu);
-         }
-      });
+      if (auto dm_logger = _get_deep_mind_logger(is_trx_transient)) {
+         resource_usage_object bu = row;
+         bu.net_usage = usage.net_usage;
+         bu.cpu_usage = usage.cpu_usage;
+         dm_logger->on_update_account_usage(bu);
+      }
 
       if( cpu_weight >= 0 && state.total_cpu_weight > 0 ) {
          uint128_t window_size = config.account_cpu_usage_average_window;
@@ -208,6 +251,25 @@ void resource_limits_manager::add_transaction_usage(const flat_set<account_name>
    EOS_ASSERT( state.pending_net_usage <= config.net_limit_parameters.max, block_resource_exhausted, "Block has insufficient net resources" );
 }
 
+void resource_limits_manager::squash_transaction_usage() {
+   _pending_usage->transaction_undo.clear();
+}
+
+void resource_limits_manager::undo_transaction_usage() {
+   for( const auto& [owner, usage] : _pending_usage->transaction_undo ) {
+      if( usage )
+         _pending_usage->accounts.insert_or_assign( owner, *usage );
+      else
+         _pending_usage->accounts.erase( owner );
+   }
+   _pending_usage->transaction_undo.clear();
+}
+
+void resource_limits_manager::undo_block_usage() {
+   _pending_usage->accounts.clear();
+   _pending_usage->transaction_undo.clear();
+}
+
 void resource_limits_manager::add_pending_ram_usage( const account_name account, int64_t ram_delta, bool is_trx_transient ) {
    if (ram_delta == 0) {
       return;
@@ -368,6 +430,15 @@ void resource_limits_manager::process_account_limit_updates() {
 }
 
 void resource_limits_manager::process_block_usage(uint32_t block_num) {
+   // write the usage accumulated in the block, once per account
+   for( const auto& [owner, usage] : _pending_usage->accounts ) {
+      _db.modify( _db.get<resource_usage_object,by_owner>( owner ), [&]( auto& bu ){
+         bu.net_usage = usage.net_usage;
+         bu.cpu_usage = usage.cpu_usage;
+      });
+   }
+   undo_block_usage();
+
    const auto& s = _db.get<resource_limits_state_object>();
    const auto& config = _db.get<resource_limits_config_object>();
    _db.modify(s, [&](resource_limits_state_object& state){
@@ -431,7 +502,7 @@ std::pair<account_resource_limit, bool>
 resource_limits_manager::get_account_cpu_limit_ex( const account_name& name, uint32_t greylist_limit, const std::optional<block_timestamp_type>& current_time) const {
 
    const auto& state = _db.get<resource_limits_state_object>();
-   const auto& usage = _db.get<resource_usage_object, by_owner>(name);
+   const auto usage = _pending_usage->get(_db.get<resource_usage_object, by_owner>(name));
    const auto& config = _db.get<resource_limits_config_object>();
 
    int64_t cpu_weight, x, y;
@@ -493,7 +564,7 @@ std::pair<account_resource_limit, bool>
 resource_limits_manager::get_account_net_limit_ex( const account_name& name, uint32_t greylist_limit, const std::optional<block_timestamp_type>& current_time) const {
    const auto& config = _db.get<resource_limits_config_object>();
    const auto& state  = _db.get<resource_limits_state_object>();
-   const auto& usage  = _db.get<resource_usage_object, by_owner>(name);
+   const auto  usage  = _pending_usage->get(_db.get<resource_usage_object, by_owner>(name));
 
    int64_t net_weight, x, y;
    get_account_limits( name, x, net_weight, y );
@@ -4,16 +4,86 @@
 #include <eosio/chain/exceptions.hpp>
 #include <fc/scoped_exit.hpp>
 #include <fc/io/json.hpp>
+#include <fc/compress/zlib.hpp>
 
 #include <rapidjson/document.h>
 #include <rapidjson/filereadstream.h>
 #include <rapidjson/stringbuffer.h>
 #include <rapidjson/writer.h>
 
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <thread>
+
 using namespace eosio_rapidjson;
 
 namespace eosio { namespace chain {
 
+namespace {
+
+   // packs the rows of one part of a section passed to snapshot_writer::write_section_parts()
+   class packed_rows_writer : public snapshot_writer {
+      public:
+         fc::datastream<std::vector<char>> rows;
+         uint64_t                          row_count = 0;
+
+      protected:
+         void write_start_section( const std::string& ) override {}
+
+         void write_row( const detail::abstract_snapshot_row_writer& row_writer ) override {
+            row_writer.write(rows);
+            ++row_count;
+         }
+
+         void write_end_section( ) override {}
+   };
+
+   struct packed_part {
+      std::vector<char> rows;
+      uint64_t          row_count = 0;
+   };
+
+}
+
+void snapshot_writer::write_packed_section_parts(const std::string& section_name, size_t num_parts,
+                                                 const std::function<void(section_writer&, size_t)>& f) {
+   const size_t max_pending_parts = 2 * num_threads;
+   std::deque<std::future<packed_part>> pending_parts;
+   size_t next_part = 0;
+
+   auto post_next_part = [&]() {
+      auto task = std::make_shared<std::packaged_task<packed_part()>>([&f, part = next_part++]() {
+         packed_rows_writer writer;
+         section_writer section(writer);
+         f(section, part);
+         return packed_part{std::move(writer.rows.storage()), writer.row_count};
+      });
+      pending_parts.push_back(task->get_future());
+      post_part([task]() { (*task)(); });
+   };
+
+   // the posted parts reference f and the state it reads, so wait for them even when a part failed
+   auto wait_for_pending = fc::make_scoped_exit([&]() {
+      for (auto& p : pending_parts) {
+         if (p.valid())
+            p.wait();
+      }
+   });
+
+   write_start_section(section_name);
+   while (next_part < num_parts && pending_parts.size() < max_pending_parts)
+      post_next_part();
+   while (!pending_parts.empty()) {
+      packed_part part = pending_parts.front().get();
+      pending_parts.pop_front();
+      if (next_part < num_parts)
+         post_next_part();
+      write_packed_rows(part.rows, part.row_count);
+   }
+   write_end_section();
+}
+
 variant_snapshot_writer::variant_snapshot_writer(fc::mutable_variant_object& snapshot)
 : snapshot(snapshot)
 {
@@ -157,6 +227,11 @@ void ostream_snapshot_writer::write_row( const detail::abstract_snapshot_row_wri
    row_count++;
 }
 
+void ostream_snapshot_writer::write_packed_rows( const std::vector<char>& rows, uint64_t count ) {
+   snapshot.write(rows.data(), rows.size());
+   row_count += count;
+}
+
 void ostream_snapshot_writer::write_end_section( ) {
    auto restore = snapshot.tellp();
 
@@ -183,6 +258,103 @@ void ostream_snapshot_writer::finalize() {
    snapshot.write((char*)&end_marker, sizeof(end_marker));
 }
 
+namespace {
+   // chunks compressed concurrently by an ostream_compressed_snapshot_writer, or decompressed ahead of the reader
+   constexpr size_t max_pending_chunks = 16;
+
+   constexpr std::streamoff snapshot_header_size = sizeof(ostream_snapshot_writer::magic_number) + sizeof(current_snapshot_version);
+}
+
+ostream_compressed_snapshot_writer::ostream_compressed_snapshot_writer(std::ostream& snapshot, int compression_level)
+:snapshot(snapshot)
+,header_pos(snapshot.tellp())
+,compression_level(compression_level)
+{
+   // write magic number
+   auto totem = magic_number;
+   snapshot.write((char*)&totem, sizeof(totem));
+
+   // write version
+   auto version = current_snapshot_version;
+   snapshot.write((char*)&version, sizeof(version));
+}
+
+void ostream_compressed_snapshot_writer::write_start_section( const std::string& section_name ) {
+   EOS_ASSERT(!in_section, snapshot_exception, "Attempting to write a new section without closing the previous section");
+   in_section = true;
+   sections.push_back(detail::compressed_snapshot_section{.name = section_name});
+}
+
+void ostream_compressed_snapshot_writer::write_row( const detail::abstract_snapshot_row_writer& row_writer ) {
+   row_writer.write(chunk);
+   ++sections.back().row_count;
+   while (chunk.tellp() >= chunk_size)
+      flush_chunk(chunk_size);
+}
+
+void ostream_compressed_snapshot_writer::write_packed_rows( const std::vector<char>& rows, uint64_t row_count ) {
+   sections.back().row_count += row_count;
+   for (size_t offset = 0; offset < rows.size();) {
+      const size_t n = std::min(rows.size() - offset, chunk_size - chunk.tellp());
+      chunk.write(rows.data() + offset, n);
+      offset += n;
+      if (chunk.tellp() >= chunk_size)
+         flush_chunk(chunk_size);
+   }
+}
+
+void ostream_compressed_snapshot_writer::write_end_section( ) {
+   // chunks never span sections, so that a section is read without touching the others
+   if (chunk.tellp() > 0)
+      flush_chunk(chunk.tellp());
+   in_section = false;
+}
+
+void ostream_compressed_snapshot_writer::flush_chunk(size_t size) {
+   // chunks are cut at chunk_size even within a row, so that they only depend on the bytes of the section
+   std::vector<char> data = std::move(chunk.storage());
+   chunk.storage().clear();
+   chunk.seekp(0);
+   if (data.size() > size) {
+      chunk.write(data.data() + size, data.size() - size);
+      data.resize(size);
+   }
+
+   pending_chunks.push_back(detail::pending_snapshot_chunk{
+      .section    = sections.size() - 1,
+      .size       = static_cast<uint32_t>(size),
+      .compressed = std::async(std::launch::async, [data = std::move(data), level = compression_level]() {
+         return fc::zlib_compress(data, level);
+      })});
+
+   while (pending_chunks.size() > max_pending_chunks)
+      write_chunk();
+}
+
+void ostream_compressed_snapshot_writer::write_chunk() {
+   detail::pending_snapshot_chunk& pending = pending_chunks.front();
+   const std::vector<char> compressed = pending.compressed.get();
+   EOS_ASSERT(compressed.size() <= std::numeric_limits<uint32_t>::max(), snapshot_exception,
+              "Compressed snapshot chunk of ${n} bytes is too large", ("n", compressed.size()));
+
+   sections[pending.section].chunks.push_back(detail::compressed_snapshot_chunk{
+      .offset          = static_cast<uint64_t>(snapshot.tellp() - header_pos),
+      .compressed_size = static_cast<uint32_t>(compressed.size()),
+      .size            = pending.size});
+   snapshot.write(compressed.data(), compressed.size());
+   pending_chunks.pop_front();
+}
+
+void ostream_compressed_snapshot_writer::finalize() {
+   EOS_ASSERT(!in_section, snapshot_exception, "Attempting to finalize a snapshot without closing its last section");
+   while (!pending_chunks.empty())
+      write_chunk();
+
+   const uint64_t toc_offset = snapshot.tellp() - header_pos;
+   fc::raw::pack(snapshot, sections);
+   snapshot.write((char*)&toc_offset, sizeof(toc_offset));
+}
+
 ostream_json_snapshot_writer::ostream_json_snapshot_writer(std::ostream& snapshot)
       :snapshot(snapshot)
       ,row_count(0)
@@ -222,13 +394,165 @@ void ostream_json_snapshot_writer::finalize() {
 }
 
 
+namespace detail {
+
+   // streambuf over the next size bytes of in, which a thread of its own reads in blocks ahead of the reader
+   class read_ahead_streambuf : public std::streambuf {
+      public:
+         read_ahead_streambuf(std::istream& in, uint64_t size)
+         :in(in)
+         ,remaining(size)
+         ,thread([this]() { read_blocks(); })
+         {}
+
+         ~read_ahead_streambuf() {
+            {
+               std::lock_guard g(mtx);
+               stopping = true;
+            }
+            cv.notify_all();
+            thread.join();
+         }
+
+      protected:
+         int_type underflow() override {
+            std::unique_lock g(mtx);
+            cv.wait(g, [this]() { return !blocks.empty() || done; });
+            if (blocks.empty()) {
+               if (error)
+                  std::rethrow_exception(error);
+               return traits_type::eof();
+            }
+            current = std::move(blocks.front());
+            blocks.pop_front();
+            g.unlock();
+            cv.notify_all();
+
+            setg(current.data(), current.data(), current.data() + current.size());
+            return traits_type::to_int_type(current.front());
+         }
+
+      private:
+         void read_blocks() {
+            try {
+               while (remaining > 0) {
+                  std::vector<char> block(std::min<uint64_t>(remaining, block_size));
+                  in.read(block.data(), block.size());
+                  EOS_ASSERT(in.gcount() == static_cast<std::streamsize>(block.size()), snapshot_exception,
+                             "Binary snapshot section is truncated");
+                  remaining -= block.size();
+
+                  std::unique_lock g(mtx);
+                  cv.wait(g, [this]() { return blocks.size() < max_pending_blocks || stopping; });
+                  if (stopping)
+                     break;
+                  blocks.push_back(std::move(block));
+                  g.unlock();
+                  cv.notify_all();
+               }
+            } catch (...) {
+               std::lock_guard g(mtx);
+               error = std::current_exception();
+            }
+            {
+               std::lock_guard g(mtx);
+               done = true;
+            }
+            cv.notify_all();
+         }
+
+         static constexpr size_t block_size         = 4 * 1024 * 1024;
+         static constexpr size_t max_pending_blocks = 16;
+
+         std::istream&                 in;
+         uint64_t                      remaining;
+         std::mutex                    mtx;
+         std::condition_variable       cv;
+         std::deque<std::vector<char>> blocks;
+         std::vector<char>             current;
+         std::exception_ptr            error;
+         bool                          done     = false;
+         bool                          stopping = false;
+         std::thread                   thread;
+   };
+
+   // streambuf over the chunks of a section of the compressed container, the next chunks are decompressed concurrently
+   // ahead of the reader
+   class compressed_chunks_streambuf : public std::streambuf {
+      public:
+         compressed_chunks_streambuf(std::istream& in, std::streampos header_pos, const std::vector<compressed_snapshot_chunk>& chunks)
+         :in(in)
+         ,header_pos(header_pos)
+         ,chunks(chunks)
+         {}
+
+      protected:
+         int_type underflow() override {
+            while (pending.size() < max_pending_chunks && next_chunk < chunks.size()) {
+               const compressed_snapshot_chunk& c = chunks[next_chunk++];
+               std::vector<char> compressed(c.compressed_size);
+               in.seekg(header_pos + std::streamoff(c.offset));
+               in.read(compressed.data(), compressed.size());
+               EOS_ASSERT(in.gcount() == static_cast<std::streamsize>(compressed.size()), snapshot_exception,
+                          "Compressed snapshot chunk is truncated");
+               pending.push_back(std::async(std::launch::async, [compressed = std::move(compressed), size = c.size]() {
+                  std::vector<char> data = fc::zlib_decompress(compressed, size);
+                  EOS_ASSERT(data.size() == size, snapshot_exception,
+                             "Compressed snapshot chunk is ${a} bytes instead of ${e}", ("a", data.size())("e", size));
+                  return data;
+               }));
+            }
+            while (!pending.empty()) {
+               current = pending.front().get();
+               pending.pop_front();
+               if (!current.empty()) {
+                  setg(current.data(), current.data(), current.data() + current.size());
+                  return traits_type::to_int_type(current.front());
+               }
+            }
+            return traits_type::eof();
+         }
+
+      private:
+         std::istream&                                  in;
+         std::streampos                                 header_pos;
+         const std::vector<compressed_snapshot_chunk>&  chunks;
+         size_t                                         next_chunk = 0;
+         std::deque<std::future<std::vector<char>>>     pending; // destroying them waits for their decompression
+         std::vector<char>                              current;
+   };
+
+}
+
 istream_snapshot_reader::istream_snapshot_reader(std::istream& snapshot)
 :snapshot(snapshot)
 ,header_pos(snapshot.tellg())
 ,num_rows(0)
 ,cur_row(0)
 {
+   // the compressed container is read through the table of contents at its end
+   auto restore_pos = fc::make_scoped_exit([&snapshot,pos=snapshot.tellg()](){
+      snapshot.clear();
+      snapshot.seekg(pos);
+   });
+
+   uint32_t totem = 0;
+   if (snapshot.read((char*)&totem, sizeof(totem)) && totem == ostream_compressed_snapshot_writer::magic_number) {
+      uint64_t toc_offset = 0;
+      snapshot.seekg(-std::streamoff(sizeof(toc_offset)), std::ios::end);
+      snapshot.read((char*)&toc_offset, sizeof(toc_offset));
+      EOS_ASSERT(snapshot, snapshot_exception, "Compressed snapshot has no table of contents");
+      snapshot.seekg(header_pos + std::streamoff(toc_offset));
+      sections.emplace();
+      fc::raw::unpack(snapshot, *sections);
+      EOS_ASSERT(snapshot, snapshot_exception, "Compressed snapshot has a truncated table of contents");
+   }
+}
 
+istream_snapshot_reader::~istream_snapshot_reader() {
+   // the read ahead thread reads the snapshot stream, stop it before the stream goes away
+   rows.reset();
+   read_ahead.reset();
 }
 
 void istream_snapshot_reader::validate() const {
@@ -242,7 +566,7 @@ void istream_snapshot_reader::validate() const {
 
    try {
       // validate totem
-      auto expected_totem = ostream_snapshot_writer::magic_number;
+      auto expected_totem = sections ? ostream_compressed_snapshot_writer::magic_number : ostream_snapshot_writer::magic_number;
       decltype(expected_totem) actual_totem;
       snapshot.read((char*)&actual_totem, sizeof(actual_totem));
       EOS_ASSERT(actual_totem == expected_totem, snapshot_exception,
@@ -256,10 +580,26 @@ void istream_snapshot_reader::validate() const {
                  "Binary snapshot is an unsuppored version.  Expected : ${expected}, Got: ${actual}",
                  ("expected", expected_version)("actual", actual_version));
 
-      while (validate_section()) {}
+      if (sections)
+         validate_table_of_contents();
+      else
+         while (validate_section()) {}
    } FC_LOG_AND_RETHROW()
 }
 
+void istream_snapshot_reader::validate_table_of_contents() const {
+   // the chunks are between the header and the offset of the table of contents which ends the snapshot
+   snapshot.seekg(0, std::ios::end);
+   const uint64_t footer_offset = static_cast<uint64_t>(snapshot.tellg() - header_pos) - sizeof(uint64_t);
+   for (const auto& section : *sections) {
+      for (const auto& chunk : section.chunks) {
+         EOS_ASSERT(chunk.offset >= static_cast<uint64_t>(snapshot_header_size) && chunk.offset + chunk.compressed_size <= footer_offset,
+                    snapshot_exception, "Compressed snapshot section ${s} has a chunk outside of the snapshot",
+                    ("s", section.name));
+      }
+   }
+}
+
 bool istream_snapshot_reader::validate_section() const {
    uint64_t section_size = 0;
    snapshot.read((char*)&section_size,sizeof(section_size));
@@ -276,13 +616,24 @@ bool istream_snapshot_reader::validate_section() const {
 }
 
 void istream_snapshot_reader::set_section( const string& section_name ) {
+   clear_section();
+
+   if (sections) {
+      auto it = std::find_if(sections->begin(), sections->end(), [&](const auto& s) { return s.name == section_name; });
+      EOS_ASSERT(it != sections->end(), snapshot_exception, "Binary snapshot has no section named ${n}", ("n", section_name));
+      cur_row = 0;
+      num_rows = it->row_count;
+      read_ahead = std::make_unique<detail::compressed_chunks_streambuf>(snapshot, header_pos, it->chunks);
+      rows = std::make_unique<std::istream>(read_ahead.get());
+      rows->exceptions(std::istream::badbit); // rethrow the errors of the decompression
+      return;
+   }
+
    auto restore_pos = fc::make_scoped_exit([this,pos=snapshot.tellg()](){
       snapshot.seekg(pos);
    });
 
-   const std::streamoff header_size = sizeof(ostream_snapshot_writer::magic_number) + sizeof(current_snapshot_version);
-
-   auto next_section_pos = header_pos + header_size;
+   auto next_section_pos = header_pos + snapshot_header_size;
 
    while (true) {
       snapshot.seekg(next_section_pos);
@@ -309,8 +660,11 @@ void istream_snapshot_reader::set_section( const string& section_name ) {
          cur_row = 0;
          num_rows = row_count;
 
-         // leave the stream at the right point
+         // the rows are read from here to the end of the section
          restore_pos.cancel();
+         read_ahead = std::make_unique<detail::read_ahead_streambuf>(snapshot, next_section_pos - snapshot.tellg());
+         rows = std::make_unique<std::istream>(read_ahead.get());
+         rows->exceptions(std::istream::badbit); // rethrow the errors of the read ahead thread
          return;
       }
    }
@@ -319,7 +673,8 @@ void istream_snapshot_reader::set_section( const string& section_name ) {
 }
 
 bool istream_snapshot_reader::read_row( detail::abstract_snapshot_row_reader& row_reader ) {
-   row_reader.provide(snapshot);
+   EOS_ASSERT(rows, snapshot_exception, "Binary snapshot row read without a section");
+   row_reader.provide(*rows);
    return ++cur_row < num_rows;
 }
 
@@ -328,13 +683,82 @@ bool istream_snapshot_reader::empty ( ) {
 }
 
 void istream_snapshot_reader::clear_section() {
+   rows.reset();
+   read_ahead.reset();
    num_rows = 0;
    cur_row = 0;
 }
 
 void istream_snapshot_reader::return_to_header() {
-   snapshot.seekg( header_pos );
    clear_section();
+   snapshot.seekg( header_pos );
+}
+
+std::vector<std::pair<std::string, uint64_t>> istream_snapshot_reader::section_list() {
+   std::vector<std::pair<std::string, uint64_t>> result;
+   if (sections) {
+      for (const auto& section : *sections)
+         result.emplace_back(section.name, section.row_count);
+      return result;
+   }
+
+   auto restore_pos = fc::make_scoped_exit([this,pos=snapshot.tellg()](){
+      snapshot.seekg(pos);
+   });
+
+   auto next_section_pos = header_pos + snapshot_header_size;
+   while (true) {
+      snapshot.seekg(next_section_pos);
+      uint64_t section_size = 0;
+      snapshot.read((char*)&section_size,sizeof(section_size));
+      if (section_size == std::numeric_limits<uint64_t>::max()) {
+         break;
+      }
+      next_section_pos = snapshot.tellg() + std::streamoff(section_size);
+
+      uint64_t row_count = 0;
+      snapshot.read((char*)&row_count,sizeof(row_count));
+      std::string name;
+      std::getline(snapshot, name, '\0');
+      result.emplace_back(std::move(name), row_count);
+   }
+   return result;
+}
+
+void convert_snapshot( std::istream& in, std::ostream& out, snapshot_container to ) {
+   istream_snapshot_reader reader(in);
+   reader.validate();
+
+   auto copy_sections = [&reader](snapshot_writer& writer) {
+      constexpr size_t block_size = 4 * 1024 * 1024;
+      std::vector<char> block;
+      for (const auto& [name, row_count] : reader.section_list()) {
+         reader.set_section(name);
+         writer.write_start_section(name);
+         uint64_t block_rows = row_count; // the count is added once, with the first block
+         while (true) {
+            block.resize(block_size);
+            reader.rows->read(block.data(), block.size());
+            block.resize(reader.rows->gcount());
+            if (block.empty())
+               break;
+            writer.write_packed_rows(block, block_rows);
+            block_rows = 0;
+         }
+         writer.write_end_section();
+         reader.clear_section();
+      }
+   };
+
+   if (to == snapshot_container::compressed) {
+      ostream_compressed_snapshot_writer writer(out);
+      copy_sections(writer);
+      writer.finalize();
+   } else {
+      ostream_snapshot_writer writer(out);
+      copy_sections(writer);
+      writer.finalize();
+   }
 }
 
 struct istream_json_snapshot_reader_impl {
@@ -436,6 +860,13 @@ void integrity_hash_snapshot_writer::write_row( const detail::abstract_snapshot_
    row_writer.write(enc);
 }
 
+void integrity_hash_snapshot_writer::write_packed_rows( const std::vector<char>& rows, uint64_t ) {
+   // the encoder takes 32 bit lengths
+   constexpr size_t max_write = 1u << 30;
+   for (size_t offset = 0; offset < rows.size(); offset += max_write)
+      enc.write(rows.data() + offset, std::min(max_write, rows.size() - offset));
+}
+
 void integrity_hash_snapshot_writer::write_end_section( ) {
    // no-op for structural details
 }
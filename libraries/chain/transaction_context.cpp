@@ -70,6 +70,9 @@ namespace eosio::chain {
 
    transaction_context::~transaction_context()
    {
+      // account usage of a transaction neither squashed nor undone is dropped along with its undo session
+      if (undo_session) control.get_mutable_resource_limits_manager().undo_transaction_usage();
+
       if(auto dm_logger = control.get_deep_mind_logger(is_transient()))
       {
          dm_logger->on_end_transaction();
@@ -406,11 +409,15 @@ namespace eosio::chain {
 
    void transaction_context::squash() {
       if (undo_session) undo_session->squash();
+      if (!is_read_only()) control.get_mutable_resource_limits_manager().squash_transaction_usage();
       control.apply_trx_block_context(trx_blk_context);
    }
 
    void transaction_context::undo() {
-      if (undo_session) undo_session->undo();
+      if (undo_session) {
+         undo_session->undo();
+         control.get_mutable_resource_limits_manager().undo_transaction_usage();
+      }
    }
 
    void transaction_context::check_net_usage()const {
@@ -89,11 +89,16 @@ namespace eosio { namespace chain {
          return;
 #ifdef EOSIO_EOS_VM_OC_RUNTIME_ENABLED
       if (my->eosvmoc && (eosvmoc_tierup == wasm_interface::vm_oc_enable::oc_all || context.should_use_eos_vm_oc())) {
+         const bool is_write_window = context.control.is_write_window();
+         const chain::eosvmoc::code_tuple code{code_hash, vm_version};
          const chain::eosvmoc::code_descriptor* cd = nullptr;
          chain::eosvmoc::code_cache_base::get_cd_failure failure = chain::eosvmoc::code_cache_base::get_cd_failure::temporary;
          try {
             const bool high_priority = context.get_receiver().prefix() == chain::config::system_account_name;
-            cd = my->eosvmoc->cc.get_descriptor_for_code(high_priority, code_hash, vm_version, context.control.is_write_window(), failure);
+            // only code executed often enough is worth a compile slot, code already compiled or imported is always used
+            const bool hot = my->eosvmoc->count_execution(code, is_write_window);
+            if (hot || high_priority || my->eosvmoc->cc.is_cached(code_hash, vm_version))
+               cd = my->eosvmoc->cc.get_descriptor_for_code(high_priority, code_hash, vm_version, is_write_window, failure);
             if (test_disable_tierup)
                cd = nullptr;
          } catch (...) {
@@ -104,26 +109,72 @@ namespace eosio { namespace chain {
                elog("EOS VM OC has encountered an unexpected failure");
             once_is_enough = true;
          }
+
+         const std::unique_ptr<wasm_instantiated_module_interface>* module = nullptr;
+         if (!cd)
+            module = &my->get_instantiated_module(code_hash, vm_type, vm_version, context.trx_context);
+         const fc::time_point start = fc::time_point::now();
+         auto record_cpu = fc::make_scoped_exit([&]() {
+            my->eosvmoc->add_cpu(code, fc::time_point::now() - start, is_write_window);
+         });
          if (cd) {
             if (!context.is_applying_block()) // read_only_trx_test.py looks for this log statement
                tlog("${a} speculatively executing ${h} with eos vm oc", ("a", context.get_receiver())("h", code_hash));
             my->eosvmoc->exec->execute(*cd, *my->eosvmoc->mem, context);
-            return;
+         } else {
+            (*module)->apply(context);
          }
+         return;
       }
 #endif
 
       my->get_instantiated_module(code_hash, vm_type, vm_version, context.trx_context)->apply(context);
    }
 
+   void wasm_interface::prefetch(const digest_type& code_hash, const uint8_t& vm_type, const uint8_t& vm_version, bool use_eos_vm_oc,
+                                 uint32_t block_num, boost::asio::io_context& thread_pool) {
+#ifdef EOSIO_EOS_VM_OC_RUNTIME_ENABLED
+      if (my->eosvmoc && (eosvmoc_tierup == wasm_interface::vm_oc_enable::oc_all || use_eos_vm_oc)) {
+         try {
+            chain::eosvmoc::code_cache_base::get_cd_failure failure = chain::eosvmoc::code_cache_base::get_cd_failure::temporary;
+            // queues compilation when executed often enough and not yet compiled, does not wait for it
+            if ((my->eosvmoc->is_hot({code_hash, vm_version}) || my->eosvmoc->cc.is_cached(code_hash, vm_version)) &&
+                my->eosvmoc->cc.get_descriptor_for_code(false, code_hash, vm_version, true, failure))
+               return;
+         } catch (...) {
+            // reported when the code is applied
+         }
+         // not compiled in time for the block, it will run on the base runtime
+      }
+#endif
+      my->prefetch_instantiated_module(code_hash, vm_type, vm_version, block_num, thread_pool);
+   }
+
    bool wasm_interface::is_code_cached(const digest_type& code_hash, const uint8_t& vm_type, const uint8_t& vm_version) const {
       return my->is_code_cached(code_hash, vm_type, vm_version);
    }
 
+   bool wasm_interface::is_code_prefetched(const digest_type& code_hash, const uint8_t& vm_type, const uint8_t& vm_version) const {
+      return my->is_code_prefetched(code_hash, vm_type, vm_version);
+   }
+
 #ifdef EOSIO_EOS_VM_OC_RUNTIME_ENABLED
    bool wasm_interface::is_eos_vm_oc_enabled() const {
       return my->is_eos_vm_oc_enabled();
    }
+
+   wasm_interface::eosvmoc_stats wasm_interface::get_eosvmoc_metrics() const {
+      return my->eosvmoc ? my->eosvmoc->get_metrics() : eosvmoc_stats{};
+   }
+
+   wasm_interface::eosvmoc_stats wasm_interface::get_eosvmoc_stats(uint32_t limit) const {
+      return my->eosvmoc ? my->eosvmoc->stats(limit) : eosvmoc_stats{};
+   }
+
+   void wasm_interface::limit_eosvmoc_compile_threads(bool limit) {
+      if (my->eosvmoc)
+         my->eosvmoc->cc.limit_compile_threads(limit);
+   }
 #endif
 
    wasm_instantiated_module_interface::~wasm_instantiated_module_interface() = default;
@@ -9,6 +9,8 @@
 #include <eosio/chain/webassembly/eos-vm-oc/compile_monitor.hpp>
 #include <eosio/chain/exceptions.hpp>
 
+#include <fc/io/cfile.hpp>
+
 #include <unistd.h>
 #include <sys/syscall.h>
 #include <sys/mman.h>
@@ -38,10 +40,12 @@ static constexpr size_t descriptor_ptr_from_file_start = header_offset + offseto
 
 static_assert(sizeof(code_cache_header) <= header_size, "code_cache_header too big");
 
-code_cache_async::code_cache_async(const std::filesystem::path& data_dir, const eosvmoc::config& eosvmoc_config, const chainbase::database& db) :
-   code_cache_base(data_dir, eosvmoc_config, db),
-   _result_queue(eosvmoc_config.threads * 2),
-   _threads(eosvmoc_config.threads)
+code_cache_async::code_cache_async(const std::filesystem::path& data_dir, const eosvmoc::config& eosvmoc_config, const chainbase::database& db,
+                                   const code_usage_map* usage) :
+   code_cache_base(data_dir, eosvmoc_config, db, usage),
+   _result_queue(std::max<size_t>(eosvmoc_config.threads, eosvmoc_config.burst_threads) * 2),
+   _threads(eosvmoc_config.threads),
+   _burst_threads(eosvmoc_config.burst_threads)
 {
    FC_ASSERT(_threads, "EOS VM OC requires at least 1 compile thread");
 
@@ -110,27 +114,16 @@ const code_descriptor* const code_cache_async::get_descriptor_for_code(bool high
    //if there are any outstanding compiles, process the result queue now
    //When app is in write window, all tasks are running sequentially and read-only threads
    //are not running. Safe to update cache entries.
-   if(is_write_window && _outstanding_compiles_and_poison.size()) {
-      auto [count_processed, bytes_remaining] = consume_compile_thread_queue();
-
-      if(count_processed)
-         check_eviction_threshold(bytes_remaining);
-
-      while(count_processed && _queued_compiles.size()) {
-         auto nextup = _queued_compiles.begin();
-
-         //it's not clear this check is required: if apply() was called for code then it existed in the code_index; and then
-         // if we got notification of it no longer existing we would have removed it from queued_compiles
-         const code_object* const codeobject = _db.find<code_object,by_code_hash>(boost::make_tuple(nextup->code_id, 0, nextup->vm_version));
-         if(codeobject) {
-            _outstanding_compiles_and_poison.emplace(*nextup, false);
-            std::vector<wrapped_fd> fds_to_pass;
-            fds_to_pass.emplace_back(memfd_for_bytearray(codeobject->code));
-            FC_ASSERT(write_message_with_fds(_compile_monitor_write_socket, compile_wasm_message{ *nextup, _eosvmoc_config }, fds_to_pass), "EOS VM failed to communicate to OOP manager");
-            --count_processed;
-         }
-         _queued_compiles.erase(nextup);
+   if(is_write_window) {
+      if(_outstanding_compiles_and_poison.size()) {
+         auto [count_processed, bytes_remaining] = consume_compile_thread_queue();
+
+         if(count_processed)
+            check_eviction_threshold(bytes_remaining);
       }
+
+      //fill the compile threads freed up by finished compiles, or added by lifting the limit on them
+      start_queued_compiles();
    }
 
    //check for entry in cache
@@ -156,16 +149,17 @@ const code_descriptor* const code_cache_async::get_descriptor_for_code(bool high
       it->second = false;
       return nullptr;
    }
-   if(auto it = _queued_compiles.get<by_hash>().find(boost::make_tuple(std::ref(code_id), vm_version)); it != _queued_compiles.get<by_hash>().end()) {
+   if(auto it = _queued_compiles.get<by_hash>().find(ct); it != _queued_compiles.get<by_hash>().end()) {
+      //usage grows while queued
+      const uint64_t priority = compile_priority(ct, high_priority);
+      if(priority > it->priority)
+         _queued_compiles.get<by_hash>().modify(it, [&](queued_compile& q) { q.priority = priority; });
       failure = get_cd_failure::temporary; // Compile might not be done yet
       return nullptr;
    }
 
-   if(_outstanding_compiles_and_poison.size() >= _threads) {
-      if (high_priority)
-         _queued_compiles.push_front(ct);
-      else
-         _queued_compiles.push_back(ct);
+   if(_outstanding_compiles_and_poison.size() >= compile_threads()) {
+      _queued_compiles.insert(queued_compile{ct, compile_priority(ct, high_priority)});
       failure = get_cd_failure::temporary; // Compile might not be done yet
       return nullptr;
    }
@@ -184,6 +178,23 @@ const code_descriptor* const code_cache_async::get_descriptor_for_code(bool high
    return nullptr;
 }
 
+void code_cache_async::start_queued_compiles() {
+   while(_queued_compiles.size() && _outstanding_compiles_and_poison.size() < compile_threads()) {
+      auto nextup = _queued_compiles.begin();
+
+      //it's not clear this check is required: if apply() was called for code then it existed in the code_index; and then
+      // if we got notification of it no longer existing we would have removed it from queued_compiles
+      const code_object* const codeobject = _db.find<code_object,by_code_hash>(boost::make_tuple(nextup->code.code_id, 0, nextup->code.vm_version));
+      if(codeobject) {
+         _outstanding_compiles_and_poison.emplace(nextup->code, false);
+         std::vector<wrapped_fd> fds_to_pass;
+         fds_to_pass.emplace_back(memfd_for_bytearray(codeobject->code));
+         FC_ASSERT(write_message_with_fds(_compile_monitor_write_socket, compile_wasm_message{ nextup->code, _eosvmoc_config }, fds_to_pass), "EOS VM failed to communicate to OOP manager");
+      }
+      _queued_compiles.erase(nextup);
+   }
+}
+
 code_cache_sync::~code_cache_sync() {
    //it's exceedingly critical that we wait for the compile monitor to be done with all its work
    //This is easy in the sync case
@@ -224,10 +235,12 @@ const code_descriptor* const code_cache_sync::get_descriptor_for_code_sync(const
    return &*_cache_index.push_front(std::move(std::get<code_descriptor>(result.result))).first;
 }
 
-code_cache_base::code_cache_base(const std::filesystem::path& data_dir, const eosvmoc::config& eosvmoc_config, const chainbase::database& db) :
+code_cache_base::code_cache_base(const std::filesystem::path& data_dir, const eosvmoc::config& eosvmoc_config, const chainbase::database& db,
+                                 const code_usage_map* usage) :
    _db(db),
    _eosvmoc_config(eosvmoc_config),
-   _cache_file_path(data_dir/"code_cache.bin") {
+   _cache_file_path(data_dir/"code_cache.bin"),
+   _usage(usage) {
    static_assert(sizeof(allocator_t) <= header_offset, "header offset intersects with allocator");
 
    std::filesystem::create_directories(data_dir);
@@ -312,10 +325,13 @@ code_cache_base::code_cache_base(const std::filesystem::path& data_dir, const eo
 
       ilog("EOS VM Optimized Compiler code cache loaded with ${c} entries; ${f} of ${t} bytes free", ("c", number_entries)("f", allocator->get_free_memory())("t", allocator->get_size()));
    }
-   munmap(code_mapping, eosvmoc_config.cache_size);
 
    _free_bytes_eviction_threshold = eosvmoc_config.cache_size * .1;
 
+   if(!eosvmoc_config.import_file.empty())
+      import_code_cache(code_mapping, eosvmoc_config.import_file);
+   munmap(code_mapping, eosvmoc_config.cache_size);
+
    wrapped_fd compile_monitor_conn = get_connection_to_compile_monitor(_cache_fd);
 
    //okay, let's do this by the book: we're not allowed to write & read on different threads to the same asio socket. So create two fds
@@ -325,6 +341,137 @@ code_cache_base::code_cache_base(const std::filesystem::path& data_dir, const eo
    _compile_monitor_read_socket.assign(local::datagram_protocol(), compile_monitor_conn.release());
 }
 
+void code_cache_base::import_code_cache(char* code_mapping, const std::filesystem::path& import_file) {
+   allocator_t* allocator = reinterpret_cast<allocator_t*>(code_mapping);
+   size_t imported = 0;
+
+   try {
+      fc::datastream<fc::cfile> ds;
+      ds.set_file_path(import_file);
+      ds.open("rb");
+
+      code_cache_export_header header;
+      fc::raw::unpack(ds, header);
+      if(header.id != code_cache_export_header::id_value || header.version != code_cache_export_header::current_version) {
+         wlog("${f} is not a compatible EOS VM OC code cache export, ignoring it", ("f", import_file));
+         return;
+      }
+      if(header.codegen_version != current_codegen_version) {
+         wlog("EOS VM OC code cache export ${f} is of codegen version ${v} instead of ${c}, ignoring it",
+              ("f", import_file)("v", header.codegen_version)("c", current_codegen_version));
+         return;
+      }
+
+      for(uint32_t i = 0; i < header.num_entries; ++i) {
+         std::vector<char> packed;
+         fc::sha256        checksum;
+         fc::raw::unpack(ds, packed);
+         fc::raw::unpack(ds, checksum);
+         if(fc::sha256::hash(packed.data(), packed.size()) != checksum) {
+            wlog("skipping corrupt entry ${i} of EOS VM OC code cache export ${f}", ("i", i)("f", import_file));
+            continue;
+         }
+         exported_code code = fc::raw::unpack<exported_code>(packed);
+         if(_cache_index.get<by_hash>().count(boost::make_tuple(code.code_hash, code.vm_version)))
+            continue;
+
+         //entries are most recently used first, so stop at the first one that would leave compiles to evict
+         if(allocator->get_free_memory() < _free_bytes_eviction_threshold + code.code.size() + code.initdata.size())
+            break;
+         char* code_ptr = (char*)allocator->allocate(code.code.size());
+         char* initdata_ptr = (char*)allocator->allocate(code.initdata.size());
+         if(!code_ptr || !initdata_ptr) {
+            if(code_ptr)
+               allocator->deallocate(code_ptr);
+            if(initdata_ptr)
+               allocator->deallocate(initdata_ptr);
+            break;
+         }
+         memcpy(code_ptr, code.code.data(), code.code.size());
+         memcpy(initdata_ptr, code.initdata.data(), code.initdata.size());
+
+         _cache_index.push_back(code_descriptor{
+            .code_hash = code.code_hash,
+            .vm_version = code.vm_version,
+            .codegen_version = current_codegen_version,
+            .code_begin = (size_t)(code_ptr - code_mapping),
+            .start = code.start,
+            .apply_offset = code.apply_offset,
+            .starting_memory_pages = code.starting_memory_pages,
+            .initdata_begin = (size_t)(initdata_ptr - code_mapping),
+            .initdata_size = (unsigned)code.initdata.size(),
+            .initdata_prologue_size = code.initdata_prologue_size
+         });
+         ++imported;
+      }
+   } catch(const fc::exception& e) {
+      wlog("failed to read EOS VM OC code cache export ${f}: ${e}", ("f", import_file)("e", e.to_detail_string()));
+   } catch(const std::exception& e) {
+      wlog("failed to read EOS VM OC code cache export ${f}: ${e}", ("f", import_file)("e", e.what()));
+   }
+
+   ilog("Imported ${n} entries of EOS VM OC code cache export ${f}; ${b} of ${t} bytes free",
+        ("n", imported)("f", import_file)("b", allocator->get_free_memory())("t", allocator->get_size()));
+}
+
+size_t export_code_cache(const std::filesystem::path& state_dir, const std::filesystem::path& export_file) {
+   const std::filesystem::path cache_file_path = state_dir/"code_cache.bin";
+   EOS_ASSERT(std::filesystem::exists(cache_file_path), database_exception, "no EOS VM OC code cache in ${d}", ("d", state_dir));
+
+   bip::file_mapping mapping(cache_file_path.generic_string().c_str(), bip::read_only);
+   bip::mapped_region region(mapping, bip::read_only);
+   const char* code_mapping = (const char*)region.get_address();
+   EOS_ASSERT(region.get_size() >= total_header_size, bad_database_version_exception, "failed to read code cache header");
+
+   code_cache_header cache_header;
+   memcpy((char*)&cache_header, code_mapping + header_offset, sizeof(cache_header));
+   EOS_ASSERT(cache_header.id == header_id, bad_database_version_exception, "existing EOS VM OC code cache not compatible with this version");
+   EOS_ASSERT(!cache_header.dirty, database_exception, "code cache is dirty");
+
+   const allocator_t* allocator = reinterpret_cast<const allocator_t*>(code_mapping);
+
+   //the serialized index is in most recently used order
+   std::vector<code_descriptor> descriptors;
+   if(cache_header.serialized_descriptor_index) {
+      fc::datastream<const char*> ds(code_mapping + cache_header.serialized_descriptor_index, region.get_size() - cache_header.serialized_descriptor_index);
+      unsigned number_entries;
+      fc::raw::unpack(ds, number_entries);
+      for(unsigned i = 0; i < number_entries; ++i) {
+         code_descriptor cd;
+         fc::raw::unpack(ds, cd);
+         if(cd.codegen_version == current_codegen_version)
+            descriptors.push_back(std::move(cd));
+      }
+   }
+
+   fc::datastream<fc::cfile> out;
+   out.set_file_path(export_file);
+   out.open(fc::cfile::truncate_rw_mode);
+   fc::raw::pack(out, code_cache_export_header{.num_entries = (uint32_t)descriptors.size()});
+   for(const code_descriptor& cd : descriptors) {
+      //the size of the code is not recorded, but the code is all of its allocation
+      const char* code_ptr = code_mapping + cd.code_begin;
+      const char* initdata_ptr = code_mapping + cd.initdata_begin;
+      exported_code code{
+         .code_hash = cd.code_hash,
+         .vm_version = cd.vm_version,
+         .start = cd.start,
+         .apply_offset = cd.apply_offset,
+         .starting_memory_pages = cd.starting_memory_pages,
+         .initdata_prologue_size = cd.initdata_prologue_size,
+         .code = std::vector<char>(code_ptr, code_ptr + allocator->size(code_ptr)),
+         .initdata = std::vector<char>(initdata_ptr, initdata_ptr + cd.initdata_size)
+      };
+      const std::vector<char> packed = fc::raw::pack(code);
+      fc::raw::pack(out, packed);
+      fc::raw::pack(out, fc::sha256::hash(packed.data(), packed.size()));
+   }
+   out.flush();
+   out.close();
+
+   return descriptors.size();
+}
+
 void code_cache_base::set_on_disk_region_dirty(bool dirty) {
    bip::file_mapping dirty_mapping(_cache_file_path.generic_string().c_str(), bip::read_write);
    bip::mapped_region dirty_region(dirty_mapping, bip::read_write);
@@ -396,7 +543,7 @@ void code_cache_base::free_code(const digest_type& code_id, const uint8_t& vm_ve
    }
 
    //if it's in the queued list, erase it
-   if(auto i = _queued_compiles.get<by_hash>().find(boost::make_tuple(std::ref(code_id), vm_version)); i != _queued_compiles.get<by_hash>().end())
+   if(auto i = _queued_compiles.get<by_hash>().find(code_tuple{code_id, vm_version}); i != _queued_compiles.get<by_hash>().end())
       _queued_compiles.get<by_hash>().erase(i);
 
    //however, if it's currently being compiled there is no way to cancel the compile,
@@ -407,12 +554,49 @@ void code_cache_base::free_code(const digest_type& code_id, const uint8_t& vm_ve
       compiling_it->second = true;
 }
 
+uint64_t code_cache_base::compile_priority(const code_tuple& code, bool high_priority) const {
+   if(high_priority)
+      return std::numeric_limits<uint64_t>::max();
+   if(!_usage)
+      return 0;
+   auto it = _usage->find(code);
+   return it == _usage->end() ? 0 : it->second.cpu_us;
+}
+
 void code_cache_base::run_eviction_round() {
    evict_wasms_message evict_msg;
-   for(unsigned int i = 0; i < 25 && _cache_index.size() > 1; ++i) {
-      evict_msg.codes.emplace_back(_cache_index.back());
-      _cache_index.pop_back();
+   if(!_usage) {
+      for(unsigned int i = 0; i < 25 && _cache_index.size() > 1; ++i) {
+         evict_msg.codes.emplace_back(_cache_index.back());
+         _cache_index.pop_back();
+      }
+   } else {
+      //evict the code with the least cpu, least recently used first for equal cpu; never the most recently used
+      struct candidate {
+         uint64_t                   cpu_us;
+         size_t                     lru_rank;
+         code_cache_index::iterator it;
+      };
+      std::vector<candidate> candidates;
+      candidates.reserve(_cache_index.size());
+      size_t lru_rank = _cache_index.size();
+      for(auto it = _cache_index.begin(); it != _cache_index.end(); ++it) {
+         --lru_rank;
+         if(it == _cache_index.begin())
+            continue;
+         auto u = _usage->find(code_tuple{it->code_hash, it->vm_version});
+         candidates.push_back({u == _usage->end() ? 0 : u->second.cpu_us, lru_rank, it});
+      }
+      const size_t count = std::min<size_t>(25, candidates.size());
+      std::partial_sort(candidates.begin(), candidates.begin() + count, candidates.end(), [](const candidate& a, const candidate& b) {
+         return std::tie(a.cpu_us, a.lru_rank) < std::tie(b.cpu_us, b.lru_rank);
+      });
+      for(size_t i = 0; i < count; ++i) {
+         evict_msg.codes.emplace_back(*candidates[i].it);
+         _cache_index.erase(candidates[i].it);
+      }
    }
+   _evictions += evict_msg.codes.size();
    write_message_with_fds(_compile_monitor_write_socket, evict_msg);
 }
 
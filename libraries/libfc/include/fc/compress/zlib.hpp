@@ -1,10 +1,18 @@
 #pragma once
 
+#include <span>
 #include <string>
+#include <vector>
 
 namespace fc 
 {
 
    std::string zlib_compress(const std::string& in);
 
+   /// @param level zlib compression level, 0 (no compression) to 9 (best compression)
+   std::vector<char> zlib_compress(std::span<const char> in, int level);
+
+   /// throws fc::exception if the decompressed data would be larger than max_size or if `in` is not a valid zlib stream
+   std::vector<char> zlib_decompress(std::span<const char> in, size_t max_size);
+
 } // namespace fc
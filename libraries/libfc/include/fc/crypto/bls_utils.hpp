@@ -9,4 +9,13 @@ namespace fc::crypto::blslib {
                std::span<const uint8_t> message,
                const bls_signature& signature);
 
+   // Verify n (pubkey, message, signature) triples with one multi-pairing. Signatures are combined
+   // using random 64-bit weights, so the check fails if any signature is invalid (except with
+   // probability 2^-64). Public keys signing the same message are combined, which requires only
+   // 1 + (number of distinct messages) pairings instead of 2 per signature.
+   // Returns false without identifying the invalid signature, use verify() on each to find it.
+   bool verify_batch(std::span<const bls_public_key* const> pubkeys,
+                     std::span<const std::span<const uint8_t>> messages,
+                     std::span<const bls_signature* const> signatures);
+
 } // fc::crypto::blslib
@@ -36,6 +36,12 @@ class sha256
     static sha256 hash( const std::string& );
     static sha256 hash( const sha256& );
 
+    /**
+     * Hash sibling pairs: out[i] = hash of the 64 bytes in[2*i] || in[2*i+1]. Independent pairs are hashed
+     * eight at a time by a multi-buffer kernel on CPUs that support AVX2. in.size() must be 2 * out.size().
+     */
+    static void hash_pairs( std::span<const sha256> in, std::span<sha256> out );
+
     template<typename T>
     static sha256 hash( const T& t ) 
     { 
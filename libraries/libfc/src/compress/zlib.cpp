@@ -1,4 +1,5 @@
 #include <fc/compress/zlib.hpp>
+#include <fc/exception/exception.hpp>
 
 #include <boost/iostreams/filtering_stream.hpp>
 #include <boost/iostreams/device/back_inserter.hpp>
@@ -8,6 +9,23 @@ namespace bio = boost::iostreams;
 
 namespace fc
 {
+  namespace {
+    struct write_limiter {
+      using char_type = char;
+      using category = bio::multichar_output_filter_tag;
+
+      template<typename Sink>
+      std::streamsize write(Sink& sink, const char* s, std::streamsize count) {
+        FC_ASSERT(total + static_cast<size_t>(count) <= max_size, "Exceeded maximum decompressed size ${m}", ("m", max_size));
+        total += count;
+        return bio::write(sink, s, count);
+      }
+
+      size_t max_size = 0;
+      size_t total = 0;
+    };
+  }
+
   std::string zlib_compress(const std::string& in)
   {
      std::string out;
@@ -18,4 +36,34 @@ namespace fc
     bio::close(comp);
     return out;
   }
+
+  std::vector<char> zlib_compress(std::span<const char> in, int level)
+  {
+    std::vector<char> out;
+    out.reserve(in.size() / 2);
+    bio::filtering_ostream comp;
+    comp.push(bio::zlib_compressor(bio::zlib_params(level)));
+    comp.push(bio::back_inserter(out));
+    bio::write(comp, in.data(), in.size());
+    bio::close(comp);
+    return out;
+  }
+
+  std::vector<char> zlib_decompress(std::span<const char> in, size_t max_size)
+  {
+    try {
+      std::vector<char> out;
+      bio::filtering_ostream decomp;
+      decomp.push(bio::zlib_decompressor());
+      decomp.push(write_limiter{max_size}); // zip bomb protection
+      decomp.push(bio::back_inserter(out));
+      bio::write(decomp, in.data(), in.size());
+      bio::close(decomp);
+      return out;
+    } catch( fc::exception& ) {
+      throw;
+    } catch( ... ) {
+      throw fc::unhandled_exception( FC_LOG_MESSAGE( warn, "zlib decompression error" ), std::current_exception() );
+    }
+  }
 }
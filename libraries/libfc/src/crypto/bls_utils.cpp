@@ -1,4 +1,7 @@
 #include <fc/crypto/bls_utils.hpp>
+#include <fc/crypto/rand.hpp>
+
+#include <algorithm>
 
 namespace fc::crypto::blslib {
 
@@ -8,4 +11,56 @@ namespace fc::crypto::blslib {
       return bls12_381::verify(pubkey.jacobian_montgomery_le(), message, signature.jacobian_montgomery_le());
    };
 
+   bool verify_batch(std::span<const bls_public_key* const> pubkeys,
+                     std::span<const std::span<const uint8_t>> messages,
+                     std::span<const bls_signature* const> signatures) {
+      const size_t n = pubkeys.size();
+      FC_ASSERT( messages.size() == n && signatures.size() == n,
+                 "verify_batch requires one message and one signature per public key" );
+      if (n == 0)
+         return true;
+      if (n == 1)
+         return verify(*pubkeys[0], messages[0], *signatures[0]);
+
+      // Only the low 64 bits are random, keeps weighted sums cheap.
+      std::vector<std::array<uint64_t, 4>> weights(n, std::array<uint64_t, 4>{});
+      for (auto& w : weights) {
+         fc::rand_bytes(reinterpret_cast<char*>(w.data()), sizeof(uint64_t));
+         w[0] |= 1; // never zero
+      }
+
+      std::vector<bls12_381::g2> sigs;
+      sigs.reserve(n);
+      for (const bls_signature* s : signatures)
+         sigs.push_back(s->jacobian_montgomery_le());
+
+      // 1 =? e(-g1, sum(r_i * sig_i)) * prod over distinct m of e(sum(r_i * pk_i for m_i == m), H(m))
+      std::vector<std::tuple<bls12_381::g1, bls12_381::g2>> v;
+      v.reserve(3); // votes for a block sign either the strong or the weak digest
+      bls12_381::pairing::add_pair(v, bls12_381::g1::one().negate(), bls12_381::g2::weightedSum(sigs, weights));
+
+      std::vector<bool> grouped(n, false);
+      std::vector<bls12_381::g1> keys;
+      std::vector<std::array<uint64_t, 4>> key_weights;
+      keys.reserve(n);
+      key_weights.reserve(n);
+      for (size_t i = 0; i < n; ++i) {
+         if (grouped[i])
+            continue;
+         keys.clear();
+         key_weights.clear();
+         for (size_t j = i; j < n; ++j) {
+            if (!grouped[j] && std::ranges::equal(messages[i], messages[j])) {
+               grouped[j] = true;
+               keys.push_back(pubkeys[j]->jacobian_montgomery_le());
+               key_weights.push_back(weights[j]);
+            }
+         }
+         bls12_381::pairing::add_pair(v, bls12_381::g1::weightedSum(keys, key_weights),
+                                      bls12_381::fromMessage(messages[i], bls12_381::CIPHERSUITE_ID));
+      }
+
+      return bls12_381::fp12::one().equal(bls12_381::pairing::calculate(v));
+   }
+
 } // fc::crypto::blslib
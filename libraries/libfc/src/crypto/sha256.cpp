@@ -9,8 +9,109 @@
 #include <fc/exception/exception.hpp>
 #include "_digest_common.hpp"
 
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#include <immintrin.h>
+#define FC_SHA256_MULTI_BUFFER
+#endif
+
 namespace fc {
 
+#ifdef FC_SHA256_MULTI_BUFFER
+namespace {
+
+   constexpr uint32_t sha256_k[64] = {
+      0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+      0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+      0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+      0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+      0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+      0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+      0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+      0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+   };
+
+   constexpr uint32_t sha256_h0[8] = {
+      0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
+   };
+
+   template<int n>
+   __attribute__((target("avx2"))) inline __m256i rotr8( __m256i x ) {
+      return _mm256_or_si256( _mm256_srli_epi32(x, n), _mm256_slli_epi32(x, 32 - n) );
+   }
+
+   // one sha256 compression of eight independent message blocks, lane i of each register belongs to message i
+   __attribute__((target("avx2"))) void compress8( __m256i (&s)[8], __m256i (&w)[16] ) {
+      __m256i a = s[0], b = s[1], c = s[2], d = s[3], e = s[4], f = s[5], g = s[6], h = s[7];
+      for( int t = 0; t < 64; ++t ) {
+         __m256i wt;
+         if( t < 16 ) {
+            wt = w[t];
+         } else {
+            const __m256i w15 = w[(t - 15) & 15];
+            const __m256i w2  = w[(t - 2) & 15];
+            const __m256i s0  = _mm256_xor_si256( _mm256_xor_si256( rotr8<7>(w15), rotr8<18>(w15) ), _mm256_srli_epi32(w15, 3) );
+            const __m256i s1  = _mm256_xor_si256( _mm256_xor_si256( rotr8<17>(w2), rotr8<19>(w2) ), _mm256_srli_epi32(w2, 10) );
+            wt = _mm256_add_epi32( _mm256_add_epi32( w[t & 15], s0 ), _mm256_add_epi32( w[(t - 7) & 15], s1 ) );
+            w[t & 15] = wt;
+         }
+         const __m256i S1  = _mm256_xor_si256( _mm256_xor_si256( rotr8<6>(e), rotr8<11>(e) ), rotr8<25>(e) );
+         const __m256i ch  = _mm256_xor_si256( _mm256_and_si256(e, f), _mm256_andnot_si256(e, g) );
+         const __m256i t1  = _mm256_add_epi32( _mm256_add_epi32( _mm256_add_epi32(h, S1), _mm256_add_epi32(ch, wt) ),
+                                               _mm256_set1_epi32( (int)sha256_k[t] ) );
+         const __m256i S0  = _mm256_xor_si256( _mm256_xor_si256( rotr8<2>(a), rotr8<13>(a) ), rotr8<22>(a) );
+         const __m256i maj = _mm256_xor_si256( _mm256_and_si256(a, b), _mm256_and_si256( c, _mm256_xor_si256(a, b) ) );
+         h = g; g = f; f = e;
+         e = _mm256_add_epi32( d, t1 );
+         d = c; c = b; b = a;
+         a = _mm256_add_epi32( t1, _mm256_add_epi32(S0, maj) );
+      }
+      s[0] = _mm256_add_epi32(s[0], a); s[1] = _mm256_add_epi32(s[1], b);
+      s[2] = _mm256_add_epi32(s[2], c); s[3] = _mm256_add_epi32(s[3], d);
+      s[4] = _mm256_add_epi32(s[4], e); s[5] = _mm256_add_epi32(s[5], f);
+      s[6] = _mm256_add_epi32(s[6], g); s[7] = _mm256_add_epi32(s[7], h);
+   }
+
+   // hashes the 64 byte messages in[2*i] || in[2*i+1] for i in [0, 8)
+   __attribute__((target("avx2"))) void hash_8_pairs( const sha256* in, sha256* out ) {
+      alignas(32) uint32_t words[16][8];
+      for( int lane = 0; lane < 8; ++lane ) {
+         const char* msg = in[2 * lane].data();
+         const char* sib = in[2 * lane + 1].data();
+         for( int j = 0; j < 16; ++j ) {
+            uint32_t v;
+            memcpy( &v, (j < 8 ? msg : sib) + (j & 7) * 4, sizeof(v) );
+            words[j][lane] = __builtin_bswap32( v );
+         }
+      }
+
+      __m256i s[8], w[16];
+      for( int i = 0; i < 8; ++i )
+         s[i] = _mm256_set1_epi32( (int)sha256_h0[i] );
+      for( int j = 0; j < 16; ++j )
+         w[j] = _mm256_load_si256( reinterpret_cast<const __m256i*>(words[j]) );
+      compress8( s, w );
+
+      // padding block of a 64 byte message
+      w[0] = _mm256_set1_epi32( (int)0x80000000 );
+      for( int j = 1; j < 15; ++j )
+         w[j] = _mm256_setzero_si256();
+      w[15] = _mm256_set1_epi32( 512 );
+      compress8( s, w );
+
+      alignas(32) uint32_t state[8][8];
+      for( int i = 0; i < 8; ++i )
+         _mm256_store_si256( reinterpret_cast<__m256i*>(state[i]), s[i] );
+      for( int lane = 0; lane < 8; ++lane ) {
+         for( int i = 0; i < 8; ++i ) {
+            const uint32_t v = __builtin_bswap32( state[i][lane] );
+            memcpy( out[lane].data() + i * 4, &v, sizeof(v) );
+         }
+      }
+   }
+
+} // anonymous namespace
+#endif
+
     sha256::sha256() { memset( _hash, 0, sizeof(_hash) ); }
     sha256::sha256( const char *data, size_t size ) {
        if (size != sizeof(_hash))
@@ -56,6 +157,25 @@ namespace fc {
         return hash( s.data(), sizeof( s._hash ) );
     }
 
+    void sha256::hash_pairs( std::span<const sha256> in, std::span<sha256> out ) {
+      FC_ASSERT( in.size() == 2 * out.size(), "sha256::hash_pairs: ${i} digests do not form ${o} pairs",
+                 ("i", in.size())("o", out.size()) );
+      size_t i = 0;
+#ifdef FC_SHA256_MULTI_BUFFER
+      static const bool has_avx2 = __builtin_cpu_supports( "avx2" );
+      if( has_avx2 ) {
+         for( ; i + 8 <= out.size(); i += 8 )
+            hash_8_pairs( &in[2 * i], &out[i] );
+      }
+#endif
+      for( ; i < out.size(); ++i ) {
+         encoder e;
+         e.write( in[2 * i].data(), sizeof(in[2 * i]._hash) );
+         e.write( in[2 * i + 1].data(), sizeof(in[2 * i + 1]._hash) );
+         out[i] = e.result();
+      }
+    }
+
     void sha256::encoder::write( const char* d, uint32_t dlen ) {
       SHA256_Update( &my->ctx, d, dlen);
     }
@@ -0,0 +1,33 @@
+#include <boost/test/unit_test.hpp>
+
+#include <fc/compress/zlib.hpp>
+#include <fc/exception/exception.hpp>
+
+using namespace fc;
+
+BOOST_AUTO_TEST_SUITE(zlib)
+
+BOOST_AUTO_TEST_CASE(zlib_roundtrip) try {
+   std::vector<char> input;
+   for (size_t i = 0; i < 100'000; ++i)
+      input.push_back(static_cast<char>(i % 251));
+
+   for (int level : {0, 1, 6, 9}) {
+      auto compressed = zlib_compress(input, level);
+      if (level > 0)
+         BOOST_CHECK_LT(compressed.size(), input.size());
+      BOOST_CHECK(zlib_decompress(compressed, input.size()) == input);
+   }
+} FC_LOG_AND_RETHROW();
+
+BOOST_AUTO_TEST_CASE(zlib_decompress_limit) try {
+   std::vector<char> input(100'000, 'a');
+   auto compressed = zlib_compress(input, 9);
+
+   BOOST_CHECK_THROW(zlib_decompress(compressed, input.size() - 1), fc::exception);
+
+   std::vector<char> garbage(100, 'x');
+   BOOST_CHECK_THROW(zlib_decompress(garbage, input.size()), fc::exception);
+} FC_LOG_AND_RETHROW();
+
+BOOST_AUTO_TEST_SUITE_END()
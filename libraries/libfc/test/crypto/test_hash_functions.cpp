@@ -2,6 +2,7 @@
 
 #include <fc/crypto/hex.hpp>
 #include <fc/crypto/sha3.hpp>
+#include <fc/crypto/sha256.hpp>
 #include <fc/utility.hpp>
 
 using namespace fc;
@@ -66,4 +67,28 @@ BOOST_AUTO_TEST_CASE(keccak256) try {
 
 } FC_LOG_AND_RETHROW();
 
+BOOST_AUTO_TEST_CASE(sha256_hash_pairs) try {
+
+   // sizes around the eight pair batches of the multi-buffer kernel
+   for (size_t num_pairs : {0, 1, 7, 8, 9, 16, 23, 100}) {
+      std::vector<fc::sha256> in;
+      for (size_t i = 0; i < 2 * num_pairs; ++i)
+         in.push_back(fc::sha256::hash(std::to_string(i)));
+
+      std::vector<fc::sha256> out(num_pairs);
+      fc::sha256::hash_pairs(in, out);
+
+      for (size_t i = 0; i < num_pairs; ++i) {
+         fc::sha256::encoder e;
+         e.write(in[2 * i].data(), in[2 * i].data_size());
+         e.write(in[2 * i + 1].data(), in[2 * i + 1].data_size());
+         BOOST_CHECK_EQUAL(out[i], e.result());
+      }
+   }
+
+   std::vector<fc::sha256> in(3), out(1);
+   BOOST_CHECK_THROW(fc::sha256::hash_pairs(in, out), fc::assert_exception);
+
+} FC_LOG_AND_RETHROW();
+
 BOOST_AUTO_TEST_SUITE_END()
\ No newline at end of file
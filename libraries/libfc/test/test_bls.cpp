@@ -363,4 +363,40 @@ BOOST_AUTO_TEST_CASE(bls_variant) try {
       BOOST_CHECK_EQUAL(s, "\"" + sig.to_string() + "\"");
 } FC_LOG_AND_RETHROW();
 
+//test batch verification of signatures over two distinct messages, with and without an invalid signature
+BOOST_AUTO_TEST_CASE(bls_verify_batch) try {
+
+  std::vector<bls_private_key> sks;
+  std::vector<bls_public_key> pks;
+  std::vector<bls_signature> sigs;
+  std::vector<std::span<const uint8_t>> messages;
+  for (size_t i = 0; i < 10; ++i) {
+    sks.push_back(bls_private_key::generate());
+    pks.push_back(sks.back().get_public_key());
+    const std::vector<uint8_t>& msg = i % 3 ? message_1 : message_2;
+    sigs.push_back(sks.back().sign(msg));
+    messages.emplace_back(msg);
+  }
+
+  auto to_ptrs = [](const auto& v) {
+    std::vector<const typename std::decay_t<decltype(v)>::value_type*> r;
+    for (const auto& e : v)
+      r.push_back(&e);
+    return r;
+  };
+
+  BOOST_CHECK_EQUAL(verify_batch(to_ptrs(pks), messages, to_ptrs(sigs)), true);
+
+  // signature over the wrong message
+  sigs[4] = sks[4].sign(message_2);
+  BOOST_CHECK_EQUAL(verify_batch(to_ptrs(pks), messages, to_ptrs(sigs)), false);
+
+  // swapped signatures, each valid for the other key
+  sigs[4] = sks[4].sign(message_1);
+  BOOST_CHECK_EQUAL(verify_batch(to_ptrs(pks), messages, to_ptrs(sigs)), true);
+  std::swap(sigs[1], sigs[2]);
+  BOOST_CHECK_EQUAL(verify_batch(to_ptrs(pks), messages, to_ptrs(sigs)), false);
+
+} FC_LOG_AND_RETHROW();
+
 BOOST_AUTO_TEST_SUITE_END()
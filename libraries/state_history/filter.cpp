@@ -0,0 +1,163 @@
+#include <eosio/state_history/filter.hpp>
+#include <eosio/chain/exceptions.hpp>
+
+namespace eosio {
+namespace state_history {
+
+namespace {
+
+bool matches(const chain::name& filter, const chain::name& value) {
+   return filter.empty() || filter == value;
+}
+
+bool matches(const std::vector<trace_filter>& filters, const trace_index_entry& trace) {
+   return std::any_of(trace.actions.begin(), trace.actions.end(), [&](const action_key& a) {
+      return std::any_of(filters.begin(), filters.end(), [&](const trace_filter& f) {
+         return matches(f.receiver, a.receiver) && matches(f.account, a.account) && matches(f.action, a.action);
+      });
+   });
+}
+
+bool matches(const std::vector<delta_filter>& filters, const table_rows_run& run) {
+   return std::any_of(filters.begin(), filters.end(), [&](const delta_filter& f) {
+      return matches(f.code, run.code) && matches(f.scope, run.scope) && matches(f.table, run.table);
+   });
+}
+
+void check_range(std::span<const char> entry, uint64_t offset, uint64_t size) {
+   EOS_ASSERT(offset <= entry.size() && size <= entry.size() - offset, chain::plugin_exception,
+              "filter index range ${o}+${s} is past the end of a log entry of ${n} bytes",
+              ("o", offset)("s", size)("n", entry.size()));
+}
+
+} // namespace
+
+bool is_contract_table(std::string_view table_delta_name) {
+   return table_delta_name.starts_with("contract_");
+}
+
+std::vector<delta_index_entry> index_deltas(std::span<const char> entry) {
+   fc::datastream<const char*> ds(entry.data(), entry.size());
+   fc::unsigned_int num_tables;
+   fc::raw::unpack(ds, num_tables);
+
+   std::vector<delta_index_entry> result(num_tables.value);
+   for (delta_index_entry& table : result) {
+      fc::unsigned_int struct_version;
+      fc::unsigned_int num_rows;
+      fc::raw::unpack(ds, struct_version);
+      fc::raw::unpack(ds, table.name);
+      fc::raw::unpack(ds, num_rows);
+
+      const bool contract_table = is_contract_table(table.name);
+      for (uint32_t i = 0; i < num_rows.value; ++i) {
+         const uint64_t   row_offset = ds.tellp();
+         bool             present;
+         fc::unsigned_int size;
+         fc::raw::unpack(ds, present);
+         fc::raw::unpack(ds, size);
+         EOS_ASSERT(ds.remaining() >= size.value, chain::plugin_exception, "truncated row in ${t} table delta",
+                    ("t", table.name));
+         const char* data = ds.pos();
+         ds.skip(size.value);
+         if (!contract_table)
+            continue;
+
+         // every contract_* row starts with its struct version, code, scope and table
+         fc::datastream<const char*> rs(data, size.value);
+         fc::unsigned_int            row_version;
+         uint64_t                    code, scope, tbl;
+         fc::raw::unpack(rs, row_version);
+         fc::raw::unpack(rs, code);
+         fc::raw::unpack(rs, scope);
+         fc::raw::unpack(rs, tbl);
+
+         const uint64_t row_size = ds.tellp() - row_offset;
+         if (!table.contract_rows.empty()) {
+            table_rows_run& last = table.contract_rows.back();
+            if (last.code.to_uint64_t() == code && last.scope.to_uint64_t() == scope && last.table.to_uint64_t() == tbl) {
+               last.size += row_size;
+               ++last.num_rows;
+               continue;
+            }
+         }
+         table.contract_rows.push_back(table_rows_run{.offset   = row_offset,
+                                                      .size     = row_size,
+                                                      .num_rows = 1,
+                                                      .code     = chain::name{code},
+                                                      .scope    = chain::name{scope},
+                                                      .table    = chain::name{tbl}});
+      }
+   }
+   return result;
+}
+
+std::vector<char> filter_traces(std::span<const char> entry, const std::vector<trace_index_entry>& index,
+                                const std::vector<trace_filter>& filters) {
+   fc::datastream<const char*> ds(entry.data(), entry.size());
+   fc::unsigned_int            num_traces;
+   fc::raw::unpack(ds, num_traces);
+   EOS_ASSERT(num_traces.value == index.size(), chain::plugin_exception,
+              "filter index of ${i} transaction traces does not describe a traces log entry of ${n}",
+              ("i", index.size())("n", num_traces.value));
+
+   std::vector<const trace_index_entry*> selected;
+   for (const trace_index_entry& trace : index) {
+      check_range(entry, trace.offset, trace.size);
+      if (matches(filters, trace))
+         selected.push_back(&trace);
+   }
+
+   fc::datastream<std::vector<char>> out;
+   fc::raw::pack(out, fc::unsigned_int(selected.size()));
+   for (const trace_index_entry* trace : selected)
+      out.write(entry.data() + trace->offset, trace->size);
+   return std::move(out.storage());
+}
+
+std::vector<char> filter_deltas(std::span<const char> entry, const std::vector<delta_index_entry>& index,
+                                const std::vector<delta_filter>& filters) {
+   fc::datastream<const char*> ds(entry.data(), entry.size());
+   fc::unsigned_int            num_tables;
+   fc::raw::unpack(ds, num_tables);
+
+   std::vector<delta_index_entry> entry_index;
+   const std::vector<delta_index_entry>* tables = &index;
+   if (num_tables.value != index.size()) {
+      entry_index = index_deltas(entry);
+      tables      = &entry_index;
+   }
+
+   struct selected_table {
+      const delta_index_entry*           table;
+      std::vector<const table_rows_run*> runs;
+      uint32_t                           num_rows = 0;
+   };
+   std::vector<selected_table> selected;
+   for (const delta_index_entry& table : *tables) {
+      selected_table s{.table = &table};
+      for (const table_rows_run& run : table.contract_rows) {
+         check_range(entry, run.offset, run.size);
+         if (matches(filters, run)) {
+            s.runs.push_back(&run);
+            s.num_rows += run.num_rows;
+         }
+      }
+      if (s.num_rows)
+         selected.push_back(std::move(s));
+   }
+
+   fc::datastream<std::vector<char>> out;
+   fc::raw::pack(out, fc::unsigned_int(selected.size()));
+   for (const selected_table& s : selected) {
+      fc::raw::pack(out, fc::unsigned_int(0)); // table_delta = std::variant<table_delta_v0>
+      fc::raw::pack(out, s.table->name);
+      fc::raw::pack(out, fc::unsigned_int(s.num_rows));
+      for (const table_rows_run* run : s.runs)
+         out.write(entry.data() + run->offset, run->size);
+   }
+   return std::move(out.storage());
+}
+
+} // namespace state_history
+} // namespace eosio
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <eosio/state_history/types.hpp>
+
+#include <span>
+
+namespace eosio::state_history {
+
+/*
+ * Per-block index of the trace and delta log entries, stored in its own log so that the filters of a
+ * get_blocks_request_v2 are applied by copying byte ranges of the entries instead of parsing them.
+ * Offsets are relative to the start of the uncompressed log entry, which may be larger than 4 GiB.
+ */
+
+struct action_key {
+   chain::name receiver;
+   chain::name account;
+   chain::name action;
+
+   std::strong_ordering operator<=>(const action_key&) const = default;
+};
+
+// a transaction_trace of the traces entry and the distinct actions of its action traces, failed_dtrx_trace included
+struct trace_index_entry {
+   uint64_t                offset = 0;
+   uint64_t                size   = 0;
+   std::vector<action_key> actions;
+};
+
+// consecutive rows of a contract_* table_delta which belong to the same table
+struct table_rows_run {
+   uint64_t    offset   = 0;
+   uint64_t    size     = 0;
+   uint32_t    num_rows = 0;
+   chain::name code;
+   chain::name scope;
+   chain::name table;
+};
+
+// a table_delta of the deltas entry; only the rows of the contract_* tables are indexed
+struct delta_index_entry {
+   std::string                 name;
+   std::vector<table_rows_run> contract_rows;
+};
+
+struct block_filter_index {
+   std::vector<trace_index_entry> traces;
+   std::vector<delta_index_entry> deltas;
+};
+
+struct block_filters {
+   std::vector<trace_filter> traces;
+   std::vector<delta_filter> deltas;
+
+   bool empty() const { return traces.empty() && deltas.empty(); }
+};
+
+bool is_contract_table(std::string_view table_delta_name);
+
+/// index of a deltas log entry, as packed by pack_deltas()
+std::vector<delta_index_entry> index_deltas(std::span<const char> entry);
+
+/**
+ * @return the traces entry with only the transaction traces matching one of filters
+ * @throws plugin_exception if index does not describe the entry, the traces can't be filtered without it
+ */
+std::vector<char> filter_traces(std::span<const char> entry, const std::vector<trace_index_entry>& index,
+                                const std::vector<trace_filter>& filters);
+
+/**
+ * @return the deltas entry with only the contract table rows matching one of filters; the entry is indexed by
+ *         index_deltas() if index does not describe it
+ */
+std::vector<char> filter_deltas(std::span<const char> entry, const std::vector<delta_index_entry>& index,
+                                const std::vector<delta_filter>& filters);
+
+} // namespace eosio::state_history
+
+FC_REFLECT(eosio::state_history::action_key, (receiver)(account)(action));
+FC_REFLECT(eosio::state_history::trace_index_entry, (offset)(size)(actions));
+FC_REFLECT(eosio::state_history::table_rows_run, (offset)(size)(num_rows)(code)(scope)(table));
+FC_REFLECT(eosio::state_history::delta_index_entry, (name)(contract_rows));
+FC_REFLECT(eosio::state_history::block_filter_index, (traces)(deltas));
@@ -10,6 +10,7 @@
 #include <fc/log/logger.hpp>
 #include <fc/log/logger_config.hpp> //set_thread_name
 
+#include <boost/iostreams/device/back_inserter.hpp>
 #include <boost/iostreams/device/file.hpp>
 #include <boost/iostreams/device/file_descriptor.hpp>
 #include <boost/iostreams/filter/zlib.hpp>
@@ -38,6 +39,11 @@ namespace bio = boost::iostreams;
  *    state_history_log_header
  *    payload
  *
+ * The payload of an entry was historically a zlib stream (written at zlib::no_compression). Entries written now carry the
+ * ship_feature_stored_entry feature in their magic and store the payload as is, after its uncompressed size: there is
+ * nothing to inflate or checksum when serving it, and any byte range of it can be read directly. Both kinds of entries
+ * may be mixed in one log; convert_log() rewrites the zlib entries of an existing log.
+ *
  * When block pruning is enabled, a slight modification to the format is as followed:
  * For first entry in log, a unique version is used to indicate the log is a "pruned log": this prevents
  *  older versions from trying to read something with holes in it
@@ -59,8 +65,11 @@ inline uint16_t       get_ship_features(uint64_t magic) { return magic>>16; }
 inline bool           is_ship_supported_version(uint64_t magic) { return get_ship_version(magic) == 0; }
 static const uint16_t ship_current_version = 0;
 static const uint16_t ship_feature_pruned_log = 1;
+static const uint16_t ship_feature_stored_entry = 2;
 inline bool           is_ship_log_pruned(uint64_t magic) { return get_ship_features(magic) & ship_feature_pruned_log; }
+inline uint64_t       set_ship_log_pruned_feature(uint64_t magic) { return ship_magic(get_ship_version(magic), get_ship_features(magic) | ship_feature_pruned_log); }
 inline uint64_t       clear_ship_log_pruned_feature(uint64_t magic) { return ship_magic(get_ship_version(magic), get_ship_features(magic) & ~ship_feature_pruned_log); }
+inline bool           is_ship_entry_stored(uint64_t magic) { return get_ship_features(magic) & ship_feature_stored_entry; }
 
 struct log_header {
    uint64_t             magic        = ship_magic(ship_current_version);
@@ -82,6 +91,8 @@ struct ship_log_entry {
    }
 
    bio::filtering_istreambuf get_stream() {
+      if(stored)
+         return bio::filtering_istreambuf(bio::restrict(device, compressed_data_offset, compressed_data_size));
       return bio::filtering_istreambuf(bio::zlib_decompressor() | bio::restrict(device, compressed_data_offset, compressed_data_size));
    }
 
@@ -89,6 +100,7 @@ struct ship_log_entry {
    uint64_t                       compressed_data_offset;
    uint64_t                       compressed_data_size;
    std::optional<uint64_t>        uncompressed_size;
+   bool                           stored = false; //payload is not a zlib stream, compressed and uncompressed sizes are the same
 };
 
 class state_history_log {
@@ -145,7 +157,7 @@ private:
             prune();
 
             //update first header to indicate prune feature is enabled
-            first_header.magic = ship_magic(get_ship_version(first_header.magic), ship_feature_pruned_log);
+            first_header.magic = set_ship_log_pruned_feature(first_header.magic);
             log.pack_to(first_header, 0);
 
             //write trailer on log with num blocks
@@ -207,13 +219,14 @@ private:
          .device                 = log.seekable_device(),
          .compressed_data_offset = log_pos + packed_header_size + (header.compressed_size == 1 ? l4_head_size : prel4_head_size),
          .compressed_data_size   = header.payload_size          - (header.compressed_size == 1 ? l4_head_size : prel4_head_size),
-         .uncompressed_size      =                                (header.compressed_size == 1 ? std::optional<uint64_t>(header.uncompressed_size) : std::nullopt)
+         .uncompressed_size      =                                (header.compressed_size == 1 ? std::optional<uint64_t>(header.uncompressed_size) : std::nullopt),
+         .stored                 = is_ship_entry_stored(header.magic)
       };
    }
 
    template <typename F>
    void pack_and_write_entry(const chain::block_id_type& id, const chain::block_id_type& prev_id, F&& pack_to) {
-      log_header_with_sizes header = {{ship_magic(ship_current_version, 0), id}, 1};
+      log_header_with_sizes header = {{ship_magic(ship_current_version, ship_feature_stored_entry), id}, 1};
       const uint32_t block_num = chain::block_header::num_from_id(header.block_id);
 
       if(!empty()) {
@@ -241,16 +254,16 @@ private:
          if(!empty())  //overwrite the prune trailer that is at the end of the log
             log_insert_pos -= sizeof(uint32_t);
          else          //we're operating on a pruned block log and this is the first entry in the log, make note of the feature in the header
-            header.magic = ship_magic(get_ship_version(header.magic), ship_feature_pruned_log);
+            header.magic = set_ship_log_pruned_feature(header.magic);
       }
 
       const ssize_t payload_insert_pos = log_insert_pos + packed_header_with_sizes_size;
 
-      bio::filtering_ostreambuf buf(detail::counter() | bio::zlib_compressor(bio::zlib::no_compression) | detail::counter() | bio::restrict(log.seekable_device(), payload_insert_pos));
+      bio::filtering_ostreambuf buf(detail::counter() | bio::restrict(log.seekable_device(), payload_insert_pos));
       pack_to(buf);
       bio::close(buf);
       header.uncompressed_size = buf.component<detail::counter>(0)->characters();
-      header.payload_size = buf.component<detail::counter>(2)->characters() + sizeof(header.compressed_size) + sizeof(header.uncompressed_size);
+      header.payload_size = header.uncompressed_size + sizeof(header.compressed_size) + sizeof(header.uncompressed_size);
       log.pack_to(header, log_insert_pos);
 
       fc::random_access_file::write_datastream appender = log.append_ds();
@@ -285,6 +298,45 @@ private:
       return std::nullopt;
    }
 
+   /**
+    * Rewrite the log at src_log_dir_and_stem to dest_log_dir_and_stem, which must not exist, with the payload of every
+    * entry stored as is. Only the available blocks of a pruned log are kept and the result is not pruned.
+    * @return number of entries converted
+    */
+   static uint32_t convert_log(const std::filesystem::path& src_log_dir_and_stem, const std::filesystem::path& dest_log_dir_and_stem) {
+      const std::filesystem::path src_log_path = std::filesystem::path(src_log_dir_and_stem).replace_extension("log");
+      const std::filesystem::path dest_log_path = std::filesystem::path(dest_log_dir_and_stem).replace_extension("log");
+      EOS_ASSERT(std::filesystem::exists(src_log_path), chain::plugin_exception, "${p} does not exist", ("p", src_log_path));
+      EOS_ASSERT(!std::filesystem::exists(dest_log_path), chain::plugin_exception, "${p} already exists", ("p", dest_log_path));
+
+      //opening a pruned log without a prune config would vacuum it; open it as pruned but never prune it any further
+      std::optional<state_history::prune_config> src_prune_config;
+      {
+         fc::random_access_file src_log(src_log_path);
+         if(src_log.size() && is_ship_log_pruned(src_log.unpack_from<log_header>(0).magic))
+            src_prune_config.emplace(state_history::prune_config{.prune_blocks = std::numeric_limits<uint32_t>::max()});
+      }
+
+      state_history_log src(src_log_dir_and_stem, no_non_local_get_block_id_func, src_prune_config);
+      state_history_log dest(dest_log_dir_and_stem);
+
+      const auto [begin, end] = src.block_range();
+      std::vector<char> payload;
+      for(uint32_t block_num = begin; block_num < end; ++block_num) {
+         std::optional<ship_log_entry> entry = src.get_entry(block_num);
+         EOS_ASSERT(entry, chain::plugin_exception, "block ${b} missing from ${p}", ("b", block_num)("p", src_log_path));
+         payload.clear();
+         bio::filtering_istreambuf payload_stream = entry->get_stream();
+         bio::copy(payload_stream, bio::back_inserter(payload));
+
+         const std::optional<chain::block_id_type> prev_id = src.get_block_id(block_num - 1);
+         dest.pack_and_write_entry(*src.get_block_id(block_num), prev_id.value_or(chain::block_id_type{}), [&payload](bio::filtering_ostreambuf& buf) {
+            buf.sputn(payload.data(), payload.size());
+         });
+      }
+      return end - begin;
+   }
+
  private:
    void prune() {
       if(!prune_config)
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <filesystem>
+#include <mutex>
 #include <regex>
 
 #include <boost/multi_index_container.hpp>
@@ -60,6 +61,10 @@ class log_catalog {
 
    size_t global_used_counter = 0;
 
+   //entries may be appended off the main thread while the main thread looks up entries; recursive since a write may look
+   // up the previous block id through non_local_get_block_id, which can come back to this catalog
+   mutable std::recursive_mutex mtx;
+
 public:
    log_catalog(const log_catalog&) = delete;
    log_catalog& operator=(log_catalog&) = delete;
@@ -85,6 +90,7 @@ public:
 
    template <typename F>
    void pack_and_write_entry(const chain::block_id_type& id, const chain::block_id_type& prev_id, F&& pack_to) {
+      std::lock_guard g(mtx);
       const uint32_t block_num = chain::block_header::num_from_id(id);
 
       if(!retained_log_files.empty()) {
@@ -123,18 +129,21 @@ public:
    }
 
    std::optional<ship_log_entry> get_entry(uint32_t block_num) {
+      std::lock_guard g(mtx);
       return call_for_log(block_num, [&](state_history_log&& l) {
          return l.get_entry(block_num);
       });
    }
 
    std::optional<chain::block_id_type> get_block_id(uint32_t block_num) {
+      std::lock_guard g(mtx);
       return call_for_log(block_num, [&](state_history_log&& l) {
          return l.get_block_id(block_num);
       });
    }
 
    std::pair<uint32_t, uint32_t> block_range() const {
+      std::lock_guard g(mtx);
       uint32_t begin = 0;
       uint32_t end = 0;
 
@@ -157,6 +166,7 @@ public:
    }
 
    void clear() {
+      std::lock_guard g(mtx);
       if(empty())
          return;
 
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <eosio/state_history/filter.hpp>
 #include <eosio/state_history/types.hpp>
 #include <boost/iostreams/filtering_streambuf.hpp>
 
@@ -14,6 +15,12 @@ struct trace_converter {
 
    void add_transaction(const transaction_trace_ptr& trace, const chain::packed_transaction_ptr& transaction);
    void pack(boost::iostreams::filtering_ostreambuf& ds, bool trace_debug_mode, const chain::signed_block_ptr& block);
+
+   /// @param index if not null, receives where each transaction trace is in the returned entry and its actions
+   std::vector<char> pack(bool trace_debug_mode, const chain::signed_block_ptr& block, std::vector<trace_index_entry>* index);
+
+private:
+   std::vector<augmented_transaction_trace> take_traces(const chain::signed_block_ptr& block);
 };
 
 } // namespace state_history
@@ -115,6 +115,28 @@ struct get_blocks_request_v1 : get_blocks_request_v0 {
    bool                        fetch_finality_data    = false;
 };
 
+// an empty name matches any value
+struct trace_filter {
+   chain::name                 receiver;
+   chain::name                 account;
+   chain::name                 action;
+};
+
+// an empty name matches any value. Only the contract_* tables are matched.
+struct delta_filter {
+   chain::name                 code;
+   chain::name                 scope;
+   chain::name                 table;
+};
+
+// traces are limited to the transactions with an action trace matching one of trace_filters, deltas to the contract
+// table rows matching one of delta_filters. An empty vector doesn't filter. trace_filters require the filter index,
+// blocks logged without an index entry end the session instead of being sent unfiltered.
+struct get_blocks_request_v2 : get_blocks_request_v1 {
+   std::vector<trace_filter>   trace_filters          = {};
+   std::vector<delta_filter>   delta_filters          = {};
+};
+
 struct get_blocks_ack_request_v0 {
    uint32_t num_messages = 0;
 };
@@ -137,9 +159,9 @@ struct get_blocks_result_v1 : get_blocks_result_v0 {
 };
 
 // remember to add new request & result messages to end so binary numbering remains fixed for clients that don't consume the given current ABI
-using state_request = std::variant<get_status_request_v0, get_blocks_request_v0, get_blocks_ack_request_v0, get_blocks_request_v1, get_status_request_v1>;
+using state_request = std::variant<get_status_request_v0, get_blocks_request_v0, get_blocks_ack_request_v0, get_blocks_request_v1, get_status_request_v1, get_blocks_request_v2>;
 using state_result  = std::variant<get_status_result_v0, get_blocks_result_v0, get_blocks_result_v1, get_status_result_v1>;
-using get_blocks_request = std::variant<get_blocks_request_v0, get_blocks_request_v1>;
+using get_blocks_request = std::variant<get_blocks_request_v0, get_blocks_request_v1, get_blocks_request_v2>;
 using get_blocks_result = std::variant<get_blocks_result_v0, get_blocks_result_v1>;
 
 } // namespace state_history
@@ -154,6 +176,9 @@ FC_REFLECT(eosio::state_history::get_status_result_v0, (head)(last_irreversible)
 FC_REFLECT_DERIVED(eosio::state_history::get_status_result_v1, (eosio::state_history::get_status_result_v0), (finality_data_begin_block)(finality_data_end_block));
 FC_REFLECT(eosio::state_history::get_blocks_request_v0, (start_block_num)(end_block_num)(max_messages_in_flight)(have_positions)(irreversible_only)(fetch_block)(fetch_traces)(fetch_deltas));
 FC_REFLECT_DERIVED(eosio::state_history::get_blocks_request_v1, (eosio::state_history::get_blocks_request_v0), (fetch_finality_data));
+FC_REFLECT(eosio::state_history::trace_filter, (receiver)(account)(action));
+FC_REFLECT(eosio::state_history::delta_filter, (code)(scope)(table));
+FC_REFLECT_DERIVED(eosio::state_history::get_blocks_request_v2, (eosio::state_history::get_blocks_request_v1), (trace_filters)(delta_filters));
 FC_REFLECT(eosio::state_history::get_blocks_ack_request_v0, (num_messages));
 FC_REFLECT(eosio::state_history::get_blocks_result_base, (head)(last_irreversible)(this_block)(prev_block)(block));
 FC_REFLECT_DERIVED(eosio::state_history::get_blocks_result_v0, (eosio::state_history::get_blocks_result_base), (traces)(deltas));
@@ -15,7 +15,7 @@ void trace_converter::add_transaction(const transaction_trace_ptr& trace, const
    }
 }
 
-void trace_converter::pack(boost::iostreams::filtering_ostreambuf& obuf, bool trace_debug_mode, const chain::signed_block_ptr& block) {
+std::vector<augmented_transaction_trace> trace_converter::take_traces(const chain::signed_block_ptr& block) {
    std::vector<augmented_transaction_trace> traces;
    if (onblock_trace)
       traces.push_back(*onblock_trace);
@@ -32,10 +32,42 @@ void trace_converter::pack(boost::iostreams::filtering_ostreambuf& obuf, bool tr
    }
    cached_traces.clear();
    onblock_trace.reset();
+   return traces;
+}
+
+void trace_converter::pack(boost::iostreams::filtering_ostreambuf& obuf, bool trace_debug_mode, const chain::signed_block_ptr& block) {
+   std::vector<augmented_transaction_trace> traces = take_traces(block);
 
    fc::datastream<boost::iostreams::filtering_ostreambuf&> ds{obuf};
    return fc::raw::pack(ds, make_history_context_wrapper(trace_debug_mode, traces));
 }
 
+static void add_actions(std::vector<action_key>& actions, const chain::transaction_trace& trace) {
+   for (const chain::action_trace& at : trace.action_traces)
+      actions.push_back(action_key{at.receiver, at.act.account, at.act.name});
+   if (trace.failed_dtrx_trace)
+      add_actions(actions, *trace.failed_dtrx_trace);
+}
+
+std::vector<char> trace_converter::pack(bool trace_debug_mode, const chain::signed_block_ptr& block,
+                                        std::vector<trace_index_entry>* index) {
+   std::vector<augmented_transaction_trace> traces = take_traces(block);
+
+   // same as packing make_history_context_wrapper(trace_debug_mode, traces), one element at a time
+   fc::datastream<std::vector<char>> ds;
+   fc::raw::pack(ds, fc::unsigned_int(traces.size()));
+   for (const augmented_transaction_trace& trace : traces) {
+      const size_t offset = ds.tellp();
+      ds << make_history_context_wrapper(trace_debug_mode, trace);
+      if (index) {
+         trace_index_entry& e = index->emplace_back(trace_index_entry{.offset = offset, .size = ds.tellp() - offset});
+         add_actions(e.actions, *trace.trace);
+         std::sort(e.actions.begin(), e.actions.end());
+         e.actions.erase(std::unique(e.actions.begin(), e.actions.end()), e.actions.end());
+      }
+   }
+   return std::move(ds.storage());
+}
+
 } // namespace state_history
 } // namespace eosio
@@ -353,6 +353,20 @@ void chain_plugin::set_program_options(options_description& cli, options_descrip
                   EOS_ASSERT(false, plugin_exception, "");
                }
          }), "Number of threads to use for EOS VM OC tier-up")
+         ("eos-vm-oc-compile-burst-threads", bpo::value<uint64_t>()->default_value(eosvmoc::config().burst_threads),
+          "Number of threads to use for EOS VM OC tier-up while not producing blocks, such as at startup and while syncing, when more than "
+          "eos-vm-oc-compile-threads. 0 disables the burst. A producer stops starting burst compiles a few seconds before its production "
+          "slot; compiles already running are not interrupted and may still compete with block production.")
+         ("eos-vm-oc-compile-threshold", bpo::value<uint32_t>()->default_value(eosvmoc::config().compile_threshold),
+          "Number of executions of a contract before it is compiled by EOS VM OC tier-up; eosio.* contracts are compiled on first use. "
+          "When all compile threads are busy, the contracts of the most execution time are compiled first, and the contracts of the least "
+          "execution time are evicted when the code cache fills up.")
+         ("eos-vm-oc-cache-import", bpo::value<std::filesystem::path>(),
+          "Export of an EOS VM OC code cache, created by 'spring-util chain-state export-oc-cache', to load in to the code cache at startup "
+          "(absolute path or relative to application data dir). The most recently used code of the export is loaded until the code cache "
+          "is nearly full; code already in the code cache, and an export of another EOS VM OC version, is skipped.\n"
+          "WARNING: the code of the export is loaded and executed as native machine code. Its sha256 checksums only detect corruption, "
+          "not tampering: only import an export from a trusted source.")
          ("eos-vm-oc-enable", bpo::value<chain::wasm_interface::vm_oc_enable>()->default_value(chain::wasm_interface::vm_oc_enable::oc_auto),
           "Enable EOS VM OC tier-up runtime ('auto', 'all', 'none').\n"
           "'auto' - EOS VM OC tier-up is enabled for eosio.* accounts, read-only trxs, and except on producers applying blocks.\n"
@@ -376,6 +390,9 @@ void chain_plugin::set_program_options(options_description& cli, options_descrip
           "Duration (in seconds) a failed transaction's Finality Status will remain available from being first identified.")
          ("disable-replay-opts", bpo::bool_switch()->default_value(false),
           "disable optimizations that specifically target replay")
+         ("sync-prefetch", bpo::bool_switch()->default_value(false),
+          "While applying fork database blocks during sync, prepare the next block's contracts (EOS VM OC compilation or "
+          "WASM instantiation) and transaction signature recovery on the chain thread pool")
          ("integrity-hash-on-start", bpo::bool_switch(), "Log the state integrity hash on startup")
          ("integrity-hash-on-stop", bpo::bool_switch(), "Log the state integrity hash on shutdown");
 
@@ -941,11 +958,24 @@ void chain_plugin_impl::plugin_initialize(const variables_map& options) {
          chain_config->eosvmoc_config.cache_size = options.at( "eos-vm-oc-cache-size-mb" ).as<uint64_t>() * 1024u * 1024u;
       if( options.count("eos-vm-oc-compile-threads") )
          chain_config->eosvmoc_config.threads = options.at("eos-vm-oc-compile-threads").as<uint64_t>();
+      if( options.count("eos-vm-oc-compile-burst-threads") )
+         chain_config->eosvmoc_config.burst_threads = options.at("eos-vm-oc-compile-burst-threads").as<uint64_t>();
+      if( options.count("eos-vm-oc-compile-threshold") )
+         chain_config->eosvmoc_config.compile_threshold = options.at("eos-vm-oc-compile-threshold").as<uint32_t>();
+      if( options.count("eos-vm-oc-cache-import") ) {
+         auto import_file = options.at("eos-vm-oc-cache-import").as<std::filesystem::path>();
+         if( import_file.is_relative() )
+            import_file = app().data_dir() / import_file;
+         EOS_ASSERT( std::filesystem::exists(import_file), plugin_config_exception,
+                     "EOS VM OC code cache export ${f} does not exist", ("f", import_file) );
+         chain_config->eosvmoc_config.import_file = import_file;
+      }
       chain_config->eosvmoc_tierup = options["eos-vm-oc-enable"].as<chain::wasm_interface::vm_oc_enable>();
 #endif
 
       account_queries_enabled = options.at("enable-account-queries").as<bool>();
 
+      chain_config->sync_prefetch = options.at("sync-prefetch").as<bool>();
       chain_config->integrity_hash_on_start = options.at("integrity-hash-on-start").as<bool>();
       chain_config->integrity_hash_on_stop = options.at("integrity-hash-on-stop").as<bool>();
 
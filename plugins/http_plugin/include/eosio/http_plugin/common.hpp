@@ -170,7 +170,9 @@ inline auto make_http_response_handler(http_plugin_state& plugin_state, detail::
 
                            try {
                               if (response.has_value()) {
-                                 std::string json = (content_type == http_content_type::plaintext) ? response->as_string() : fc::json::to_string(*response, fc::time_point::maximum());
+                                 const bool serialized = content_type == http_content_type::plaintext ||
+                                                         (content_type == http_content_type::json_text && response->is_string());
+                                 std::string json = serialized ? response->as_string() : fc::json::to_string(*response, fc::time_point::maximum());
                                  if (auto error_str = session_ptr->verify_max_bytes_in_flight(json.size()); error_str.empty())
                                     session_ptr->send_response(std::move(json), code);
                                  else
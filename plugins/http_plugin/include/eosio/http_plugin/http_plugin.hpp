@@ -46,7 +46,8 @@ namespace eosio {
 
    enum class http_content_type {
       json = 1,
-      plaintext = 2
+      plaintext = 2,
+      json_text = 3 // json, where a string response is JSON the handler already serialized
    };
 
    struct http_plugin_defaults {
@@ -134,6 +134,12 @@ namespace eosio {
       uint32_t end_block{0};
    };
 
+   // signed_block compressed for transmission, only sent to peers with proto_compressed_block or newer
+   struct compressed_block_message {
+      uint32_t       uncompressed_size{0}; ///< size of the packed signed_block
+      chain::bytes   data;                 ///< zlib compressed packed signed_block
+   };
+
    using net_message = std::variant<handshake_message,
                                     chain_size_message,
                                     go_away_message,
@@ -143,7 +149,8 @@ namespace eosio {
                                     sync_request_message,
                                     signed_block,
                                     packed_transaction,
-                                    vote_message>;
+                                    vote_message,
+                                    compressed_block_message>;
 
 } // namespace eosio
 
@@ -162,6 +169,7 @@ FC_REFLECT( eosio::time_message, (org)(rec)(xmt)(dst) )
 FC_REFLECT( eosio::notice_message, (known_trx)(known_blocks) )
 FC_REFLECT( eosio::request_message, (req_trx)(req_blocks) )
 FC_REFLECT( eosio::sync_request_message, (start_block)(end_block) )
+FC_REFLECT( eosio::compressed_block_message, (uncompressed_size)(data) )
 
 /**
  *
@@ -0,0 +1,288 @@
+#pragma once
+
+#include <eosio/chain/block.hpp>
+#include <eosio/chain/types.hpp>
+
+#include <fc/mutex.hpp>
+#include <fc/time.hpp>
+
+#include <boost/multi_index_container.hpp>
+#include <boost/multi_index/hashed_index.hpp>
+#include <boost/multi_index/mem_fun.hpp>
+#include <boost/multi_index/member.hpp>
+#include <boost/multi_index/ordered_index.hpp>
+
+#include <algorithm>
+#include <deque>
+#include <map>
+#include <optional>
+#include <vector>
+
+namespace eosio {
+
+///
+/// Bookkeeping of striped sync: disjoint block ranges requested from several peers at once, and the blocks that
+/// arrive before the block they build on. Templated on the connection pointer so the logic can be unit tested
+/// without connections; ConnectionPtr must provide connection_id.
+///
+
+/// Blocks received during striped sync before the block they build on. Held until the previous block has been added
+/// to the fork database and then submitted again, so blocks from several peers are applied in order.
+template <typename ConnectionPtr>
+class sync_reorder_buffer {
+public:
+   struct buffered_block {
+      chain::block_id_type    id;
+      chain::signed_block_ptr block;
+      ConnectionPtr           conn;
+      size_t                  size = 0; // packed size of block
+
+      uint32_t block_num() const { return chain::block_header::num_from_id(id); }
+      const chain::block_id_type& prev() const { return block->previous; }
+   };
+
+private:
+   struct by_id;
+   struct by_prev;
+   struct by_block_num;
+   using buffered_block_index = boost::multi_index_container<
+         buffered_block,
+         boost::multi_index::indexed_by<
+               boost::multi_index::hashed_unique<boost::multi_index::tag<by_id>,
+                     boost::multi_index::member<buffered_block, chain::block_id_type, &buffered_block::id>,
+                     std::hash<chain::block_id_type>
+               >,
+               boost::multi_index::hashed_non_unique<boost::multi_index::tag<by_prev>,
+                     boost::multi_index::const_mem_fun<buffered_block, const chain::block_id_type&, &buffered_block::prev>,
+                     std::hash<chain::block_id_type>
+               >,
+               boost::multi_index::ordered_non_unique<boost::multi_index::tag<by_block_num>,
+                     boost::multi_index::const_mem_fun<buffered_block, uint32_t, &buffered_block::block_num>
+               >
+         >
+   >;
+
+   mutable fc::mutex    mtx;
+   buffered_block_index blocks GUARDED_BY(mtx);
+   size_t               buffered_bytes GUARDED_BY(mtx) = 0;
+   size_t               max_bytes = 0; // only set on startup
+
+   void erase_bytes( size_t size ) REQUIRES(mtx) {
+      buffered_bytes -= std::min( buffered_bytes, size );
+   }
+
+public:
+   // not thread safe, only call on startup
+   void set_max_bytes( size_t max ) { max_bytes = max; }
+
+   // thread safe, returns false if adding b would exceed max bytes
+   bool add( const chain::block_id_type& id, const chain::signed_block_ptr& b, const ConnectionPtr& c, size_t size ) {
+      fc::lock_guard g(mtx);
+      if( buffered_bytes + size > max_bytes )
+         return false;
+      if( blocks.insert( {id, b, c, size} ).second ) // does not insert if already there
+         buffered_bytes += size;
+      return true;
+   }
+
+   // thread safe, returns true if id was still buffered
+   bool remove( const chain::block_id_type& id ) {
+      fc::lock_guard g(mtx);
+      auto& index = blocks.template get<by_id>();
+      auto itr = index.find( id );
+      if( itr == index.end() )
+         return false;
+      erase_bytes( itr->size );
+      index.erase( itr );
+      return true;
+   }
+
+   // thread safe, removes and returns a block that builds on prev_id
+   std::optional<buffered_block> pop_next( const chain::block_id_type& prev_id ) {
+      fc::lock_guard g(mtx);
+      auto& index = blocks.template get<by_prev>();
+      auto itr = index.find( prev_id );
+      if( itr == index.end() )
+         return {};
+      buffered_block result = *itr;
+      erase_bytes( itr->size );
+      index.erase( itr );
+      return result;
+   }
+
+   // thread safe, drops blocks at or below lib_num
+   void expire_blocks( uint32_t lib_num ) {
+      fc::lock_guard g(mtx);
+      auto& index = blocks.template get<by_block_num>();
+      auto end = index.upper_bound( lib_num );
+      for( auto itr = index.begin(); itr != end; ++itr )
+         erase_bytes( itr->size );
+      index.erase( index.begin(), end );
+   }
+
+   // thread safe
+   void clear() {
+      fc::lock_guard g(mtx);
+      blocks.clear();
+      buffered_bytes = 0;
+   }
+
+   // thread safe
+   size_t size() const {
+      fc::lock_guard g(mtx);
+      return blocks.size();
+   }
+
+   // thread safe
+   size_t bytes() const {
+      fc::lock_guard g(mtx);
+      return buffered_bytes;
+   }
+};
+
+/// Outstanding ranges of striped sync, at most one per connection. Not thread safe, the sync_manager guards it with
+/// its sync mutex.
+template <typename ConnectionPtr>
+class sync_stripe_tracker {
+public:
+   struct stripe {
+      ConnectionPtr  conn;
+      uint32_t       start = 0;
+      uint32_t       end = 0;           // inclusive
+      uint32_t       last_received = 0; // blocks of a range are sent in order by a peer
+      fc::time_point requested;
+   };
+
+   enum class receive_status {
+      not_requested, // not part of an outstanding range of the connection, e.g. sync was reset
+      pending,       // range has more blocks to receive
+      completed      // last block of the range
+   };
+
+private:
+   std::vector<stripe>                       stripes;    // at most one outstanding per connection
+   std::deque<std::pair<uint32_t, uint32_t>> gaps;       // unreceived parts of abandoned stripes
+   std::map<uint32_t, double>                peer_rates; // connection_id => blocks/sec
+   const uint32_t                            req_span = 0;
+   const uint32_t                            peer_limit = 0;
+
+   auto find( const ConnectionPtr& c ) const {
+      return std::find_if( stripes.begin(), stripes.end(), [&]( const auto& s ) { return s.conn == c; } );
+   }
+   auto find( const ConnectionPtr& c ) {
+      return std::find_if( stripes.begin(), stripes.end(), [&]( const auto& s ) { return s.conn == c; } );
+   }
+
+public:
+   sync_stripe_tracker( uint32_t span, uint32_t peer_limit )
+      : req_span( span ), peer_limit( peer_limit ) {}
+
+   const std::vector<stripe>& outstanding() const { return stripes; }
+   const std::deque<std::pair<uint32_t, uint32_t>>& unassigned_gaps() const { return gaps; }
+
+   bool has_stripe( const ConnectionPtr& c ) const { return find( c ) != stripes.end(); }
+
+   // true if blk_num is part of c's outstanding range and has not been received yet
+   bool in_stripe( const ConnectionPtr& c, uint32_t blk_num ) const {
+      auto itr = find( c );
+      return itr != stripes.end() && blk_num >= std::max( itr->start, itr->last_received + 1 ) && blk_num <= itr->end;
+   }
+
+   // true if another range can be requested. next_num is the first block not yet requested, requests do not get
+   // more than sync_req_span * sync_peer_limit blocks ahead of chain head
+   bool can_request( uint32_t next_num, uint32_t known_lib_num, uint32_t head_num ) const {
+      if( stripes.size() >= peer_limit )
+         return false;
+      if( !gaps.empty() )
+         return true;
+      return next_num <= known_lib_num && next_num <= head_num + req_span * peer_limit;
+   }
+
+   // range size proportional to the peer's measured throughput relative to the average of all measured peers
+   uint32_t span( const ConnectionPtr& c ) const {
+      auto itr = peer_rates.find( c->connection_id );
+      if( itr == peer_rates.end() || peer_rates.size() < 2 )
+         return req_span;
+      double total = 0;
+      for( const auto& [cid, rate] : peer_rates )
+         total += rate;
+      const double share = itr->second / (total / peer_rates.size());
+      return std::clamp( static_cast<uint32_t>( req_span * share ), std::max( req_span / 4, 1u ), req_span * 4 );
+   }
+
+   // assign c its next range, the front of the gaps if any, otherwise the range following next_num which is the first
+   // block not yet requested. Returns {start, end}, end inclusive.
+   std::pair<uint32_t, uint32_t> assign( const ConnectionPtr& c, uint32_t next_num, uint32_t known_lib_num, fc::time_point now ) {
+      const uint32_t s = span( c );
+      uint32_t start = 0, end = 0;
+      if( !gaps.empty() ) {
+         auto& gap = gaps.front();
+         start = gap.first;
+         end = std::min( gap.second, start + s - 1 );
+         if( end == gap.second ) {
+            gaps.pop_front();
+         } else {
+            gap.first = end + 1;
+         }
+      } else {
+         start = next_num;
+         end = std::min( start + s - 1, known_lib_num );
+      }
+      stripes.push_back( {c, start, end, 0, now} );
+      return {start, end};
+   }
+
+   // record blk_num received from c, a completed range updates the peer's measured throughput
+   receive_status received( const ConnectionPtr& c, uint32_t blk_num, fc::time_point now ) {
+      auto itr = find( c );
+      if( itr == stripes.end() || blk_num < itr->start || blk_num > itr->end )
+         return receive_status::not_requested;
+      itr->last_received = blk_num;
+      if( blk_num != itr->end )
+         return receive_status::pending;
+
+      const double secs = std::max( (now - itr->requested).count() / 1'000'000.0, 0.001 );
+      const double rate = (itr->end - itr->start + 1) / secs;
+      auto [rate_itr, inserted] = peer_rates.emplace( c->connection_id, rate );
+      if( !inserted )
+         rate_itr->second = (rate_itr->second + rate) / 2;
+      stripes.erase( itr );
+      return receive_status::completed;
+   }
+
+   // returns true if c had an outstanding range, the unreceived part of it is assigned to the next peer
+   bool release( const ConnectionPtr& c ) {
+      auto itr = find( c );
+      if( itr == stripes.end() )
+         return false;
+      const uint32_t start = std::max( itr->start, itr->last_received + 1 );
+      if( start <= itr->end )
+         gaps.emplace_front( start, itr->end );
+      stripes.erase( itr );
+      return true;
+   }
+
+   // c is closing, its throughput is measured again if it reconnects
+   void erase_rate( const ConnectionPtr& c ) { peer_rates.erase( c->connection_id ); }
+
+   // blocks arrive out of order, next expected is the lowest block not yet received. last_requested_num is the end of
+   // the highest range requested.
+   uint32_t next_expected( uint32_t last_requested_num ) const {
+      uint32_t next = last_requested_num + 1;
+      for( const auto& s : stripes )
+         next = std::min( next, std::max( s.start, s.last_received + 1 ) );
+      for( const auto& gap : gaps )
+         next = std::min( next, gap.first );
+      return next;
+   }
+
+   // measured peer rates are kept, they remain valid for a later sync
+   void clear() {
+      stripes.clear();
+      gaps.clear();
+   }
+
+   void clear_gaps() { gaps.clear(); }
+};
+
+} // namespace eosio
@@ -2,6 +2,7 @@
 #include <eosio/net_plugin/protocol.hpp>
 #include <eosio/net_plugin/net_utils.hpp>
 #include <eosio/net_plugin/auto_bp_peering.hpp>
+#include <eosio/net_plugin/sync_stripes.hpp>
 #include <eosio/chain/types.hpp>
 #include <eosio/chain/controller.hpp>
 #include <eosio/chain/exceptions.hpp>
@@ -11,6 +12,7 @@
 #include <eosio/producer_plugin/producer_plugin.hpp>
 
 #include <fc/bitutil.hpp>
+#include <fc/compress/zlib.hpp>
 #include <fc/network/message_buffer.hpp>
 #include <fc/io/json.hpp>
 #include <fc/io/raw.hpp>
@@ -25,6 +27,8 @@
 #include <boost/asio/ip/host_name.hpp>
 #include <boost/asio/steady_timer.hpp>
 #include <boost/multi_index/key.hpp>
+#include <boost/multi_index/hashed_index.hpp>
+#include <boost/multi_index/sequenced_index.hpp>
 
 #include <atomic>
 #include <cmath>
@@ -211,6 +215,70 @@ namespace eosio {
       }
    };
 
+   // Framed signed_block net messages recently sent to syncing peers. Peers syncing from us usually request the
+   // same ranges, so keep the packed message around instead of reading and packing the block again for each peer.
+   // Keyed by block id so a fork switch can never serve a stale block, compressed and uncompressed messages of the
+   // same block are cached separately. Bounded by total bytes, least recently used entries are evicted first.
+   class sync_block_buffer_cache {
+   private:
+      struct served_block {
+         block_id_type    id;
+         bool             compressed = false;
+         send_buffer_type buffer;
+      };
+      struct by_id;
+      using served_block_index = multi_index_container<
+            served_block,
+            indexed_by<
+                  sequenced<>,
+                  hashed_unique<tag<by_id>,
+                        composite_key<served_block,
+                              member<served_block, block_id_type, &served_block::id>,
+                              member<served_block, bool, &served_block::compressed>
+                        >,
+                        composite_key_hash<std::hash<block_id_type>, std::hash<bool>>
+                  >
+            >
+      >;
+
+      alignas(hardware_destructive_interference_size)
+      mutable fc::mutex  mtx;
+      served_block_index blocks GUARDED_BY(mtx);
+      size_t             cached_bytes GUARDED_BY(mtx) = 0;
+      size_t             max_bytes = 0; // only set on startup, 0 disables the cache
+
+   public:
+      // not thread safe, only call on startup
+      void set_max_bytes( size_t max ) { max_bytes = max; }
+
+      // thread safe
+      send_buffer_type get( const block_id_type& id, bool compressed ) {
+         if( max_bytes == 0 )
+            return {};
+         fc::lock_guard g(mtx);
+         auto& idx = blocks.get<by_id>();
+         auto itr = idx.find( std::make_tuple( id, compressed ) );
+         if( itr == idx.end() )
+            return {};
+         blocks.relocate( blocks.begin(), blocks.project<0>( itr ) );
+         return itr->buffer;
+      }
+
+      // thread safe
+      void add( const block_id_type& id, bool compressed, const send_buffer_type& buffer ) {
+         if( max_bytes == 0 || buffer->size() > max_bytes )
+            return;
+         fc::lock_guard g(mtx);
+         if( !blocks.push_front( {id, compressed, buffer} ).second )
+            return;
+         cached_bytes += buffer->size();
+         while( cached_bytes > max_bytes ) {
+            cached_bytes -= blocks.back().buffer->size();
+            blocks.pop_back();
+         }
+      }
+   };
+
    class sync_manager {
    private:
       enum stages {
@@ -226,8 +294,13 @@ namespace eosio {
       uint32_t       sync_next_expected_num  GUARDED_BY(sync_mtx) {0};  // the next block number we need from peer
       connection_ptr sync_source             GUARDED_BY(sync_mtx);      // connection we are currently syncing from
 
+      // striped sync, disjoint ranges requested from several peers at once
+      sync_stripe_tracker<connection_ptr>       sync_stripes GUARDED_BY(sync_mtx);
+      sync_reorder_buffer<connection_ptr>       reorder_buffer;
+
       const uint32_t sync_req_span {0};
       const uint32_t sync_peer_limit {0};
+      const bool     sync_striped {false};
 
       alignas(hardware_destructive_interference_size)
       std::atomic<stages> sync_state{in_sync};
@@ -247,7 +320,14 @@ namespace eosio {
       bool set_state( stages newstate );
       bool is_sync_required( uint32_t fork_head_block_num ); // call with locked mutex
       void request_next_chunk( const connection_ptr& conn = connection_ptr() ) REQUIRES(sync_mtx);
+      deque<connection_ptr> find_sync_nodes(); // call with locked mutex
       connection_ptr find_next_sync_node(); // call with locked mutex
+      void request_stripes( const connection_ptr& conn = connection_ptr() ) REQUIRES(sync_mtx);
+      bool can_request_stripe( uint32_t head_num ) const REQUIRES(sync_mtx);
+      void stripe_received( const connection_ptr& c, uint32_t blk_num ) REQUIRES(sync_mtx);
+      bool release_stripe( const connection_ptr& c ) REQUIRES(sync_mtx);
+      void update_next_expected() REQUIRES(sync_mtx);
+      void reset_stripes() REQUIRES(sync_mtx);
       void start_sync( const connection_ptr& c, uint32_t target ); // locks mutex
       bool verify_catchup( const connection_ptr& c, uint32_t num, const block_id_type& id ); // locks mutex
 
@@ -256,7 +336,8 @@ namespace eosio {
          immediately,  // closing connection immediately
          handshake     // sending handshake message
       };
-      explicit sync_manager( uint32_t span, uint32_t sync_peer_limit, uint32_t min_blocks_distance );
+      sync_manager( uint32_t span, uint32_t sync_peer_limit, uint32_t min_blocks_distance, bool striped,
+                    size_t reorder_buffer_bytes );
       static void send_handshakes();
       bool syncing_from_peer() const { return sync_state == lib_catchup; }
       bool is_in_sync() const { return sync_state == in_sync; }
@@ -268,6 +349,12 @@ namespace eosio {
       void recv_handshake( const connection_ptr& c, const handshake_message& msg, uint32_t nblk_combined_latency );
       void sync_recv_notice( const connection_ptr& c, const notice_message& msg );
       void send_handshakes_if_synced(const fc::microseconds& blk_latency);
+
+      // thread safe, returns true if b is held until its previous block is available
+      bool buffer_out_of_order_block( const block_id_type& id, const signed_block_ptr& b, const connection_ptr& c );
+      // thread safe, submit buffered blocks that build on prev_id
+      void submit_buffered_blocks( const block_id_type& prev_id );
+      void expire_buffered_blocks( uint32_t lib_num ) { reorder_buffer.expire_blocks( lib_num ); }
    };
 
    class dispatch_manager {
@@ -336,6 +423,10 @@ namespace eosio {
    constexpr auto     def_txn_expire_wait = std::chrono::seconds(3);
    constexpr auto     def_resp_expected_wait = std::chrono::seconds(5);
    constexpr auto     def_sync_fetch_span = 1000;
+   constexpr auto     def_sync_block_cache_size_mb = 128;
+   constexpr auto     def_sync_reorder_buffer_size_mb = 256;
+   constexpr auto     def_sync_compression_level = 0; // disabled
+   constexpr auto     max_uncompressed_block_size = def_send_buffer_size*2; // same as maximum message size
    constexpr auto     def_keepalive_interval = 10000;
 
    constexpr auto     message_header_size = sizeof(uint32_t);
@@ -343,6 +434,7 @@ namespace eosio {
    constexpr uint32_t signed_block_which           = fc::get_index<net_message, signed_block>();         // see protocol net_message
    constexpr uint32_t packed_transaction_which     = fc::get_index<net_message, packed_transaction>();   // see protocol net_message
    constexpr uint32_t vote_message_which           = fc::get_index<net_message, vote_message>();         // see protocol net_message
+   constexpr uint32_t compressed_block_which       = fc::get_index<net_message, compressed_block_message>(); // see protocol net_message
 
    class connections_manager {
    public:
@@ -454,6 +546,7 @@ namespace eosio {
       unique_ptr< sync_manager >       sync_master;
       dispatch_manager                 dispatcher {thread_pool.get_executor()};
       connections_manager              connections;
+      sync_block_buffer_cache          sync_block_buffers;
 
       /**
        * Thread safe, only updated in plugin initialize
@@ -461,6 +554,7 @@ namespace eosio {
        */
       vector<string>                        p2p_addresses;
       vector<string>                        p2p_server_addresses;
+      int                                   sync_compression_level = def_sync_compression_level; ///< 0 disables
       const string&                         get_first_p2p_address() const;
 
       vector<chain::public_key_type>        allowed_peers; ///< peer keys allowed to connect
@@ -675,9 +769,10 @@ namespace eosio {
    constexpr uint16_t proto_leap_initial = 7;              // leap client, needed because none of the 2.1 versions are supported
    constexpr uint16_t proto_block_range = 8;               // include block range in notice_message
    constexpr uint16_t proto_instant_finality = 9;          // instant finality
+   constexpr uint16_t proto_compressed_block = 10;         // supports compressed_block_message
 #pragma GCC diagnostic pop
 
-   constexpr uint16_t net_version_max = proto_instant_finality;
+   constexpr uint16_t net_version_max = proto_compressed_block;
 
    /**
     * Index by start_block_num
@@ -1011,6 +1106,9 @@ namespace eosio {
       void _close( bool reconnect, bool shutdown ); // for easy capture
 
       bool process_next_block_message(uint32_t message_length);
+      bool process_next_compressed_block_message(uint32_t message_length);
+      template <typename BlockSource>
+      bool process_block_message(BlockSource& source, uint32_t message_length);
       bool process_next_trx_message(uint32_t message_length);
       bool process_next_vote_message(uint32_t message_length);
       void update_endpoints(const tcp::endpoint& endpoint = tcp::endpoint());
@@ -1067,6 +1165,7 @@ namespace eosio {
 
       void enqueue( const net_message &msg );
       size_t enqueue_block( const signed_block_ptr& sb, bool to_sync_queue = false);
+      size_t enqueue_block_buffer( const send_buffer_type& sb, bool to_sync_queue = false);
       void enqueue_buffer( const std::shared_ptr<std::vector<char>>& send_buffer,
                            go_away_reason close_after_send,
                            bool to_sync_queue = false);
@@ -1750,60 +1849,6 @@ namespace eosio {
       }
    }
 
-   // called from connection strand
-   bool connection::enqueue_sync_block() {
-      if( !peer_requested ) {
-         return false;
-      } else {
-         peer_dlog( this, "enqueue sync block ${num}", ("num", peer_requested->last + 1) );
-      }
-      uint32_t num = peer_requested->last + 1;
-
-      controller& cc = my_impl->chain_plug->chain();
-      signed_block_ptr sb;
-      try {
-         sb = cc.fetch_block_by_number( num ); // thread-safe
-      } FC_LOG_AND_DROP();
-      if( sb ) {
-         // Skip transmitting block this loop if threshold exceeded
-         if (block_sync_send_start == 0ns) { // start of enqueue blocks
-            block_sync_send_start = get_time();
-            block_sync_frame_bytes_sent = 0;
-         }
-         if( block_sync_rate_limit > 0 && block_sync_frame_bytes_sent > 0 && peer_syncing_from_us ) {
-            auto now = get_time();
-            auto elapsed_us = std::chrono::duration_cast<std::chrono::microseconds>(now - block_sync_send_start);
-            double current_rate_sec = (double(block_sync_frame_bytes_sent) / elapsed_us.count()) * 100000; // convert from bytes/us => bytes/sec
-            peer_dlog(this, "start enqueue block time ${st}, now ${t}, elapsed ${e}, rate ${r}, limit ${l}",
-                      ("st", block_sync_send_start.count())("t", now.count())("e", elapsed_us.count())("r", current_rate_sec)("l", block_sync_rate_limit));
-            if( current_rate_sec >= block_sync_rate_limit ) {
-               block_sync_throttling = true;
-               peer_dlog( this, "throttling block sync to peer ${host}:${port}", ("host", log_remote_endpoint_ip)("port", log_remote_endpoint_port));
-               return false;
-            }
-         }
-         block_sync_throttling = false;
-         auto sent = enqueue_block( sb, true );
-         block_sync_total_bytes_sent += sent;
-         block_sync_frame_bytes_sent += sent;
-         ++peer_requested->last;
-         if(num == peer_requested->end_block) {
-            peer_requested.reset();
-            block_sync_send_start = 0ns;
-            block_sync_frame_bytes_sent = 0;
-            peer_dlog( this, "completing enqueue_sync_block ${num}", ("num", num) );
-         }
-      } else {
-         peer_ilog( this, "enqueue sync, unable to fetch block ${num}, sending benign_other go away", ("num", num) );
-         peer_requested.reset(); // unable to provide requested blocks
-         block_sync_send_start = 0ns;
-         block_sync_frame_bytes_sent = 0;
-         no_retry = benign_other;
-         enqueue( go_away_message( benign_other ) );
-      }
-      return true;
-   }
-
    //------------------------------------------------------------------------
 
    struct buffer_factory {
@@ -1852,6 +1897,23 @@ namespace eosio {
          return send_buffer;
       }
 
+      /// frame an already packed message payload, avoids unpack/repack of data read from disk
+      static send_buffer_type create_send_buffer_from_packed( uint32_t which, const bytes& packed ) {
+         const uint32_t which_size = fc::raw::pack_size( unsigned_int( which ) );
+         const uint32_t payload_size = which_size + packed.size();
+
+         const char* const header = reinterpret_cast<const char* const>(&payload_size); // avoid variable size encoding of uint32_t
+         const size_t buffer_size = message_header_size + payload_size;
+
+         auto send_buffer = std::make_shared<vector<char>>( buffer_size );
+         fc::datastream<char*> ds( send_buffer->data(), buffer_size );
+         ds.write( header, message_header_size );
+         fc::raw::pack( ds, unsigned_int( which ) );
+         ds.write( packed.data(), packed.size() );
+
+         return send_buffer;
+      }
+
    };
 
    struct block_buffer_factory : public buffer_factory {
@@ -1864,6 +1926,14 @@ namespace eosio {
          return send_buffer;
       }
 
+      /// caches result for subsequent calls, only provide same packed signed_block for each invocation.
+      const send_buffer_type& get_send_buffer( const bytes& packed_block ) {
+         if( !send_buffer ) {
+            send_buffer = buffer_factory::create_send_buffer_from_packed( signed_block_which, packed_block );
+         }
+         return send_buffer;
+      }
+
    private:
 
       static std::shared_ptr<std::vector<char>> create_send_buffer( const signed_block_ptr& sb ) {
@@ -1875,6 +1945,25 @@ namespace eosio {
       }
    };
 
+   struct compressed_block_buffer_factory : public buffer_factory {
+
+      /// caches result for subsequent calls, only provide same packed signed_block for each invocation.
+      const send_buffer_type& get_send_buffer( const bytes& packed_block, int level ) {
+         if( !send_buffer ) {
+            send_buffer = create_send_buffer( packed_block, level );
+         }
+         return send_buffer;
+      }
+
+   private:
+
+      static std::shared_ptr<std::vector<char>> create_send_buffer( const bytes& packed_block, int level ) {
+         compressed_block_message msg{ static_cast<uint32_t>(packed_block.size()), fc::zlib_compress( packed_block, level ) };
+         fc_dlog( logger, "sending compressed block, ${s} of ${u} bytes", ("s", msg.data.size())("u", msg.uncompressed_size) );
+         return buffer_factory::create_send_buffer( compressed_block_which, msg );
+      }
+   };
+
    struct trx_buffer_factory : public buffer_factory {
 
       /// caches result for subsequent calls, only provide same packed_transaction_ptr instance for each invocation.
@@ -1897,6 +1986,81 @@ namespace eosio {
 
    //------------------------------------------------------------------------
 
+   // called from connection strand
+   bool connection::enqueue_sync_block() {
+      if( !peer_requested ) {
+         return false;
+      } else {
+         peer_dlog( this, "enqueue sync block ${num}", ("num", peer_requested->last + 1) );
+      }
+      uint32_t num = peer_requested->last + 1;
+
+      controller& cc = my_impl->chain_plug->chain();
+      const bool compress = my_impl->sync_compression_level > 0 && protocol_version >= proto_compressed_block;
+      send_buffer_type sb;
+      try {
+         try {
+            sb = my_impl->sync_block_buffers.get( cc.get_block_id_for_num( num ), compress ); // thread-safe
+         } catch( const unknown_block_exception& ) {} // reported below when fetch fails
+         if( !sb ) {
+            // irreversible blocks are framed directly from the block log bytes without unpacking the block
+            const bytes packed_block = cc.fetch_serialized_block_by_number( num ); // thread-safe
+            if( !packed_block.empty() ) {
+               if( compress ) {
+                  compressed_block_buffer_factory buff_factory;
+                  sb = buff_factory.get_send_buffer( packed_block, my_impl->sync_compression_level );
+               } else {
+                  block_buffer_factory buff_factory;
+                  sb = buff_factory.get_send_buffer( packed_block );
+               }
+               // key by the id of the block actually fetched, head may have switched forks since the lookup
+               fc::datastream<const char*> ds( packed_block.data(), packed_block.size() );
+               block_header bh;
+               fc::raw::unpack( ds, bh );
+               my_impl->sync_block_buffers.add( bh.calculate_id(), compress, sb );
+            }
+         }
+      } FC_LOG_AND_DROP();
+      if( sb ) {
+         // Skip transmitting block this loop if threshold exceeded
+         if (block_sync_send_start == 0ns) { // start of enqueue blocks
+            block_sync_send_start = get_time();
+            block_sync_frame_bytes_sent = 0;
+         }
+         if( block_sync_rate_limit > 0 && block_sync_frame_bytes_sent > 0 && peer_syncing_from_us ) {
+            auto now = get_time();
+            auto elapsed_us = std::chrono::duration_cast<std::chrono::microseconds>(now - block_sync_send_start);
+            double current_rate_sec = (double(block_sync_frame_bytes_sent) / elapsed_us.count()) * 100000; // convert from bytes/us => bytes/sec
+            peer_dlog(this, "start enqueue block time ${st}, now ${t}, elapsed ${e}, rate ${r}, limit ${l}",
+                      ("st", block_sync_send_start.count())("t", now.count())("e", elapsed_us.count())("r", current_rate_sec)("l", block_sync_rate_limit));
+            if( current_rate_sec >= block_sync_rate_limit ) {
+               block_sync_throttling = true;
+               peer_dlog( this, "throttling block sync to peer ${host}:${port}", ("host", log_remote_endpoint_ip)("port", log_remote_endpoint_port));
+               return false;
+            }
+         }
+         block_sync_throttling = false;
+         auto sent = enqueue_block_buffer( sb, true );
+         block_sync_total_bytes_sent += sent;
+         block_sync_frame_bytes_sent += sent;
+         ++peer_requested->last;
+         if(num == peer_requested->end_block) {
+            peer_requested.reset();
+            block_sync_send_start = 0ns;
+            block_sync_frame_bytes_sent = 0;
+            peer_dlog( this, "completing enqueue_sync_block ${num}", ("num", num) );
+         }
+      } else {
+         peer_ilog( this, "enqueue sync, unable to fetch block ${num}, sending benign_other go away", ("num", num) );
+         peer_requested.reset(); // unable to provide requested blocks
+         block_sync_send_start = 0ns;
+         block_sync_frame_bytes_sent = 0;
+         no_retry = benign_other;
+         enqueue( go_away_message( benign_other ) );
+      }
+      return true;
+   }
+
    // called from connection strand
    void connection::enqueue( const net_message& m ) {
       verify_strand_in_this_thread( strand, __func__, __LINE__ );
@@ -1916,7 +2080,13 @@ namespace eosio {
       verify_strand_in_this_thread( strand, __func__, __LINE__ );
 
       block_buffer_factory buff_factory;
-      const auto& sb = buff_factory.get_send_buffer( b );
+      return enqueue_block_buffer( buff_factory.get_send_buffer( b ), to_sync_queue );
+   }
+
+   // called from connection strand
+   size_t connection::enqueue_block_buffer( const send_buffer_type& sb, bool to_sync_queue) {
+      verify_strand_in_this_thread( strand, __func__, __LINE__ );
+
       latest_blk_time = std::chrono::system_clock::now();
       enqueue_buffer( sb, no_reason, to_sync_queue);
       return sb->size();
@@ -2023,16 +2193,20 @@ namespace eosio {
    }
    //-----------------------------------------------------------
 
-    sync_manager::sync_manager( uint32_t span, uint32_t sync_peer_limit, uint32_t min_blocks_distance )
+    sync_manager::sync_manager( uint32_t span, uint32_t sync_peer_limit, uint32_t min_blocks_distance, bool striped,
+                                size_t reorder_buffer_bytes )
       :sync_known_lib_num( 0 )
       ,sync_last_requested_num( 0 )
       ,sync_next_expected_num( 1 )
       ,sync_source()
+      ,sync_stripes( span, sync_peer_limit )
       ,sync_req_span( span )
       ,sync_peer_limit( sync_peer_limit )
+      ,sync_striped( striped )
       ,sync_state(in_sync)
       ,min_blocks_distance(min_blocks_distance)
    {
+      reorder_buffer.set_max_bytes( reorder_buffer_bytes );
    }
 
    constexpr auto sync_manager::stage_str(stages s) {
@@ -2058,6 +2232,7 @@ namespace eosio {
       fc::unique_lock g( sync_mtx );
       if( sync_state == in_sync ) {
          sync_source.reset();
+         reset_stripes();
       }
       if( !c ) return;
       if( !closing ) {
@@ -2076,6 +2251,13 @@ namespace eosio {
          } );
          sync_known_lib_num = highest_lib_num;
 
+         if( sync_striped ) {
+            sync_stripes.erase_rate( c );
+            if( release_stripe( c ) )
+               request_stripes();
+            return;
+         }
+
          // if closing the connection we are currently syncing from then request from a diff peer
          if( c == sync_source ) {
             sync_last_requested_num = 0;
@@ -2087,7 +2269,8 @@ namespace eosio {
       }
    }
 
-   connection_ptr sync_manager::find_next_sync_node() REQUIRES(sync_mtx) {
+   // returns up to sync_peer_limit peers able to provide blocks, lowest latency first
+   deque<connection_ptr> sync_manager::find_sync_nodes() REQUIRES(sync_mtx) {
       fc_dlog(logger, "Number connections ${s}, sync_next_expected_num: ${e}, sync_known_lib_num: ${l}",
               ("s", my_impl->connections.number_connections())("e", sync_next_expected_num)("l", sync_known_lib_num));
       deque<connection_ptr> conns;
@@ -2104,6 +2287,11 @@ namespace eosio {
          });
          conns.resize(sync_peer_limit);
       }
+      return conns;
+   }
+
+   connection_ptr sync_manager::find_next_sync_node() REQUIRES(sync_mtx) {
+      deque<connection_ptr> conns = find_sync_nodes();
 
       fc_dlog(logger, "Valid sync peers ${s}, sync_ordinal ${so}", ("s", conns.size())("so", sync_ordinal.load()));
 
@@ -2138,6 +2326,11 @@ namespace eosio {
 
    // call with g_sync locked, called from conn's connection strand
    void sync_manager::request_next_chunk( const connection_ptr& conn ) REQUIRES(sync_mtx) {
+      if( sync_striped ) {
+         request_stripes( conn );
+         return;
+      }
+
       auto chain_info = my_impl->get_chain_info();
 
       fc_dlog( logger, "sync_last_requested_num: ${r}, sync_next_expected_num: ${e}, sync_known_lib_num: ${k}, sync_req_span: ${s}, fhead: ${h}, lib: ${lib}",
@@ -2192,6 +2385,122 @@ namespace eosio {
       }
    }
 
+   // call with g_sync locked
+   bool sync_manager::can_request_stripe( uint32_t head_num ) const REQUIRES(sync_mtx) {
+      // do not get too far ahead of chain head, blocks that can not be linked yet are held in the reorder buffer
+      return sync_stripes.can_request( std::max( sync_last_requested_num + 1, sync_next_expected_num ), sync_known_lib_num, head_num );
+   }
+
+   // call with g_sync locked, called from conn's connection strand
+   // request disjoint ranges from up to sync_peer_limit peers, at most one outstanding range per peer
+   void sync_manager::request_stripes( const connection_ptr& conn ) REQUIRES(sync_mtx) {
+      auto chain_info = my_impl->get_chain_info();
+
+      fc_dlog( logger, "stripes: ${n}, gaps: ${g}, sync_last_requested_num: ${r}, sync_next_expected_num: ${e}, sync_known_lib_num: ${k}, head: ${h}, lib: ${lib}",
+               ("n", sync_stripes.outstanding().size())("g", sync_stripes.unassigned_gaps().size())("r", sync_last_requested_num)
+               ("e", sync_next_expected_num)("k", sync_known_lib_num)("h", chain_info.head_num)("lib", chain_info.lib_num) );
+
+      deque<connection_ptr> conns = find_sync_nodes();
+      if( conn && conn->current() && std::find( conns.begin(), conns.end(), conn ) == conns.end() )
+         conns.push_front( conn );
+
+      for( const connection_ptr& c : conns ) {
+         if( !can_request_stripe( chain_info.head_num ) )
+            break;
+         if( sync_stripes.has_stripe( c ) )
+            continue;
+
+         const uint32_t next_num = std::max( sync_last_requested_num + 1, sync_next_expected_num );
+         auto [start, end] = sync_stripes.assign( c, next_num, sync_known_lib_num, fc::time_point::now() );
+         sync_last_requested_num = std::max( sync_last_requested_num, end );
+
+         c->strand.post( [c, start, end, head=chain_info.head_num, lib=chain_info.lib_num]() {
+            peer_ilog( c, "requesting striped range ${s} to ${e}, head ${h}, lib ${lib}", ("s", start)("e", end)("h", head)("lib", lib) );
+            c->request_sync_blocks( start, end );
+         } );
+      }
+
+      if( sync_stripes.outstanding().empty() ) {
+         if( conns.empty() ) {
+            fc_wlog( logger, "Unable to continue syncing at this time" );
+            sync_known_lib_num = chain_info.lib_num;
+         } else {
+            fc_wlog( logger, "Unable to request range, sending handshakes to everyone" );
+         }
+         sync_last_requested_num = 0;
+         sync_stripes.clear_gaps();
+         set_state( in_sync ); // need to be out of lib_catchup so start_sync will work
+         send_handshakes();
+      }
+   }
+
+   // call with g_sync locked, called from c's connection strand
+   void sync_manager::stripe_received( const connection_ptr& c, uint32_t blk_num ) REQUIRES(sync_mtx) {
+      auto status = sync_stripes.received( c, blk_num, fc::time_point::now() );
+      if( status == sync_stripe_tracker<connection_ptr>::receive_status::not_requested )
+         return; // not part of an outstanding range, e.g. sync was reset
+      update_next_expected();
+      if( status == sync_stripe_tracker<connection_ptr>::receive_status::completed ) {
+         peer_dlog( c, "completed striped range ending at ${e}, next range ${s} blocks", ("e", blk_num)("s", sync_stripes.span( c )) );
+         request_stripes();
+      }
+   }
+
+   // call with g_sync locked, returns true if c had an outstanding range
+   // the unreceived part of c's range is requested again from another peer
+   bool sync_manager::release_stripe( const connection_ptr& c ) REQUIRES(sync_mtx) {
+      if( !sync_stripes.release( c ) )
+         return false;
+      update_next_expected();
+      return true;
+   }
+
+   // call with g_sync locked
+   // with striped sync blocks arrive out of order, next expected is the lowest block not yet received
+   void sync_manager::update_next_expected() REQUIRES(sync_mtx) {
+      if( sync_last_requested_num == 0 ) // reset, next expected already set
+         return;
+      sync_next_expected_num = sync_stripes.next_expected( sync_last_requested_num );
+   }
+
+   // call with g_sync locked
+   void sync_manager::reset_stripes() REQUIRES(sync_mtx) {
+      if( !sync_striped )
+         return;
+      sync_stripes.clear();
+      reorder_buffer.clear();
+   }
+
+   // thread safe
+   bool sync_manager::buffer_out_of_order_block( const block_id_type& id, const signed_block_ptr& b, const connection_ptr& c ) {
+      if( !sync_striped || sync_state != lib_catchup )
+         return false;
+      {
+         // only blocks c was asked for, a block outside of its outstanding range is handled as any unlinkable block
+         fc::lock_guard g_sync( sync_mtx );
+         if( !sync_stripes.in_stripe( c, b->block_num() ) )
+            return false;
+      }
+      if( !reorder_buffer.add( id, b, c, fc::raw::pack_size( *b ) ) )
+         return false;
+      // previous may have been added to the fork database before b was buffered, in which case submit_buffered_blocks
+      // has either already been called for it or b needs to be processed now
+      if( my_impl->chain_plug->chain().block_exists( b->previous ) ) { // thread-safe
+         return !reorder_buffer.remove( id );
+      }
+      return true;
+   }
+
+   // thread safe
+   void sync_manager::submit_buffered_blocks( const block_id_type& prev_id ) {
+      if( !sync_striped )
+         return;
+      while( auto bb = reorder_buffer.pop_next( prev_id ) ) {
+         fc_dlog( logger, "submitting buffered sync block ${n} ${id}...", ("n", bb->block_num())("id", bb->id.str().substr(8,16)) );
+         bb->conn->handle_message( bb->id, std::move(bb->block) );
+      }
+   }
+
    // static, thread safe
    void sync_manager::send_handshakes() {
       my_impl->connections.for_each_connection( []( const connection_ptr& ci ) {
@@ -2242,7 +2551,12 @@ namespace eosio {
       peer_ilog( c, "reassign_fetch, our last req is ${cc}, next expected is ${ne}",
                ("cc", sync_last_requested_num)("ne", sync_next_expected_num) );
 
-      if( c == sync_source ) {
+      if( sync_striped ) {
+         if( release_stripe( c ) ) {
+            c->cancel_sync(reason);
+            request_stripes();
+         }
+      } else if( c == sync_source ) {
          c->cancel_sync(reason);
          sync_last_requested_num = 0;
          request_next_chunk();
@@ -2446,6 +2760,7 @@ namespace eosio {
       fc::unique_lock g( sync_mtx );
       sync_last_requested_num = 0;
       sync_next_expected_num = my_impl->get_chain_lib_num() + 1;
+      reset_stripes();
       if( mode == closing_mode::immediately || c->block_status_monitor_.max_events_violated()) {
          peer_wlog( c, "block ${bn} not accepted, closing connection", ("bn", blk_num) );
          sync_source.reset();
@@ -2484,6 +2799,7 @@ namespace eosio {
          fc::unique_lock g_sync( sync_mtx );
          peer_dlog( c, "sync_manager in head_catchup state" );
          sync_source.reset();
+         reset_stripes();
          g_sync.unlock();
 
          block_id_type null_id;
@@ -2533,6 +2849,16 @@ namespace eosio {
                   c->sync_wait();
                }
 
+               if (sync_striped) {
+                  if (blk_num >= sync_known_lib_num) {
+                     peer_dlog(c, "received non-applied block ${bn} > ${kn}, will send handshakes when caught up",
+                               ("bn", blk_num)("kn", sync_known_lib_num));
+                     send_handshakes_when_synced = true;
+                  }
+                  stripe_received(c, blk_num);
+                  return;
+               }
+
                if (sync_last_requested_num == 0) { // block was rejected
                   sync_next_expected_num = my_impl->get_chain_lib_num() + 1;
                   peer_dlog(c, "Reset sync_next_expected_num to ${n}", ("n", sync_next_expected_num));
@@ -2562,7 +2888,11 @@ namespace eosio {
                   request_next_chunk();
                }
             } else { // blk_applied
-               if (blk_num >= sync_last_requested_num) {
+               if (sync_striped) {
+                  // applied blocks move chain head forward, which may allow requesting further ranges
+                  if (can_request_stripe(blk_num))
+                     request_stripes();
+               } else if (blk_num >= sync_last_requested_num) {
                   // should not reach as should have hit the above when the block was received but not applied, but
                   // if we do then request blocks as we are still in lib_catchup
                   fc_dlog(logger, "Requesting blocks, head: ${h} fhead ${fh} blk_num: ${bn} sync_next_expected_num ${nen} "
@@ -3117,6 +3447,9 @@ namespace eosio {
          if( which == signed_block_which ) {
             latest_blk_time = std::chrono::system_clock::now();
             return process_next_block_message( message_length );
+         } else if( which == compressed_block_which ) {
+            latest_blk_time = std::chrono::system_clock::now();
+            return process_next_compressed_block_message( message_length );
          } else if( which == packed_transaction_which ) {
             return process_next_trx_message( message_length );
          } else if( which == vote_message_which ) {
@@ -3139,9 +3472,59 @@ namespace eosio {
 
    // called from connection strand
    bool connection::process_next_block_message(uint32_t message_length) {
-      auto peek_ds = pending_message_buffer.create_peek_datastream();
+      // signed_block is unpacked directly from the message buffer, following the net_message which; skip() consumes the
+      // whole message when the block is not needed
+      struct pending_block_source {
+         fc::message_buffer<1024*1024>& buffer;
+         uint32_t                       message_length;
+
+         auto create_peek_datastream() {
+            auto ds = buffer.create_peek_datastream();
+            unsigned_int which{};
+            fc::raw::unpack( ds, which ); // throw away
+            return ds;
+         }
+         auto create_datastream() {
+            auto ds = buffer.create_datastream();
+            unsigned_int which{};
+            fc::raw::unpack( ds, which ); // throw away
+            return ds;
+         }
+         void skip() { buffer.advance_read_ptr( message_length ); }
+      } source{ pending_message_buffer, message_length };
+
+      return process_block_message( source, message_length );
+   }
+
+   // called from connection strand
+   bool connection::process_next_compressed_block_message(uint32_t message_length) {
+      auto ds = pending_message_buffer.create_datastream();
       unsigned_int which{};
-      fc::raw::unpack( peek_ds, which ); // throw away
+      fc::raw::unpack( ds, which ); // throw away
+      compressed_block_message msg;
+      fc::raw::unpack( ds, msg );
+      EOS_ASSERT( msg.uncompressed_size <= max_uncompressed_block_size, plugin_exception,
+                  "compressed block uncompressed size ${s} exceeds maximum ${m}", ("s", msg.uncompressed_size)("m", max_uncompressed_block_size) );
+      const bytes packed = fc::zlib_decompress( msg.data, msg.uncompressed_size );
+      EOS_ASSERT( packed.size() == msg.uncompressed_size, plugin_exception,
+                  "compressed block uncompressed size ${s} does not match ${u}", ("s", packed.size())("u", msg.uncompressed_size) );
+
+      // message already consumed from the message buffer, signed_block is unpacked from the decompressed bytes
+      struct decompressed_block_source {
+         const bytes& packed;
+
+         fc::datastream<const char*> create_peek_datastream() const { return { packed.data(), packed.size() }; }
+         fc::datastream<const char*> create_datastream() const { return { packed.data(), packed.size() }; }
+         void skip() const {}
+      } source{ packed };
+
+      return process_block_message( source, message_length );
+   }
+
+   // called from connection strand
+   template <typename BlockSource>
+   bool connection::process_block_message(BlockSource& source, uint32_t message_length) {
+      auto peek_ds = source.create_peek_datastream();
       block_header bh;
       fc::raw::unpack( peek_ds, bh );
       const block_id_type blk_id = bh.calculate_id();
@@ -3154,7 +3537,7 @@ namespace eosio {
          my_impl->sync_master->sync_recv_block( shared_from_this(), blk_id, blk_num, false, age );
          cancel_wait();
 
-         pending_message_buffer.advance_read_ptr( message_length );
+         source.skip();
          return true;
       }
       peer_dlog( this, "received block ${num}, id ${id}..., latency: ${l}ms, head ${h}, fhead ${f}",
@@ -3173,7 +3556,7 @@ namespace eosio {
             send_handshake();
             cancel_wait();
 
-            pending_message_buffer.advance_read_ptr( message_length );
+            source.skip();
             return true;
          }
       } else {
@@ -3182,14 +3565,13 @@ namespace eosio {
          if( blk_num <= lib_num ) {
             cancel_wait();
 
-            pending_message_buffer.advance_read_ptr( message_length );
+            source.skip();
             return true;
          }
          my_impl->sync_master->sync_recv_block(shared_from_this(), blk_id, blk_num, false, age);
       }
 
-      auto ds = pending_message_buffer.create_datastream();
-      fc::raw::unpack( ds, which );
+      auto ds = source.create_datastream();
       shared_ptr<signed_block> ptr = std::make_shared<signed_block>();
       fc::raw::unpack( ds, *ptr );
 
@@ -3868,6 +4250,12 @@ namespace eosio {
             return;
          }
 
+         if( !obt && my_impl->sync_master->buffer_out_of_order_block( id, ptr, c ) ) {
+            fc_dlog( logger, "buffered out of order sync block, connection - ${cid}, blk num = ${num}, id = ${id}",
+                     ("cid", cid)("num", ptr->block_num())("id", id.str().substr(8,16)) );
+            return;
+         }
+
 
          uint32_t block_num = obt ? obt->block_num() : 0;
 
@@ -3887,6 +4275,8 @@ namespace eosio {
          if( block_num != 0 ) {
             // ready to process immediately, so signal producer to interrupt start_block
             my_impl->producer_plug->received_block(block_num);
+            // blocks received ahead of this one during striped sync can now be linked
+            my_impl->sync_master->submit_buffered_blocks( id );
          }
       });
    }
@@ -3951,6 +4341,7 @@ namespace eosio {
          boost::asio::post( my_impl->thread_pool.get_executor(), [&dispatcher = my_impl->dispatcher, c, blk_id, blk_num]() {
             fc_dlog( logger, "accepted signed_block : #${n} ${id}...", ("n", blk_num)("id", blk_id.str().substr(8,16)) );
             dispatcher.add_peer_block( blk_id, c->connection_id );
+            my_impl->sync_master->submit_buffered_blocks( blk_id );
 
             while (true) { // attempt previously unlinkable blocks where prev_unlinkable->block->previous == blk_id
                unlinkable_block_state prev_unlinkable = dispatcher.pop_possible_linkable_block(blk_id);
@@ -4033,6 +4424,7 @@ namespace eosio {
       auto now = time_point::now();
       uint32_t lib_num = get_chain_lib_num();
       dispatcher.expire_blocks( lib_num );
+      sync_master->expire_buffered_blocks( lib_num );
       dispatcher.expire_txns();
       fc_dlog( logger, "expire_txns ${n}us", ("n", time_point::now() - now) );
 
@@ -4287,6 +4679,16 @@ namespace eosio {
            "Number of blocks to retrieve in a chunk from any individual peer during synchronization")
          ( "sync-peer-limit", bpo::value<uint32_t>()->default_value(3),
            "Number of peers to sync from")
+         ( "sync-striped", bpo::value<bool>()->default_value(false),
+           "Request disjoint block ranges from up to sync-peer-limit peers at the same time during sync.\n"
+           "The range size requested from each peer is adapted to its measured throughput.")
+         ( "sync-reorder-buffer-size-mb", bpo::value<uint32_t>()->default_value(def_sync_reorder_buffer_size_mb),
+           "Maximum size in MiB of blocks received ahead of the block they build on that are held during striped sync")
+         ( "sync-block-cache-size-mb", bpo::value<uint32_t>()->default_value(def_sync_block_cache_size_mb),
+           "Maximum size in MiB of packed blocks kept in memory for serving peers syncing from this node, 0 to disable")
+         ( "p2p-sync-compression-level", bpo::value<int>()->default_value(def_sync_compression_level),
+           "zlib compression level (1-9) of blocks sent to peers syncing from this node, 0 to disable.\n"
+           "Only applied to peers that support compressed blocks, blocks are sent uncompressed to older peers.")
          ( "use-socket-read-watermark", bpo::value<bool>()->default_value(false), "Enable experimental socket read watermark optimization")
          ( "peer-log-format", bpo::value<string>()->default_value( "[\"${_name}\" - ${_cid} ${_ip}:${_port}] " ),
            "The string used to format peers when logging messages about them.  Variables are escaped with ${<variable name>}.\n"
@@ -4334,7 +4736,13 @@ namespace eosio {
          sync_master = std::make_unique<sync_manager>(
              options.at( "sync-fetch-span" ).as<uint32_t>(),
              options.at( "sync-peer-limit" ).as<uint32_t>(),
-             min_blocks_distance);
+             min_blocks_distance,
+             options.at( "sync-striped" ).as<bool>(),
+             size_t(options.at( "sync-reorder-buffer-size-mb" ).as<uint32_t>()) * 1024 * 1024);
+         sync_compression_level = options.at( "p2p-sync-compression-level" ).as<int>();
+         EOS_ASSERT( sync_compression_level >= 0 && sync_compression_level <= 9, chain::plugin_config_exception,
+                     "p2p-sync-compression-level must be between 0 and 9" );
+         sync_block_buffers.set_max_bytes( size_t(options.at( "sync-block-cache-size-mb" ).as<uint32_t>()) * 1024 * 1024 );
 
          connections.init( std::chrono::milliseconds( options.at("p2p-keepalive-interval-ms").as<int>() * 2 ),
                                fc::milliseconds( options.at("max-cleanup-time-msec").as<uint32_t>() ),
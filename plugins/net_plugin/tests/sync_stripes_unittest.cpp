@@ -0,0 +1,273 @@
+#include <boost/test/unit_test.hpp>
+#include <eosio/net_plugin/sync_stripes.hpp>
+
+#include <fc/bitutil.hpp>
+#include <fc/io/raw.hpp>
+
+using namespace eosio;
+using namespace eosio::chain;
+
+struct mock_sync_connection {
+   uint32_t connection_id = 0;
+   explicit mock_sync_connection(uint32_t id) : connection_id(id) {}
+};
+using mock_connection_ptr = std::shared_ptr<mock_sync_connection>;
+using stripe_tracker = sync_stripe_tracker<mock_connection_ptr>;
+using reorder_buffer = sync_reorder_buffer<mock_connection_ptr>;
+
+namespace {
+
+// n blocks starting at block 2, each building on the previous one
+std::vector<signed_block_ptr> make_chain(size_t n) {
+   std::vector<signed_block_ptr> result;
+   block_id_type prev; // id of block 1
+   prev._hash[0] = fc::endian_reverse_u32(1);
+   for (size_t i = 0; i < n; ++i) {
+      auto b = std::make_shared<signed_block>();
+      b->previous = prev;
+      prev = b->calculate_id();
+      result.push_back(b);
+   }
+   return result;
+}
+
+} // anonymous namespace
+
+BOOST_AUTO_TEST_SUITE(sync_stripes_tests)
+
+BOOST_AUTO_TEST_CASE(reorder_buffer_submits_in_order) {
+   const auto chain = make_chain(4);
+   const size_t block_size = fc::raw::pack_size(*chain[0]);
+   auto c1 = std::make_shared<mock_sync_connection>(1);
+   auto c2 = std::make_shared<mock_sync_connection>(2);
+
+   reorder_buffer buffer;
+   buffer.set_max_bytes(block_size * 3);
+
+   // blocks of a later range arrive from c2 before the earlier blocks from c1
+   BOOST_TEST(buffer.add(chain[3]->calculate_id(), chain[3], c2, block_size));
+   BOOST_TEST(buffer.add(chain[2]->calculate_id(), chain[2], c2, block_size));
+   BOOST_TEST(buffer.add(chain[2]->calculate_id(), chain[2], c2, block_size)); // already buffered
+   BOOST_TEST(buffer.size() == 2u);
+   BOOST_TEST(buffer.bytes() == block_size * 2);
+
+   BOOST_TEST(!buffer.pop_next(chain[0]->previous));
+
+   // chain[1] is linked, buffered blocks are submitted in order
+   auto next = buffer.pop_next(chain[1]->calculate_id());
+   BOOST_REQUIRE(next);
+   BOOST_CHECK(next->id == chain[2]->calculate_id());
+   BOOST_TEST(next->conn == c2);
+   next = buffer.pop_next(next->id);
+   BOOST_REQUIRE(next);
+   BOOST_CHECK(next->id == chain[3]->calculate_id());
+   BOOST_TEST(!buffer.pop_next(next->id));
+   BOOST_TEST(buffer.size() == 0u);
+   BOOST_TEST(buffer.bytes() == 0u);
+
+   BOOST_TEST(buffer.add(chain[1]->calculate_id(), chain[1], c1, block_size));
+   BOOST_TEST(buffer.remove(chain[1]->calculate_id()));
+   BOOST_TEST(!buffer.remove(chain[1]->calculate_id()));
+   BOOST_TEST(buffer.bytes() == 0u);
+}
+
+BOOST_AUTO_TEST_CASE(reorder_buffer_bounded_by_bytes) {
+   const auto chain = make_chain(4);
+   const size_t block_size = fc::raw::pack_size(*chain[0]);
+   auto c = std::make_shared<mock_sync_connection>(1);
+
+   reorder_buffer buffer;
+   buffer.set_max_bytes(block_size * 2 + block_size / 2);
+
+   BOOST_TEST(buffer.add(chain[1]->calculate_id(), chain[1], c, block_size));
+   BOOST_TEST(buffer.add(chain[2]->calculate_id(), chain[2], c, block_size));
+   BOOST_TEST(!buffer.add(chain[3]->calculate_id(), chain[3], c, block_size));
+   // a smaller block still fits
+   BOOST_TEST(buffer.add(chain[3]->calculate_id(), chain[3], c, block_size / 2));
+   BOOST_TEST(buffer.bytes() == block_size * 2 + block_size / 2);
+
+   // expiring blocks at or below lib frees their bytes
+   buffer.expire_blocks(chain[2]->block_num());
+   BOOST_TEST(buffer.size() == 1u);
+   BOOST_TEST(buffer.bytes() == block_size / 2);
+   BOOST_TEST(buffer.add(chain[0]->calculate_id(), chain[0], c, block_size));
+
+   buffer.clear();
+   BOOST_TEST(buffer.size() == 0u);
+   BOOST_TEST(buffer.bytes() == 0u);
+}
+
+BOOST_AUTO_TEST_CASE(stripes_assigned_disjoint) {
+   auto c1 = std::make_shared<mock_sync_connection>(1);
+   auto c2 = std::make_shared<mock_sync_connection>(2);
+   auto c3 = std::make_shared<mock_sync_connection>(3);
+   const fc::time_point now = fc::time_point::now();
+
+   stripe_tracker stripes(100, 2);
+   const uint32_t known_lib = 1000, head = 1;
+   uint32_t last_requested = 0;
+
+   BOOST_TEST(stripes.can_request(last_requested + 2, known_lib, head));
+   auto [s1, e1] = stripes.assign(c1, 2, known_lib, now);
+   BOOST_TEST(s1 == 2u);
+   BOOST_TEST(e1 == 101u);
+   last_requested = e1;
+   auto [s2, e2] = stripes.assign(c2, last_requested + 1, known_lib, now);
+   BOOST_TEST(s2 == 102u);
+   BOOST_TEST(e2 == 201u);
+   last_requested = e2;
+
+   // at most sync_peer_limit outstanding ranges
+   BOOST_TEST(!stripes.can_request(last_requested + 1, known_lib, head));
+   BOOST_TEST(stripes.has_stripe(c1));
+   BOOST_TEST(!stripes.has_stripe(c3));
+
+   // blocks are only accepted from the connection they were requested from
+   BOOST_TEST(stripes.in_stripe(c1, 2));
+   BOOST_TEST(stripes.in_stripe(c1, 101));
+   BOOST_TEST(!stripes.in_stripe(c1, 102));
+   BOOST_TEST(stripes.in_stripe(c2, 150));
+   BOOST_TEST(!stripes.in_stripe(c2, 50));
+   BOOST_TEST(!stripes.in_stripe(c3, 50));
+
+   BOOST_CHECK(stripes.received(c2, 50, now) == stripe_tracker::receive_status::not_requested);
+   BOOST_CHECK(stripes.received(c2, 102, now) == stripe_tracker::receive_status::pending);
+   BOOST_TEST(!stripes.in_stripe(c2, 102)); // already received
+   BOOST_TEST(stripes.next_expected(last_requested) == 2u);
+   for (uint32_t n = 2; n < 101; ++n)
+      BOOST_CHECK(stripes.received(c1, n, now) == stripe_tracker::receive_status::pending);
+   BOOST_TEST(stripes.next_expected(last_requested) == 101u);
+   BOOST_CHECK(stripes.received(c1, 101, now) == stripe_tracker::receive_status::completed);
+   BOOST_TEST(!stripes.has_stripe(c1));
+   BOOST_TEST(stripes.next_expected(last_requested) == 103u);
+
+   // last range is cut at the known lib
+   BOOST_TEST(stripes.can_request(last_requested + 1, 250, head));
+   auto [s3, e3] = stripes.assign(c3, last_requested + 1, 250, now);
+   BOOST_TEST(s3 == 202u);
+   BOOST_TEST(e3 == 250u);
+}
+
+BOOST_AUTO_TEST_CASE(stripes_not_too_far_ahead_of_head) {
+   stripe_tracker stripes(100, 3);
+   // requests stay within sync_req_span * sync_peer_limit of chain head
+   BOOST_TEST(stripes.can_request(301, 1000, 1));
+   BOOST_TEST(!stripes.can_request(302, 1000, 1));
+   BOOST_TEST(stripes.can_request(302, 1000, 2));
+   // nothing requested beyond the known lib
+   BOOST_TEST(!stripes.can_request(1001, 1000, 1000));
+}
+
+BOOST_AUTO_TEST_CASE(released_stripe_reassigned) {
+   auto c1 = std::make_shared<mock_sync_connection>(1);
+   auto c2 = std::make_shared<mock_sync_connection>(2);
+   auto c3 = std::make_shared<mock_sync_connection>(3);
+   const fc::time_point now = fc::time_point::now();
+
+   stripe_tracker stripes(100, 2);
+   const uint32_t known_lib = 1000, head = 1;
+   stripes.assign(c1, 2, known_lib, now);   // 2..101
+   stripes.assign(c2, 102, known_lib, now); // 102..201
+   const uint32_t last_requested = 201;
+
+   for (uint32_t n = 2; n <= 40; ++n)
+      stripes.received(c1, n, now);
+
+   // c1 closes, the part of its range not yet received is requested from the next peer
+   BOOST_TEST(stripes.release(c1));
+   BOOST_TEST(!stripes.release(c1));
+   BOOST_TEST(!stripes.in_stripe(c1, 41));
+   BOOST_REQUIRE(stripes.unassigned_gaps().size() == 1u);
+   BOOST_TEST(stripes.unassigned_gaps().front().first == 41u);
+   BOOST_TEST(stripes.unassigned_gaps().front().second == 101u);
+   BOOST_TEST(stripes.next_expected(last_requested) == 41u);
+
+   // gaps are assigned before new ranges, even when ahead of the head limit
+   BOOST_TEST(stripes.can_request(last_requested + 1, known_lib, head));
+   auto [s, e] = stripes.assign(c3, last_requested + 1, known_lib, now);
+   BOOST_TEST(s == 41u);
+   BOOST_TEST(e == 101u);
+   BOOST_TEST(stripes.unassigned_gaps().empty());
+   BOOST_TEST(stripes.in_stripe(c3, 41));
+   BOOST_TEST(stripes.next_expected(last_requested) == 41u);
+
+   // the most recently released gap is assigned first
+   stripe_tracker split(4, 3);
+   split.assign(c1, 2, known_lib, now); // 2..5
+   split.assign(c2, 6, known_lib, now); // 6..9
+   split.received(c1, 2, now);
+   BOOST_TEST(split.release(c1));       // gap 3..5
+   BOOST_TEST(split.release(c2));       // gap 6..9, in front
+   auto [gs1, ge1] = split.assign(c3, 10, known_lib, now);
+   BOOST_TEST(gs1 == 6u);
+   BOOST_TEST(ge1 == 9u);
+   auto [gs2, ge2] = split.assign(c1, 10, known_lib, now);
+   BOOST_TEST(gs2 == 3u);
+   BOOST_TEST(ge2 == 5u);
+   BOOST_TEST(split.next_expected(9) == 3u);
+}
+
+BOOST_AUTO_TEST_CASE(stripe_span_follows_throughput) {
+   auto fast = std::make_shared<mock_sync_connection>(1);
+   auto slow = std::make_shared<mock_sync_connection>(2);
+   const fc::time_point now = fc::time_point::now();
+
+   stripe_tracker stripes(100, 2);
+   BOOST_TEST(stripes.span(fast) == 100u); // not measured yet
+
+   stripes.assign(fast, 2, 10000, now);
+   stripes.assign(slow, 102, 10000, now);
+   BOOST_CHECK(stripes.received(fast, 101, now + fc::seconds(1)) == stripe_tracker::receive_status::completed);
+   BOOST_TEST(stripes.span(fast) == 100u); // only one measured peer
+   BOOST_CHECK(stripes.received(slow, 201, now + fc::seconds(3)) == stripe_tracker::receive_status::completed);
+
+   // 100 and 33 blocks/sec, fast peer gets about 1.5 times the span, slow peer about half
+   BOOST_TEST(stripes.span(fast) >= 149u);
+   BOOST_TEST(stripes.span(fast) <= 150u);
+   BOOST_TEST(stripes.span(slow) >= 49u);
+   BOOST_TEST(stripes.span(slow) <= 50u);
+
+   // forgotten peers are measured again
+   stripes.erase_rate(slow);
+   BOOST_TEST(stripes.span(fast) == 100u);
+}
+
+BOOST_AUTO_TEST_CASE(slow_peer_gets_part_of_released_range) {
+   auto fast = std::make_shared<mock_sync_connection>(1);
+   auto slow = std::make_shared<mock_sync_connection>(2);
+   const fc::time_point now = fc::time_point::now();
+
+   stripe_tracker stripes(100, 2);
+   stripes.assign(fast, 2, 10000, now);
+   stripes.assign(slow, 102, 10000, now);
+   stripes.received(fast, 101, now + fc::seconds(1));
+   stripes.received(slow, 201, now + fc::seconds(1000));
+
+   // a much slower peer still gets a quarter of the span
+   BOOST_TEST(stripes.span(slow) == 25u);
+   const uint32_t fast_span = stripes.span(fast);
+   BOOST_TEST(fast_span > 190u);
+   BOOST_TEST(fast_span < 200u);
+
+   auto [fs, fe] = stripes.assign(fast, 202, 10000, now);
+   BOOST_TEST(fs == 202u);
+   BOOST_TEST(fe == 202u + fast_span - 1);
+   stripes.received(fast, 202, now);
+
+   // fast peer times out, its range is split according to the span of the slow peer
+   BOOST_TEST(stripes.release(fast));
+   auto [ss, se] = stripes.assign(slow, fe + 1, 10000, now);
+   BOOST_TEST(ss == 203u);
+   BOOST_TEST(se == 227u);
+   BOOST_REQUIRE(stripes.unassigned_gaps().size() == 1u);
+   BOOST_TEST(stripes.unassigned_gaps().front().first == 228u);
+   BOOST_TEST(stripes.unassigned_gaps().front().second == fe);
+   BOOST_TEST(stripes.next_expected(fe) == 203u);
+
+   stripes.clear();
+   BOOST_TEST(stripes.outstanding().empty());
+   BOOST_TEST(stripes.unassigned_gaps().empty());
+   BOOST_TEST(stripes.span(slow) == 25u); // rates are kept
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -139,6 +139,11 @@ void producer_api_plugin::plugin_startup() {
             INVOKE_R_V(producer, get_integrity_hash), 201),
        CALL_WITH_400(producer, producer_rw, producer, schedule_protocol_feature_activations,
             INVOKE_V_R(producer, schedule_protocol_feature_activations, producer_plugin::scheduled_protocol_feature_activations), 201),
+#ifdef EOSIO_EOS_VM_OC_RUNTIME_ENABLED
+       // reads the usage statistics of the main thread
+       CALL_WITH_400(producer, producer_rw, producer, get_eos_vm_oc_stats,
+            INVOKE_R_R_II(producer, get_eos_vm_oc_stats, producer_plugin::get_eos_vm_oc_stats_params), 201),
+#endif
    }, appbase::exec_queue::read_write, appbase::priority::medium_high);
 }
 
@@ -108,6 +108,14 @@ public:
 
    get_account_ram_corrections_result  get_account_ram_corrections( const get_account_ram_corrections_params& params ) const;
 
+#ifdef EOSIO_EOS_VM_OC_RUNTIME_ENABLED
+   struct get_eos_vm_oc_stats_params {
+      uint32_t limit = 100; /// number of contracts of the most execution time to include
+   };
+
+   chain::wasm_interface::eosvmoc_stats get_eos_vm_oc_stats( const get_eos_vm_oc_stats_params& params ) const;
+#endif
+
    struct get_unapplied_transactions_params {
       string      lower_bound;  /// transaction id
       std::optional<uint32_t>    limit = 100;
@@ -213,6 +221,9 @@ FC_REFLECT(eosio::producer_plugin::scheduled_protocol_feature_activations, (prot
 FC_REFLECT(eosio::producer_plugin::get_supported_protocol_features_params, (exclude_disabled)(exclude_unactivatable))
 FC_REFLECT(eosio::producer_plugin::get_account_ram_corrections_params, (lower_bound)(upper_bound)(limit)(reverse))
 FC_REFLECT(eosio::producer_plugin::get_account_ram_corrections_result, (rows)(more))
+#ifdef EOSIO_EOS_VM_OC_RUNTIME_ENABLED
+FC_REFLECT(eosio::producer_plugin::get_eos_vm_oc_stats_params, (limit))
+#endif
 FC_REFLECT(eosio::producer_plugin::get_unapplied_transactions_params, (lower_bound)(limit)(time_limit_ms))
 FC_REFLECT(eosio::producer_plugin::unapplied_trx, (trx_id)(expiration)(trx_type)(first_auth)(first_receiver)(first_action)(total_actions)(billed_cpu_time_us)(size))
 FC_REFLECT(eosio::producer_plugin::get_unapplied_transactions_result, (size)(incoming_size)(trxs)(more))
@@ -503,6 +503,8 @@ public:
    std::atomic<int32_t>                              _max_transaction_time_ms; // modified by app thread, read by net_plugin thread pool
    std::atomic<uint32_t>                             _received_block{0};       // modified by net_plugin thread pool
    fc::microseconds                                  _max_irreversible_block_age_us;
+   // EOS VM OC burst compiles are not started this long before a production slot, a compile can take seconds
+   static constexpr fc::microseconds                 _eos_vm_oc_burst_margin_us{6'000'000};
    // produce-block-offset is in terms of the complete round, internally use calculated value for each block of round
    fc::microseconds                                  _produce_block_cpu_effort;
    fc::time_point                                    _pending_block_deadline;
@@ -1026,6 +1028,17 @@ public:
              (_max_irreversible_block_age_us.count() >= 0 && get_irreversible_block_age() >= _max_irreversible_block_age_us);
    }
 
+   // true if one of our producers is scheduled to start a block within _eos_vm_oc_burst_margin_us
+   bool production_upcoming(uint32_t block_num, chain::block_timestamp_type block_time) {
+      if (_producers.empty() || production_disabled_by_policy())
+         return false;
+      chain::controller& chain = chain_plug->chain();
+      std::optional<fc::time_point> wake_time = block_timing_util::calculate_producer_wake_up_time(
+         fc::microseconds{config::block_interval_us}, block_num, block_time, _producers, chain.head_active_producers().producers,
+         _producer_watermarks);
+      return wake_time && *wake_time < fc::time_point::now() + _eos_vm_oc_burst_margin_us;
+   }
+
    bool is_producer_key(const chain::public_key_type& key) const {
       return _signature_providers.find(key) != _signature_providers.end();
    }
@@ -1620,6 +1633,12 @@ producer_plugin::integrity_hash_information producer_plugin::get_integrity_hash(
    return my->get_integrity_hash();
 }
 
+#ifdef EOSIO_EOS_VM_OC_RUNTIME_ENABLED
+chain::wasm_interface::eosvmoc_stats producer_plugin::get_eos_vm_oc_stats(const get_eos_vm_oc_stats_params& params) const {
+   return my->chain_plug->chain().get_eos_vm_oc_stats(params.limit);
+}
+#endif
+
 void producer_plugin::create_snapshot(producer_plugin::next_function<chain::snapshot_scheduler::snapshot_information> next) {
    my->create_snapshot(std::move(next));
 }
@@ -2037,6 +2056,12 @@ producer_plugin_impl::start_block_result producer_plugin_impl::start_block() {
          _pending_block_mode = pending_block_mode::speculating;
       }
 
+#ifdef EOSIO_EOS_VM_OC_RUNTIME_ENABLED
+      // compiles use all cores between production windows, e.g. after a new contract storm, but none are started while
+      // producing or shortly before; compiles already running are not interrupted
+      chain.limit_eos_vm_oc_compile_threads(in_producing_mode() || production_upcoming(pending_block_num, block_time));
+#endif
+
       try {
          chain::subjective_billing& subjective_bill = chain.get_mutable_subjective_billing();
          _account_fails.report_and_clear(pending_block_num, subjective_bill);
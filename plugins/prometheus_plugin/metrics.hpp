@@ -114,6 +114,20 @@ struct catalog_type {
    Counter& latency_us_incoming_block;
    Counter& blocks_incoming;
 
+#ifdef EOSIO_EOS_VM_OC_RUNTIME_ENABLED
+   // chain EOS VM OC tier-up
+   struct eos_vm_oc_metrics {
+      Gauge& tracked_codes;
+      Gauge& hot_codes;
+      Gauge& cached_codes;
+      Gauge& queued_compiles;
+      Gauge& outstanding_compiles;
+      Gauge& compile_threads;
+      Gauge& evictions;
+   };
+   eos_vm_oc_metrics eos_vm_oc;
+#endif
+
    // prometheus exporter
    Counter& bytes_transferred;
    Counter& num_scrapes;
@@ -194,6 +208,16 @@ struct catalog_type {
        , net_usage_us_incoming_block(net_usage_us.Add({{"block_type", "incoming"}}))
        , latency_us_incoming_block(build<Counter>("nodeos_incoming_us_block_latency", "total incoming block latency"))
        , blocks_incoming(build<Counter>("nodeos_blocks_incoming", "number of incoming blocks"))
+#ifdef EOSIO_EOS_VM_OC_RUNTIME_ENABLED
+       , eos_vm_oc{
+              .tracked_codes{build<Gauge>("nodeos_eos_vm_oc_tracked_codes", "number of contracts with EOS VM OC tier-up execution statistics")}
+            , .hot_codes{build<Gauge>("nodeos_eos_vm_oc_hot_codes", "number of contracts executed often enough to be compiled by EOS VM OC")}
+            , .cached_codes{build<Gauge>("nodeos_eos_vm_oc_cached_codes", "number of contracts in the EOS VM OC code cache")}
+            , .queued_compiles{build<Gauge>("nodeos_eos_vm_oc_queued_compiles", "number of contracts waiting for an EOS VM OC compile thread")}
+            , .outstanding_compiles{build<Gauge>("nodeos_eos_vm_oc_outstanding_compiles", "number of contracts being compiled by EOS VM OC")}
+            , .compile_threads{build<Gauge>("nodeos_eos_vm_oc_compile_threads", "limit on the number of contracts being compiled by EOS VM OC at once")}
+            , .evictions{build<Gauge>("nodeos_eos_vm_oc_evictions", "number of contracts evicted from the EOS VM OC code cache to make room")} }
+#endif
        , bytes_transferred(build<Counter>("exposer_transferred_bytes_total",
                                           "total number of bytes for responses to prometheus scrape requests"))
        , num_scrapes(build<Counter>("exposer_scrapes_total", "total number of prometheus scrape requests received")) {}
@@ -310,6 +334,20 @@ struct catalog_type {
       head_block_num.Set(metrics.head_block_num);
    }
 
+#ifdef EOSIO_EOS_VM_OC_RUNTIME_ENABLED
+   // the chain updates these every irreversible block
+   void update_eos_vm_oc_metrics() {
+      const auto stats = app().get_plugin<chain_plugin>().chain().get_eos_vm_oc_metrics();
+      eos_vm_oc.tracked_codes.Set(stats.tracked_codes);
+      eos_vm_oc.hot_codes.Set(stats.hot_codes);
+      eos_vm_oc.cached_codes.Set(stats.cached_codes);
+      eos_vm_oc.queued_compiles.Set(stats.queued_compiles);
+      eos_vm_oc.outstanding_compiles.Set(stats.outstanding_compiles);
+      eos_vm_oc.compile_threads.Set(stats.compile_threads);
+      eos_vm_oc.evictions.Set(stats.evictions);
+   }
+#endif
+
    void update_prometheus_info() {
       info_details = info.Add({
             {"server_version", chain_apis::itoh(static_cast<uint32_t>(app().version()))},
@@ -41,6 +41,9 @@ namespace eosio {
 
       void metrics(const fc::variant_object&, chain::plugin_interface::next_function<std::string> results) {
          _impl->_prometheus_strand.post([this, results=std::move(results)]() {
+#ifdef EOSIO_EOS_VM_OC_RUNTIME_ENABLED
+            _impl->_catalog.update_eos_vm_oc_metrics();
+#endif
             results(_impl->_catalog.report());
          });
       }
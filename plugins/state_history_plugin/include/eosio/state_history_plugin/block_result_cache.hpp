@@ -0,0 +1,119 @@
+#pragma once
+#include <eosio/chain/types.hpp>
+
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+
+namespace eosio::state_history {
+
+/**
+ * Bounded cache, shared by all sessions, of the serialized get_blocks_result of recent blocks.
+ *
+ * Only the part of the message following head and last_irreversible is cached (this_block, prev_block, block and the
+ * log entries), since those two positions change while the rest is fixed for a given block id and set of fetch flags.
+ * Bodies are refcounted so that an evicted body stays alive until every session sending it is done. The oldest
+ * entries are evicted once the total size exceeds max_bytes; a max_bytes of 0 disables the cache.
+ *
+ * Thread safe: looked up on the main thread and filled in from the session strands.
+ */
+class block_result_cache {
+public:
+   using body_ptr = std::shared_ptr<const std::vector<char>>;
+
+   enum fetch_flags : uint8_t {
+      fetch_block         = 1 << 0,
+      fetch_traces        = 1 << 1,
+      fetch_deltas        = 1 << 2,
+      fetch_finality_data = 1 << 3,
+      result_v1           = 1 << 4
+   };
+
+   struct key_t {
+      chain::block_id_type block_id;
+      uint8_t              flags = 0;
+
+      auto operator<=>(const key_t&) const = default;
+   };
+
+   struct stats_t {
+      uint64_t hits     = 0; // lookups which found a body
+      uint64_t inserted = 0; // bodies built by a session and added
+   };
+
+   explicit block_result_cache(size_t max_bytes = 0) : max_bytes(max_bytes) {}
+
+   void set_max_bytes(size_t m) {
+      std::lock_guard g(mtx);
+      max_bytes = m;
+      evict();
+   }
+
+   bool enabled() const {
+      std::lock_guard g(mtx);
+      return max_bytes > 0;
+   }
+
+   /// larger bodies are not cached, sessions stream them from the logs instead
+   size_t max_body_size() const {
+      std::lock_guard g(mtx);
+      return max_bytes;
+   }
+
+   body_ptr find(const key_t& key) const {
+      std::lock_guard g(mtx);
+      auto it = entries.find(key);
+      if (it == entries.end())
+         return {};
+      ++stats.hits;
+      return it->second;
+   }
+
+   /// @return the cached body for key, which is the existing one if another session inserted it first
+   body_ptr insert(const key_t& key, std::vector<char>&& body) {
+      auto b = std::make_shared<const std::vector<char>>(std::move(body));
+      std::lock_guard g(mtx);
+      if (b->size() > max_bytes)
+         return b;
+      auto [it, inserted] = entries.try_emplace(key, b);
+      if (!inserted)
+         return it->second;
+      insertion_order.push_back(key);
+      total_bytes += b->size();
+      ++stats.inserted;
+      evict();
+      return b;
+   }
+
+   stats_t get_stats() const {
+      std::lock_guard g(mtx);
+      return stats;
+   }
+
+   void clear() {
+      std::lock_guard g(mtx);
+      entries.clear();
+      insertion_order.clear();
+      total_bytes = 0;
+   }
+
+private:
+   void evict() {
+      while (total_bytes > max_bytes && !insertion_order.empty()) {
+         auto it = entries.find(insertion_order.front());
+         total_bytes -= it->second->size();
+         entries.erase(it);
+         insertion_order.pop_front();
+      }
+   }
+
+   mutable std::mutex         mtx;
+   size_t                     max_bytes;
+   size_t                     total_bytes = 0;
+   std::map<key_t, body_ptr>  entries;
+   std::deque<key_t>          insertion_order; // oldest first
+   mutable stats_t            stats;
+};
+
+} // namespace eosio::state_history
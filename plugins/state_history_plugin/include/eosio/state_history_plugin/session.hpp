@@ -1,7 +1,9 @@
 #pragma once
+#include <eosio/state_history/filter.hpp>
 #include <eosio/state_history/log.hpp>
 #include <eosio/state_history/serialization.hpp>
 #include <eosio/state_history/types.hpp>
+#include <eosio/state_history_plugin/block_result_cache.hpp>
 
 #include <eosio/chain/types.hpp>
 #include <eosio/chain/controller.hpp>
@@ -11,6 +13,10 @@
 #include <boost/asio/local/stream_protocol.hpp>
 #include <boost/asio/error.hpp>
 #include <boost/beast/websocket.hpp>
+#include <boost/iostreams/device/back_inserter.hpp>
+#include <boost/iostreams/copy.hpp>
+#include <algorithm>
+#include <limits>
 #include <memory>
 
 extern const char* const state_history_plugin_abi;
@@ -37,10 +43,11 @@ class session final : public session_base {
 public:
    session(SocketType&& s, Executor&& st, chain::controller& controller,
               std::optional<log_catalog>& trace_log, std::optional<log_catalog>& chain_state_log, std::optional<log_catalog>& finality_data_log,
+              std::optional<log_catalog>& filter_index_log, block_result_cache& result_cache, const std::deque<chain::block_num_type>& unlogged_blocks,
               GetBlockID&& get_block_id, GetBlock&& get_block, OnDone&& on_done, fc::logger& logger) :
     strand(std::move(st)), stream(std::move(s)), wake_timer(strand), controller(controller),
-    trace_log(trace_log), chain_state_log(chain_state_log), finality_data_log(finality_data_log),
-    get_block_id(get_block_id), get_block(get_block), on_done(on_done), logger(logger), remote_endpoint_string(get_remote_endpoint_string()) {
+    trace_log(trace_log), chain_state_log(chain_state_log), finality_data_log(finality_data_log), filter_index_log(filter_index_log),
+    result_cache(result_cache), unlogged_blocks(unlogged_blocks), get_block_id(get_block_id), get_block(get_block), on_done(on_done), logger(logger), remote_endpoint_string(get_remote_endpoint_string()) {
       fc_ilog(logger, "incoming state history connection from ${a}", ("a", remote_endpoint_string));
 
       boost::asio::co_spawn(strand, read_loop(), [&](std::exception_ptr e) {check_coros_done(e);});
@@ -149,9 +156,17 @@ private:
                   },
                   [&self]<typename GetBlocksRequestV0orV1, typename = std::enable_if_t<std::is_base_of_v<get_blocks_request_v0, GetBlocksRequestV0orV1>>>(const GetBlocksRequestV0orV1& gbr) {
                      self.current_blocks_request_v1_finality.reset();
+                     self.current_blocks_request_filters.reset();
                      self.current_blocks_request = gbr;
-                     if constexpr(std::is_same_v<GetBlocksRequestV0orV1, get_blocks_request_v1>)
+                     if constexpr(std::is_base_of_v<get_blocks_request_v1, GetBlocksRequestV0orV1>)
                         self.current_blocks_request_v1_finality = gbr.fetch_finality_data;
+                     if constexpr(std::is_same_v<GetBlocksRequestV0orV1, get_blocks_request_v2>) {
+                        EOS_ASSERT(gbr.trace_filters.empty() || self.filter_index_log, chain::plugin_exception,
+                                   "trace_filters of get_blocks_request_v2 require state-history-filter-index");
+                        auto filters = std::make_shared<block_filters>(block_filters{.traces = gbr.trace_filters, .deltas = gbr.delta_filters});
+                        if(!filters->empty())
+                           self.current_blocks_request_filters = std::move(filters);
+                     }
 
                      for(const block_position& haveit : self.current_blocks_request.have_positions) {
                         if(self.current_blocks_request.start_block_num <= haveit.block_num)
@@ -210,6 +225,115 @@ private:
       }
    }
 
+   //the fetch flags of the current request which affect the result, as far as the logs are enabled
+   uint8_t result_cache_flags() const {
+      uint8_t flags = 0;
+      if(current_blocks_request.fetch_block)
+         flags |= block_result_cache::fetch_block;
+      if(current_blocks_request.fetch_traces && trace_log)
+         flags |= block_result_cache::fetch_traces;
+      if(current_blocks_request.fetch_deltas && chain_state_log)
+         flags |= block_result_cache::fetch_deltas;
+      if(current_blocks_request_v1_finality) {
+         flags |= block_result_cache::result_v1;
+         if(*current_blocks_request_v1_finality && finality_data_log)
+            flags |= block_result_cache::fetch_finality_data;
+      }
+      return flags;
+   }
+
+   //reads the entry into memory, false once it is larger than max_size
+   static bool read_log_entry(std::optional<ship_log_entry>& log_stream, std::optional<std::vector<char>>& entry, uint64_t max_size) {
+      entry.reset();
+      if(!log_stream)
+         return true;
+      //read the entry once, the streaming path in write_log_entry() needs a separate pass for the size
+      entry.emplace();
+      bio::filtering_istreambuf decompression_stream = log_stream->get_stream();
+      char buff[64*1024];
+      std::streamsize red = 0;
+      while((red = bio::read(decompression_stream, buff, sizeof(buff))) != -1) {
+         if(entry->size() + red > max_size)
+            return false;
+         entry->insert(entry->end(), buff, buff + red);
+      }
+      return true;
+   }
+
+   static std::optional<std::vector<char>> read_log_entry(std::optional<ship_log_entry>& log_stream) {
+      std::optional<std::vector<char>> entry;
+      read_log_entry(log_stream, entry, std::numeric_limits<uint64_t>::max());
+      return entry;
+   }
+
+   static void append_log_entry(std::vector<char>& body, const std::optional<std::vector<char>>& entry) {
+      if(!entry) {
+         body.push_back(0); //packed false
+         return;
+      }
+
+      char header[16];
+      fc::datastream<char*> ds(header, sizeof(header));
+      fc::raw::pack(ds, true);
+      history_pack_varuint64(ds, entry->size());
+      body.insert(body.end(), header, header + ds.tellp());
+      body.insert(body.end(), entry->begin(), entry->end());
+   }
+
+   template<typename BlockPackage>
+   static void apply_filters(BlockPackage& block_package, std::optional<std::vector<char>>& traces, std::optional<std::vector<char>>& deltas) {
+      const block_filters& filters = *block_package.filters;
+      block_filter_index index;
+      if(std::optional<std::vector<char>> index_entry = read_log_entry(block_package.filter_index_entry))
+         index = fc::raw::unpack<block_filter_index>(*index_entry);
+
+      //without an index for the block its traces can't be filtered and filter_traces() throws, ending the session rather
+      // than sending unfiltered traces; filter_deltas() indexes the deltas itself
+      if(traces && !filters.traces.empty())
+         traces = filter_traces(*traces, index.traces, filters.traces);
+      if(deltas && !filters.deltas.empty())
+         deltas = filter_deltas(*deltas, index.deltas, filters.deltas);
+   }
+
+   //everything of the result following head and last_irreversible; unset when it would be larger than max_size, without
+   // reading more than max_size of the log entries
+   template<typename BlockPackage>
+   static std::optional<std::vector<char>> build_result_body(BlockPackage& block_package, uint64_t max_size = std::numeric_limits<uint64_t>::max()) {
+      const get_blocks_result_base& base = block_package.blocks_result_base;
+      fc::datastream<size_t> ss;
+      fc::raw::pack(ss, base.this_block);
+      fc::raw::pack(ss, base.prev_block);
+      fc::raw::pack(ss, base.block);
+      if(ss.tellp() > max_size)
+         return {};
+      std::vector<char> body(ss.tellp());
+      fc::datastream<char*> ds(body.data(), body.size());
+      fc::raw::pack(ds, base.this_block);
+      fc::raw::pack(ds, base.prev_block);
+      fc::raw::pack(ds, base.block);
+
+      uint64_t remaining = max_size - body.size();
+      auto read_entry = [&](std::optional<ship_log_entry>& log_stream, std::optional<std::vector<char>>& entry) {
+         if(!read_log_entry(log_stream, entry, remaining))
+            return false;
+         remaining -= entry ? entry->size() : 0;
+         return true;
+      };
+      std::optional<std::vector<char>> traces, deltas, finality_data;
+      if(!read_entry(block_package.trace_entry, traces) || !read_entry(block_package.state_entry, deltas))
+         return {};
+      if(block_package.is_v1_request && !read_entry(block_package.finality_entry, finality_data))
+         return {};
+
+      if(block_package.filters)
+         apply_filters(block_package, traces, deltas);
+      append_log_entry(body, traces);
+      append_log_entry(body, deltas);
+      if(block_package.is_v1_request)
+         append_log_entry(body, finality_data);
+      return body;
+   }
+
    boost::asio::awaitable<void> write_loop() {
       co_await readwrite_coro_exception_wrapper([this]() -> boost::asio::awaitable<void> {
          get_status_result_v1 current_status_result;
@@ -219,6 +343,10 @@ private:
             std::optional<ship_log_entry> trace_entry;
             std::optional<ship_log_entry> state_entry;
             std::optional<ship_log_entry> finality_entry;
+            std::optional<ship_log_entry> filter_index_entry;
+            std::shared_ptr<const block_filters>     filters;     //set for a get_blocks_request_v2 with filters
+            std::optional<block_result_cache::key_t> cache_key;   //set when the result can be shared through result_cache
+            block_result_cache::body_ptr             cached_body; //everything after head and last_irreversible
          };
 
          while(true) {
@@ -236,28 +364,45 @@ private:
                status_requests = std::move(self.queued_status_requests);
 
                //decide what block -- if any -- to send out
-               const chain::block_num_type latest_to_consider = self.current_blocks_request.irreversible_only ?
-                                                                self.controller.last_irreversible_block_num() : self.controller.head_block_num();
+               chain::block_num_type latest_to_consider = self.current_blocks_request.irreversible_only ?
+                                                          self.controller.last_irreversible_block_num() : self.controller.head_block_num();
+               //accepted blocks still being appended to the logs on the SHiP thread can't be sent yet, nor can the logged
+               // blocks they replace; after a fork switch the queue is not ascending
+               if(!self.unlogged_blocks.empty())
+                  latest_to_consider = std::min(latest_to_consider, std::ranges::min(self.unlogged_blocks) - 1);
                if(self.send_credits && self.next_block_cursor <= latest_to_consider && self.next_block_cursor < self.current_blocks_request.end_block_num) {
                   block_to_send.emplace( block_package{
                      .blocks_result_base = {
                         .head = {self.controller.head_block_num(), self.controller.head_block_id()},
                         .last_irreversible = {self.controller.last_irreversible_block_num(), self.controller.last_irreversible_block_id()}
                      },
-                     .is_v1_request = self.current_blocks_request_v1_finality.has_value()
+                     .is_v1_request = self.current_blocks_request_v1_finality.has_value(),
+                     .filters = self.current_blocks_request_filters
                   });
                   if(const std::optional<chain::block_id_type> this_block_id = self.get_block_id(self.next_block_cursor)) {
                      block_to_send->blocks_result_base.this_block  = {self.current_blocks_request.start_block_num, *this_block_id};
-                     if(const std::optional<chain::block_id_type> last_block_id = self.get_block_id(self.next_block_cursor - 1))
-                        block_to_send->blocks_result_base.prev_block = {self.next_block_cursor - 1, *last_block_id};
-                     if(chain::signed_block_ptr sbp = get_block(self.next_block_cursor); sbp && self.current_blocks_request.fetch_block)
-                         block_to_send->blocks_result_base.block = fc::raw::pack(*sbp);
-                     if(self.current_blocks_request.fetch_traces && self.trace_log)
-                        block_to_send->trace_entry = self.trace_log->get_entry(self.next_block_cursor);
-                     if(self.current_blocks_request.fetch_deltas && self.chain_state_log)
-                        block_to_send->state_entry = self.chain_state_log->get_entry(self.next_block_cursor);
-                     if(block_to_send->is_v1_request && *self.current_blocks_request_v1_finality && self.finality_data_log)
-                        block_to_send->finality_entry = self.finality_data_log->get_entry(self.next_block_cursor);
+                     //filtered results are specific to the session
+                     if(self.result_cache.enabled() && !block_to_send->filters) {
+                        block_to_send->cache_key   = block_result_cache::key_t{*this_block_id, self.result_cache_flags()};
+                        block_to_send->cached_body = self.result_cache.find(*block_to_send->cache_key);
+                     }
+                     //another session already sent this block with the same flags; nothing needs to be read
+                     if(!block_to_send->cached_body) {
+                        if(const std::optional<chain::block_id_type> last_block_id = self.get_block_id(self.next_block_cursor - 1))
+                           block_to_send->blocks_result_base.prev_block = {self.next_block_cursor - 1, *last_block_id};
+                        if(self.current_blocks_request.fetch_block) {
+                           if(chain::bytes packed_block = get_block(self.next_block_cursor); !packed_block.empty())
+                              block_to_send->blocks_result_base.block = std::move(packed_block);
+                        }
+                        if(self.current_blocks_request.fetch_traces && self.trace_log)
+                           block_to_send->trace_entry = self.trace_log->get_entry(self.next_block_cursor);
+                        if(self.current_blocks_request.fetch_deltas && self.chain_state_log)
+                           block_to_send->state_entry = self.chain_state_log->get_entry(self.next_block_cursor);
+                        if(block_to_send->is_v1_request && *self.current_blocks_request_v1_finality && self.finality_data_log)
+                           block_to_send->finality_entry = self.finality_data_log->get_entry(self.next_block_cursor);
+                        if(block_to_send->filters && self.filter_index_log && (block_to_send->trace_entry || block_to_send->state_entry))
+                           block_to_send->filter_index_entry = self.filter_index_log->get_entry(self.next_block_cursor);
+                     }
                   }
                   ++self.next_block_cursor;
                   --self.send_credits;
@@ -288,14 +433,37 @@ private:
                                                                         state_result(get_blocks_result_v1()).index() :
                                                                         state_result(get_blocks_result_v0()).index();
                co_await stream.async_write_some(false, boost::asio::buffer(fc::raw::pack(get_blocks_result_variant_index)));
-               co_await stream.async_write_some(false, boost::asio::buffer(fc::raw::pack(block_to_send->blocks_result_base)));
 
-               co_await write_log_entry(block_to_send->trace_entry);
-               co_await write_log_entry(block_to_send->state_entry);
-               if(block_to_send->is_v1_request)
-                  co_await write_log_entry(block_to_send->finality_entry);
+               if(block_to_send->cache_key) {
+                  //a session which woke up for the same block may have built the result since it was looked up
+                  if(!block_to_send->cached_body)
+                     block_to_send->cached_body = result_cache.find(*block_to_send->cache_key);
+                  //a result larger than the cache can hold is streamed from the logs below instead of being read into memory
+                  if(!block_to_send->cached_body) {
+                     if(std::optional<std::vector<char>> body = build_result_body(*block_to_send, result_cache.max_body_size()))
+                        block_to_send->cached_body = result_cache.insert(*block_to_send->cache_key, std::move(*body));
+                  }
+               }
 
-               co_await stream.async_write_some(true, boost::asio::const_buffer());
+               if(block_to_send->filters) {
+                  //the filtered entries are only known once the log entries are read, the whole result is built first
+                  const get_blocks_result_base& base = block_to_send->blocks_result_base;
+                  co_await stream.async_write_some(false, boost::asio::buffer(fc::raw::pack(std::make_pair(base.head, base.last_irreversible))));
+                  co_await stream.async_write_some(true, boost::asio::buffer(*build_result_body(*block_to_send)));
+               } else if(block_to_send->cached_body) {
+                  const get_blocks_result_base& base = block_to_send->blocks_result_base;
+                  co_await stream.async_write_some(false, boost::asio::buffer(fc::raw::pack(std::make_pair(base.head, base.last_irreversible))));
+                  co_await stream.async_write_some(true, boost::asio::buffer(*block_to_send->cached_body));
+               } else {
+                  co_await stream.async_write_some(false, boost::asio::buffer(fc::raw::pack(block_to_send->blocks_result_base)));
+
+                  co_await write_log_entry(block_to_send->trace_entry);
+                  co_await write_log_entry(block_to_send->state_entry);
+                  if(block_to_send->is_v1_request)
+                     co_await write_log_entry(block_to_send->finality_entry);
+
+                  co_await stream.async_write_some(true, boost::asio::const_buffer());
+               }
             }
          }
       });
@@ -314,6 +482,7 @@ private:
 
    get_blocks_request_v0             current_blocks_request;
    std::optional<bool>               current_blocks_request_v1_finality; //unset: current request is v0; set means v1; true/false is if finality requested
+   std::shared_ptr<const block_filters> current_blocks_request_filters; //set for a get_blocks_request_v2 with filters
    //current_blocks_request is modified with the current state; bind some more descriptive names to items frequently used
    uint32_t&                         send_credits = current_blocks_request.max_messages_in_flight;
    chain::block_num_type&            next_block_cursor = current_blocks_request.start_block_num;
@@ -322,6 +491,9 @@ private:
    std::optional<log_catalog>&       trace_log;
    std::optional<log_catalog>&       chain_state_log;
    std::optional<log_catalog>&       finality_data_log;
+   std::optional<log_catalog>&       filter_index_log;
+   block_result_cache&               result_cache;
+   const std::deque<chain::block_num_type>& unlogged_blocks; //blocks queued for the logs, in the order accepted
 
    GetBlockID                        get_block_id;
    GetBlock                          get_block;
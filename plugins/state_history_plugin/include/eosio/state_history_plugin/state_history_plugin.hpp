@@ -4,6 +4,9 @@
 #include <eosio/chain_plugin/chain_plugin.hpp>
 #include <eosio/state_history/types.hpp>
 #include <eosio/state_history/log.hpp>
+#include <eosio/state_history_plugin/block_result_cache.hpp>
+
+#include <deque>
 
 namespace eosio {
 
@@ -22,6 +25,18 @@ class state_history_plugin : public plugin<state_history_plugin> {
 
    void handle_sighup() override;
 
+   // for testing
+   state_history::block_result_cache::stats_t get_result_cache_stats() const;
+   // accepted blocks are held in the log queue until resumed, thread safe
+   void pause_log_appends();
+   void resume_log_appends();
+   // accepted blocks not yet appended to the logs, thread safe
+   uint32_t get_log_queue_size() const;
+   // must be called on the main thread
+   std::deque<chain::block_num_type> get_unlogged_blocks() const;
+   // [first, end) of the trace log, not thread safe while blocks are appended
+   std::pair<chain::block_num_type, chain::block_num_type> get_trace_log_block_range() const;
+
  private:
    unique_ptr<struct state_history_plugin_impl> my;
 };
@@ -3,6 +3,7 @@
 #include <eosio/chain/thread_utils.hpp>
 #include <eosio/resource_monitor_plugin/resource_monitor_plugin.hpp>
 #include <eosio/state_history/create_deltas.hpp>
+#include <eosio/state_history/filter.hpp>
 #include <eosio/state_history/log_config.hpp>
 #include <eosio/state_history/log_catalog.hpp>
 #include <eosio/state_history/serialization.hpp>
@@ -12,11 +13,13 @@
 
 #include <boost/asio/bind_executor.hpp>
 #include <boost/asio/ip/host_name.hpp>
+#include <boost/iostreams/device/back_inserter.hpp>
 
 #include <boost/asio/strand.hpp>
 #include <boost/beast/core.hpp>
 
 #include <boost/signals2/connection.hpp>
+#include <condition_variable>
 #include <mutex>
 
 #include <fc/network/listener.hpp>
@@ -51,6 +54,7 @@ private:
    std::optional<log_catalog>       trace_log;
    std::optional<log_catalog>       chain_state_log;
    std::optional<log_catalog>       finality_data_log;
+   std::optional<log_catalog>       filter_index_log;
    uint32_t                         first_available_block = 0;
    bool                             trace_debug_mode = false;
    std::optional<scoped_connection> applied_transaction_connection;
@@ -59,9 +63,32 @@ private:
    string                           endpoint_address;
    string                           unix_path;
    state_history::trace_converter   trace_converter;
+   block_result_cache               result_cache;
 
    named_thread_pool<struct ship>   thread_pool;
 
+   // log entries of an accepted block. They are packed on the main thread, which is the only one allowed to read the
+   // chainbase undo sessions and the cached traces, then compressed and appended to the logs on the SHiP thread.
+   struct captured_block {
+      block_id_type                    id;
+      block_id_type                    previous;
+      block_num_type                   block_num = 0;
+      std::optional<std::vector<char>> traces;
+      std::vector<trace_index_entry>   trace_index; // filled in when filter_index_log is enabled
+      std::optional<std::vector<char>> deltas;
+      std::optional<std::vector<char>> finality_data; // unset with a finality data log: clear the log
+   };
+
+   static constexpr uint32_t        max_blocks_in_log_queue = 8;
+   using log_strand_t               = boost::asio::strand<boost::asio::io_context::executor_type>;
+   std::optional<log_strand_t>      log_strand;      // orders the appends of captured blocks, set once the SHiP thread runs
+   std::deque<block_num_type>       unlogged_blocks; // queued to log_strand, in the order accepted; must only be touched by the main thread
+   std::mutex                       log_queue_mtx;
+   std::condition_variable          log_queue_cv;
+   uint32_t                         log_queue_size = 0; // guarded by log_queue_mtx
+   bool                             log_appends_paused = false; // guarded by log_queue_mtx, for testing
+   std::vector<captured_block>      paused_appends;             // guarded by log_queue_mtx, queued while paused
+
    struct connection_map_key_less {
       using is_transparent = void;
       template<typename L, typename R> bool operator()(const L& lhs, const R& rhs) const {
@@ -76,7 +103,36 @@ public:
    void plugin_startup();
    void plugin_shutdown();
 
-   std::optional<chain::block_id_type> get_block_id(block_num_type block_num) {
+   const block_result_cache& get_result_cache() const { return result_cache; }
+
+   // accepted blocks are queued but not appended until resumed, as if the SHiP thread was slow; thread safe
+   void pause_log_appends() {
+      std::lock_guard g(log_queue_mtx);
+      log_appends_paused = true;
+   }
+
+   void resume_log_appends() {
+      std::lock_guard g(log_queue_mtx);
+      log_appends_paused = false;
+      for(captured_block& captured : paused_appends)
+         post_captured_block(std::move(captured));
+      paused_appends.clear();
+   }
+
+   uint32_t get_log_queue_size() {
+      std::lock_guard g(log_queue_mtx);
+      return log_queue_size;
+   }
+
+   const std::deque<block_num_type>& get_unlogged_blocks() const { return unlogged_blocks; }
+
+   std::pair<block_num_type, block_num_type> get_trace_log_block_range() const {
+      return trace_log ? trace_log->block_range() : std::pair<block_num_type, block_num_type>{};
+   }
+
+   // only consults the logs so that it may be called from the SHiP thread while appending. The logs use it to check the
+   // previous block id of a new entry; the controller would always answer with the previous id given to that append.
+   std::optional<chain::block_id_type> get_log_block_id(block_num_type block_num) {
       if(trace_log) {
          if(std::optional<block_id_type> id = trace_log->get_block_id(block_num))
             return id;
@@ -89,6 +145,12 @@ public:
          if(std::optional<block_id_type> id = finality_data_log->get_block_id(block_num))
             return id;
       }
+      return {};
+   }
+
+   std::optional<chain::block_id_type> get_block_id(block_num_type block_num) {
+      if(std::optional<block_id_type> id = get_log_block_id(block_num))
+         return id;
       try {
          return chain_plug->chain().get_block_id_for_num(block_num);
       } catch(...) {
@@ -103,12 +165,12 @@ public:
       fc::create_listener<Protocol>(app().get_io_service(), _log, accept_timeout, address, "", [this](Protocol::socket&& socket) {
          catch_and_log([this, &socket]() {
             connections.emplace(new session(std::move(socket), boost::asio::make_strand(thread_pool.get_executor()), chain_plug->chain(),
-                                            trace_log, chain_state_log, finality_data_log,
+                                            trace_log, chain_state_log, finality_data_log, filter_index_log, result_cache, unlogged_blocks,
                                             [this](const chain::block_num_type block_num) {
                                                return get_block_id(block_num);
                                             },
                                             [this](const chain::block_num_type block_num) {
-                                               return chain_plug->chain().fetch_block_by_number(block_num);
+                                               return chain_plug->chain().fetch_serialized_block_by_number(block_num);
                                             },
                                             [this](session_base* conn) {
                                                boost::asio::post(app().get_io_service(), [conn, this]() {
@@ -136,10 +198,20 @@ public:
    }
 
    void on_accepted_block(const signed_block_ptr& block, const block_id_type& id) {
+      const block_num_type block_num = block->block_num();
+      if(!trace_log && !chain_state_log && !finality_data_log) {
+         blocks_logged(block_num);
+         return;
+      }
+
       try {
-         store_traces(block, id);
-         store_chain_state(id, block->previous, block->block_num());
-         store_finality_data(id, block->previous);
+         captured_block captured = capture_block(block, id);
+         if(log_strand) {
+            queue_captured_block(std::move(captured));
+            return;
+         }
+         //blocks applied before plugin_startup(), e.g. replayed blocks, are written right away
+         write_captured_block(captured);
       } catch(const fc::exception& e) {
          fc_elog(_log, "fc::exception: ${details}", ("details", e.to_detail_string()));
          // Both app().quit() and exception throwing are required. Without app().quit(),
@@ -152,28 +224,129 @@ public:
              "the process");
       }
 
+      blocks_logged(block_num);
+   }
+
+   //the logs contain block_num: wake the sessions
+   void blocks_logged(block_num_type block_num) {
       for(const std::unique_ptr<session_base>& c : connections)
-         c->block_applied(block->block_num());
+         c->block_applied(block_num);
    }
 
-   void on_block_start(uint32_t block_num) {
-      clear_caches();
+   template <typename F>
+   static std::vector<char> pack_to_buffer(F&& pack_to) {
+      std::vector<char> buffer;
+      bio::filtering_ostreambuf buf(bio::back_inserter(buffer));
+      pack_to(buf);
+      bio::close(buf);
+      return buffer;
    }
 
-   void clear_caches() {
-      trace_converter.cached_traces.clear();
-      trace_converter.onblock_trace.reset();
+   captured_block capture_block(const signed_block_ptr& block, const block_id_type& id) {
+      captured_block captured{.id = id, .previous = block->previous, .block_num = block->block_num()};
+
+      if(trace_log)
+         captured.traces = trace_converter.pack(trace_debug_mode, block, filter_index_log ? &captured.trace_index : nullptr);
+
+      if(chain_state_log) {
+         //a queued block will make the log non-empty
+         const bool fresh = unlogged_blocks.empty() && chain_state_log->empty();
+         if(fresh)
+            fc_ilog(_log, "Placing initial state in block ${n}", ("n", captured.block_num));
+         captured.deltas = pack_to_buffer([&](bio::filtering_ostreambuf& buf) {
+            pack_deltas(buf, chain_plug->chain().db(), fresh);
+         });
+      }
+
+      if(finality_data_log) {
+         if(std::optional<finality_data_t> finality_data = chain_plug->chain().head_finality_data())
+            captured.finality_data = fc::raw::pack(*finality_data);
+      }
+
+      return captured;
    }
 
-   void store_traces(const signed_block_ptr& block, const block_id_type& id) {
-      if(!trace_log)
+   void write_captured_block(const captured_block& captured) {
+      auto write_entry = [&](log_catalog& log, const std::vector<char>& entry) {
+         log.pack_and_write_entry(captured.id, captured.previous, [&entry](bio::filtering_ostreambuf& buf) {
+            buf.sputn(entry.data(), entry.size());
+         });
+      };
+
+      if(captured.traces)
+         write_entry(*trace_log, *captured.traces);
+      if(captured.deltas)
+         write_entry(*chain_state_log, *captured.deltas);
+      if(finality_data_log) {
+         if(captured.finality_data)
+            write_entry(*finality_data_log, *captured.finality_data);
+         else
+            finality_data_log->clear();
+      }
+      if(filter_index_log) {
+         block_filter_index index{.traces = captured.trace_index};
+         if(captured.deltas)
+            index.deltas = index_deltas(*captured.deltas);
+         write_entry(*filter_index_log, fc::raw::pack(index));
+      }
+   }
+
+   void queue_captured_block(captured_block&& captured) {
+      std::unique_lock g(log_queue_mtx);
+      //back-pressure: don't let the main thread run more than max_blocks_in_log_queue blocks ahead of the logs
+      log_queue_cv.wait(g, [this]() { return log_queue_size < max_blocks_in_log_queue; });
+      ++log_queue_size;
+      unlogged_blocks.push_back(captured.block_num);
+      if(log_appends_paused) {
+         paused_appends.push_back(std::move(captured));
          return;
+      }
+      g.unlock();
+      post_captured_block(std::move(captured));
+   }
 
-      trace_log->pack_and_write_entry(id, block->previous, [this, &block](bio::filtering_ostreambuf& buf) {
-         trace_converter.pack(buf, trace_debug_mode, block);
+   void post_captured_block(captured_block&& captured) {
+      boost::asio::post(*log_strand, [this, captured{std::move(captured)}]() {
+         try {
+            write_captured_block(captured);
+         } catch(const fc::exception& e) {
+            //the block is already committed, all that can be done is to stop before the logs fall further behind
+            fc_elog(_log, "State history encountered an Error which it cannot recover from, block ${n}: ${details}",
+                    ("n", captured.block_num)("details", e.to_detail_string()));
+            app().quit();
+         } catch(const std::exception& e) {
+            fc_elog(_log, "State history encountered an Error which it cannot recover from, block ${n}: ${e}",
+                    ("n", captured.block_num)("e", e.what()));
+            app().quit();
+         }
+
+         {
+            std::lock_guard g(log_queue_mtx);
+            --log_queue_size;
+         }
+         log_queue_cv.notify_all();
+
+         boost::asio::post(app().get_io_service(), [this, block_num = captured.block_num]() {
+            unlogged_blocks.pop_front();
+            blocks_logged(block_num);
+         });
       });
    }
 
+   void wait_for_log_queue() {
+      std::unique_lock g(log_queue_mtx);
+      log_queue_cv.wait(g, [this]() { return log_queue_size == 0; });
+   }
+
+   void on_block_start(uint32_t block_num) {
+      clear_caches();
+   }
+
+   void clear_caches() {
+      trace_converter.cached_traces.clear();
+      trace_converter.onblock_trace.reset();
+   }
+
    void store_chain_state(const block_id_type& id, const block_id_type& previous_id, uint32_t block_num) {
       if(!chain_state_log)
          return;
@@ -185,22 +358,6 @@ public:
          pack_deltas(buf, chain_plug->chain().db(), fresh);
       });
    } // store_chain_state
-
-   void store_finality_data(const block_id_type& id, const block_id_type& previous_id) {
-      if(!finality_data_log)
-         return;
-
-      std::optional<finality_data_t> finality_data = chain_plug->chain().head_finality_data();
-      if(!finality_data.has_value()) {
-         finality_data_log->clear();
-         return;
-      }
-
-      finality_data_log->pack_and_write_entry(id, previous_id, [finality_data](bio::filtering_ostreambuf& buf) {
-         fc::datastream<boost::iostreams::filtering_ostreambuf&> ds{buf};
-         fc::raw::pack(ds, *finality_data);
-      });
-   }
 }; // state_history_plugin_impl
 
 state_history_plugin::state_history_plugin()
@@ -238,6 +395,13 @@ void state_history_plugin::set_program_options(options_description& cli, options
            "the path (relative to data-dir) to create a unix socket upon which to listen for incoming connections.");
    options("trace-history-debug-mode", bpo::bool_switch()->default_value(false), "enable debug mode for trace history");
    options("state-history-log-retain-blocks", bpo::value<uint32_t>(), "if set, periodically prune the state history files to store only configured number of most recent blocks");
+   options("state-history-result-cache-size-mb", bpo::value<uint32_t>()->default_value(256),
+           "size in MiB of the cache of serialized get_blocks results of recent blocks shared by all state history connections, "
+           "so that clients following the head cost one read of the logs per block. 0 disables the cache.");
+   options("state-history-filter-index", bpo::bool_switch()->default_value(false),
+           "keep an index of the transaction traces and contract table rows of each block, so that the trace and delta filters "
+           "of get_blocks_request_v2 are applied without parsing the logged traces. Required by trace filters, requests with "
+           "trace filters are rejected without it.");
 }
 
 void state_history_plugin_impl::plugin_initialize(const variables_map& options) {
@@ -273,6 +437,7 @@ void state_history_plugin_impl::plugin_initialize(const variables_map& options)
          resmon_plugin->monitor_directory(state_history_dir);
 
       endpoint_address = options.at("state-history-endpoint").as<string>();
+      result_cache.set_max_bytes(uint64_t(options.at("state-history-result-cache-size-mb").as<uint32_t>()) * 1024 * 1024);
 
       if(options.count("state-history-unix-socket-path")) {
          std::filesystem::path sock_path = options.at("state-history-unix-socket-path").as<string>();
@@ -317,11 +482,13 @@ void state_history_plugin_impl::plugin_initialize(const variables_map& options)
       }
 
       if(options.at("trace-history").as<bool>())
-         trace_log.emplace(state_history_dir, ship_log_conf, "trace_history", [this](chain::block_num_type bn) {return get_block_id(bn);});
+         trace_log.emplace(state_history_dir, ship_log_conf, "trace_history", [this](chain::block_num_type bn) {return get_log_block_id(bn);});
       if(options.at("chain-state-history").as<bool>())
-         chain_state_log.emplace(state_history_dir, ship_log_conf, "chain_state_history", [this](chain::block_num_type bn) {return get_block_id(bn);});
+         chain_state_log.emplace(state_history_dir, ship_log_conf, "chain_state_history", [this](chain::block_num_type bn) {return get_log_block_id(bn);});
       if(options.at("finality-data-history").as<bool>())
-         finality_data_log.emplace(state_history_dir, ship_log_conf, "finality_data_history", [this](chain::block_num_type bn) {return get_block_id(bn);});
+         finality_data_log.emplace(state_history_dir, ship_log_conf, "finality_data_history", [this](chain::block_num_type bn) {return get_log_block_id(bn);});
+      if(options.at("state-history-filter-index").as<bool>() && (trace_log || chain_state_log))
+         filter_index_log.emplace(state_history_dir, ship_log_conf, "filter_index_history", [this](chain::block_num_type bn) {return get_log_block_id(bn);});
    }
    FC_LOG_AND_RETHROW()
 } // state_history_plugin::plugin_initialize
@@ -363,6 +530,7 @@ void state_history_plugin_impl::plugin_startup() {
          fc_elog( _log, "Exception in SHiP thread pool, exiting: ${e}", ("e", e.to_detail_string()) );
          app().quit();
       });
+      log_strand.emplace(boost::asio::make_strand(thread_pool.get_executor()));
    } catch(std::exception& ex) {
       appbase::app().quit();
    }
@@ -376,6 +544,8 @@ void state_history_plugin_impl::plugin_shutdown() {
    applied_transaction_connection.reset();
    accepted_block_connection.reset();
    block_start_connection.reset();
+   resume_log_appends();
+   wait_for_log_queue(); //don't drop blocks already accepted
    thread_pool.stop();
 }
 
@@ -387,4 +557,28 @@ void state_history_plugin::handle_sighup() {
    fc::logger::update(logger_name, _log);
 }
 
+block_result_cache::stats_t state_history_plugin::get_result_cache_stats() const {
+   return my->get_result_cache().get_stats();
+}
+
+void state_history_plugin::pause_log_appends() {
+   my->pause_log_appends();
+}
+
+void state_history_plugin::resume_log_appends() {
+   my->resume_log_appends();
+}
+
+uint32_t state_history_plugin::get_log_queue_size() const {
+   return my->get_log_queue_size();
+}
+
+std::deque<chain::block_num_type> state_history_plugin::get_unlogged_blocks() const {
+   return my->get_unlogged_blocks();
+}
+
+std::pair<chain::block_num_type, chain::block_num_type> state_history_plugin::get_trace_log_block_range() const {
+   return my->get_trace_log_block_range();
+}
+
 } // namespace eosio
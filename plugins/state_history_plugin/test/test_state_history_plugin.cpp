@@ -0,0 +1,281 @@
+#include <boost/test/unit_test.hpp>
+
+#include <eosio/state_history_plugin/state_history_plugin.hpp>
+#include <eosio/producer_plugin/producer_plugin.hpp>
+
+#include <eosio/state_history/types.hpp>
+
+#include <eosio/chain/application.hpp>
+
+#include <fc/filesystem.hpp>
+#include <fc/io/raw.hpp>
+
+#include <boost/asio/local/stream_protocol.hpp>
+#include <boost/beast/core/flat_buffer.hpp>
+#include <boost/beast/websocket.hpp>
+
+#include <deque>
+#include <future>
+#include <thread>
+
+namespace {
+
+using namespace eosio;
+using namespace eosio::chain;
+using namespace eosio::state_history;
+
+// nodeos with a producer and state_history_plugin listening on a unix socket, running on a thread of its own
+struct ship_app {
+   fc::temp_directory    temp;
+   appbase::scoped_app   app;
+   std::thread           app_thread;
+   chain_plugin*         chain_plug = nullptr;
+   state_history_plugin* ship_plug  = nullptr;
+
+   explicit ship_app(const std::vector<std::string>& extra_args = {}) {
+      const std::string temp_dir = temp.path().string();
+      std::vector<std::string> args = {"test", "--data-dir", temp_dir, "--config-dir", temp_dir, "-p", "eosio", "-e",
+                                       "--trace-history", "--chain-state-history", "--state-history-endpoint", "",
+                                       "--state-history-unix-socket-path", "ship.sock"};
+      args.insert(args.end(), extra_args.begin(), extra_args.end());
+
+      std::promise<std::tuple<chain_plugin*, state_history_plugin*>> plugin_promise;
+      std::future<std::tuple<chain_plugin*, state_history_plugin*>> plugin_fut = plugin_promise.get_future();
+      app_thread = std::thread([&, args]() {
+         try {
+            std::vector<const char*> argv;
+            for (const std::string& a : args)
+               argv.push_back(a.c_str());
+            app->initialize<chain_plugin, producer_plugin, state_history_plugin>(argv.size(), (char**)argv.data());
+            app->startup();
+            plugin_promise.set_value({app->find_plugin<chain_plugin>(), app->find_plugin<state_history_plugin>()});
+            app->exec();
+            return;
+         } FC_LOG_AND_DROP()
+         BOOST_CHECK(!"app threw exception see logged error");
+      });
+      std::tie(chain_plug, ship_plug) = plugin_fut.get();
+   }
+
+   ~ship_app() { quit(); }
+
+   void quit() {
+      if (app_thread.joinable()) {
+         app->quit();
+         app_thread.join();
+      }
+   }
+
+   std::filesystem::path socket_path() const { return temp.path() / "ship.sock"; }
+
+   template <typename F>
+   auto run_on_main_thread(F&& f) {
+      std::packaged_task<std::invoke_result_t<F>()> task(std::forward<F>(f));
+      auto fut = task.get_future();
+      app->post(priority::high, [&task]() { task(); });
+      return fut.get();
+   }
+
+   template <typename F>
+   void wait_until(F&& f) {
+      const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(30);
+      while(!f()) {
+         BOOST_REQUIRE(std::chrono::steady_clock::now() < deadline);
+         std::this_thread::sleep_for(std::chrono::milliseconds(50));
+      }
+   }
+
+   void wait_for_head(uint32_t block_num) {
+      wait_until([&]() { return run_on_main_thread([this]() { return chain_plug->chain().head_block_num(); }) >= block_num; });
+   }
+};
+
+// websocket client of a SHiP session
+struct ship_client {
+   boost::asio::io_context ctx;
+   boost::beast::websocket::stream<boost::asio::local::stream_protocol::socket> stream{ctx};
+
+   struct read_op {
+      boost::beast::flat_buffer buffer;
+      bool                      done = false;
+   };
+   std::optional<read_op> pending_read;
+
+   explicit ship_client(const std::filesystem::path& socket_path) {
+      stream.next_layer().connect(boost::asio::local::stream_protocol::endpoint(socket_path.string()));
+      stream.handshake("", "/");
+      boost::beast::flat_buffer abi;
+      stream.read(abi);
+      stream.binary(true);
+   }
+
+   void send(const state_request& req) {
+      stream.write(boost::asio::buffer(fc::raw::pack(req)));
+   }
+
+   state_result read() {
+      boost::beast::flat_buffer b;
+      stream.read(b);
+      return fc::raw::unpack<state_result>(static_cast<const char*>(b.cdata().data()), b.size());
+   }
+
+   // false if no result arrived within timeout; the read stays pending for the next call
+   bool read_for(state_result& result, std::chrono::milliseconds timeout) {
+      if(!pending_read) {
+         pending_read.emplace();
+         stream.async_read(pending_read->buffer, [this](boost::beast::error_code ec, size_t) {
+            BOOST_REQUIRE(!ec);
+            pending_read->done = true;
+         });
+      }
+      ctx.restart();
+      ctx.run_for(timeout);
+      if(!pending_read->done)
+         return false;
+      result = fc::raw::unpack<state_result>(static_cast<const char*>(pending_read->buffer.cdata().data()), pending_read->buffer.size());
+      pending_read.reset();
+      return true;
+   }
+
+   get_status_result_v1 get_status() {
+      send(get_status_request_v1{});
+      return std::get<get_status_result_v1>(read());
+   }
+
+   // everything of the results but head and last_irreversible, which depend on when a block is sent
+   std::vector<std::vector<char>> get_blocks(const get_blocks_request_v0& req) {
+      send(req);
+      std::vector<std::vector<char>> results;
+      for (uint32_t n = req.start_block_num; n < req.end_block_num; ++n) {
+         get_blocks_result_v0 r = std::get<get_blocks_result_v0>(read());
+         BOOST_REQUIRE(r.this_block);
+         BOOST_REQUIRE_EQUAL(r.this_block->block_num, n);
+         results.push_back(fc::raw::pack(std::make_tuple(r.this_block, r.prev_block, r.block, r.traces, r.deltas)));
+      }
+      return results;
+   }
+};
+
+} // anonymous namespace
+
+BOOST_AUTO_TEST_SUITE(state_history_plugin_tests)
+
+BOOST_AUTO_TEST_CASE(result_cache_shared_between_sessions) try {
+   ship_app ship;
+   ship.wait_for_head(10);
+
+   ship_client first(ship.socket_path());
+   const get_status_result_v1 status = first.get_status();
+   const uint32_t start = std::max(status.trace_begin_block, status.chain_state_begin_block);
+   BOOST_REQUIRE_GT(start, 0u);
+
+   get_blocks_request_v0 req{.start_block_num = start, .end_block_num = start + 5, .max_messages_in_flight = 100,
+                             .fetch_block = true, .fetch_traces = true, .fetch_deltas = true};
+
+   // the first session builds the results from the logs
+   const std::vector<std::vector<char>> first_results = first.get_blocks(req);
+   block_result_cache::stats_t stats = ship.ship_plug->get_result_cache_stats();
+   BOOST_CHECK_EQUAL(stats.hits, 0u);
+   BOOST_CHECK_EQUAL(stats.inserted, 5u);
+
+   // a second session with the same request is served from the cache
+   ship_client second(ship.socket_path());
+   const std::vector<std::vector<char>> second_results = second.get_blocks(req);
+   BOOST_CHECK(second_results == first_results);
+   stats = ship.ship_plug->get_result_cache_stats();
+   BOOST_CHECK_EQUAL(stats.hits, 5u);
+   BOOST_CHECK_EQUAL(stats.inserted, 5u);
+
+   // other fetch flags are a different result
+   req.fetch_block = false;
+   const std::vector<std::vector<char>> without_block = second.get_blocks(req);
+   BOOST_CHECK(without_block != first_results);
+   stats = ship.ship_plug->get_result_cache_stats();
+   BOOST_CHECK_EQUAL(stats.hits, 5u);
+   BOOST_CHECK_EQUAL(stats.inserted, 10u);
+
+   first.get_blocks(req);
+   stats = ship.ship_plug->get_result_cache_stats();
+   BOOST_CHECK_EQUAL(stats.hits, 10u);
+   BOOST_CHECK_EQUAL(stats.inserted, 10u);
+} FC_LOG_AND_RETHROW()
+
+BOOST_AUTO_TEST_CASE(result_cache_disabled) try {
+   ship_app ship({"--state-history-result-cache-size-mb", "0"});
+   ship.wait_for_head(10);
+
+   ship_client first(ship.socket_path());
+   const get_status_result_v1 status = first.get_status();
+   const uint32_t start = std::max(status.trace_begin_block, status.chain_state_begin_block);
+   get_blocks_request_v0 req{.start_block_num = start, .end_block_num = start + 5, .max_messages_in_flight = 100,
+                             .fetch_block = true, .fetch_traces = true, .fetch_deltas = true};
+
+   // streamed from the logs, same results as through the cache
+   ship_client second(ship.socket_path());
+   BOOST_CHECK(first.get_blocks(req) == second.get_blocks(req));
+   const block_result_cache::stats_t stats = ship.ship_plug->get_result_cache_stats();
+   BOOST_CHECK_EQUAL(stats.hits, 0u);
+   BOOST_CHECK_EQUAL(stats.inserted, 0u);
+} FC_LOG_AND_RETHROW()
+
+// the main thread stops accepting blocks once max_blocks_in_log_queue wait for the logs
+BOOST_AUTO_TEST_CASE(log_queue_back_pressure) try {
+   ship_app ship;
+   ship.wait_for_head(3);
+
+   ship.ship_plug->pause_log_appends();
+   ship.wait_until([&]() { return ship.ship_plug->get_log_queue_size() == 8; });
+
+   std::packaged_task<void()> main_thread_task([]() {});
+   std::future<void> main_thread_done = main_thread_task.get_future();
+   ship.app->post(priority::high, [&main_thread_task]() { main_thread_task(); });
+   BOOST_CHECK(main_thread_done.wait_for(std::chrono::milliseconds(1500)) == std::future_status::timeout);
+   BOOST_CHECK_EQUAL(ship.ship_plug->get_log_queue_size(), 8u);
+
+   ship.ship_plug->resume_log_appends();
+   BOOST_CHECK(main_thread_done.wait_for(std::chrono::seconds(30)) == std::future_status::ready);
+   ship.wait_until([&]() { return ship.ship_plug->get_log_queue_size() < 8; });
+} FC_LOG_AND_RETHROW()
+
+// a session does not send accepted blocks before they are in the logs
+BOOST_AUTO_TEST_CASE(unlogged_blocks_held_back) try {
+   ship_app ship;
+   ship.wait_for_head(3);
+
+   ship.ship_plug->pause_log_appends();
+   ship.wait_until([&]() { return ship.ship_plug->get_log_queue_size() >= 2; });
+   const std::deque<block_num_type> unlogged = ship.run_on_main_thread([&]() { return ship.ship_plug->get_unlogged_blocks(); });
+   BOOST_REQUIRE_GE(unlogged.size(), 2u);
+
+   ship_client client(ship.socket_path());
+   client.send(get_blocks_request_v0{.start_block_num = unlogged.front(), .end_block_num = unlogged.front() + 1,
+                                     .max_messages_in_flight = 1, .fetch_block = true, .fetch_traces = true, .fetch_deltas = true});
+   state_result result;
+   BOOST_CHECK(!client.read_for(result, std::chrono::milliseconds(1500)));
+
+   ship.ship_plug->resume_log_appends();
+   BOOST_REQUIRE(client.read_for(result, std::chrono::seconds(30)));
+   const get_blocks_result_v0& blocks_result = std::get<get_blocks_result_v0>(result);
+   BOOST_REQUIRE(blocks_result.this_block);
+   BOOST_CHECK_EQUAL(blocks_result.this_block->block_num, unlogged.front());
+   BOOST_CHECK(blocks_result.traces);
+   BOOST_CHECK(blocks_result.deltas);
+} FC_LOG_AND_RETHROW()
+
+// blocks accepted before shutdown are appended to the logs before the SHiP thread stops
+BOOST_AUTO_TEST_CASE(shutdown_drains_log_queue) try {
+   ship_app ship;
+   ship.wait_for_head(3);
+
+   ship.ship_plug->pause_log_appends();
+   ship.wait_until([&]() { return ship.ship_plug->get_log_queue_size() >= 3; });
+   const std::deque<block_num_type> unlogged = ship.run_on_main_thread([&]() { return ship.ship_plug->get_unlogged_blocks(); });
+   BOOST_REQUIRE(!unlogged.empty());
+
+   // still paused, plugin_shutdown() resumes and waits for the queued appends
+   ship.quit();
+   BOOST_CHECK_EQUAL(ship.ship_plug->get_log_queue_size(), 0u);
+   BOOST_CHECK_GT(ship.ship_plug->get_trace_log_block_range().second, unlogged.back());
+} FC_LOG_AND_RETHROW()
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace eosio::trace_api {
+
+   /**
+    * Least recently used cache of the JSON responses for irreversible blocks, which never change once rendered.
+    *
+    * The least recently used entries are evicted once the total size exceeds max_bytes; a max_bytes of 0 disables
+    * the cache.  Thread safe, since requests are served from all of the http threads.
+    */
+   class block_json_cache {
+   public:
+      using json_ptr = std::shared_ptr<const std::string>;
+
+      explicit block_json_cache( size_t max_bytes = 0 )
+      :max_bytes(max_bytes)
+      {}
+
+      bool enabled() const {
+         return max_bytes > 0;
+      }
+
+      /// @return the cached JSON for block_num, or nullptr
+      json_ptr find( uint32_t block_num ) {
+         std::lock_guard g(mtx);
+         auto itr = entries.find(block_num);
+         if (itr == entries.end()) {
+            return {};
+         }
+         lru.splice(lru.begin(), lru, itr->second);
+         return itr->second->json;
+      }
+
+      void insert( uint32_t block_num, const json_ptr& json ) {
+         std::lock_guard g(mtx);
+         if (json->size() > max_bytes || entries.count(block_num)) {
+            return;
+         }
+         lru.push_front(entry{ .block_num = block_num, .json = json });
+         entries.emplace(block_num, lru.begin());
+         total_bytes += json->size();
+         while (total_bytes > max_bytes) {
+            const auto& oldest = lru.back();
+            total_bytes -= oldest.json->size();
+            entries.erase(oldest.block_num);
+            lru.pop_back();
+         }
+      }
+
+   private:
+      struct entry {
+         uint32_t block_num = 0;
+         json_ptr json;
+      };
+
+      std::mutex                                                  mtx;
+      const size_t                                                max_bytes;
+      size_t                                                      total_bytes = 0;
+      std::list<entry>                                            lru; // most recently used first
+      std::unordered_map<uint32_t, std::list<entry>::iterator>    entries;
+   };
+
+}
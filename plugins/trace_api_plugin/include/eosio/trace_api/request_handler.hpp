@@ -4,6 +4,7 @@
 #include <eosio/trace_api/metadata_log.hpp>
 #include <eosio/trace_api/data_log.hpp>
 #include <eosio/trace_api/common.hpp>
+#include <eosio/trace_api/block_json_cache.hpp>
 
 namespace eosio::trace_api {
    using data_handler_function = std::function<std::tuple<fc::variant, std::optional<fc::variant>>( const std::variant<action_trace_v0, action_trace_v1> & action_trace_t)>;
@@ -12,16 +13,20 @@ namespace eosio::trace_api {
       class response_formatter {
       public:
          static fc::variant process_block( const data_log_entry& trace, bool irreversible, const data_handler_function& data_handler );
+
+         /// the JSON of process_block(), written directly instead of through a variant
+         static std::string process_block_json( const data_log_entry& trace, bool irreversible, const data_handler_function& data_handler );
       };
    }
 
    template<typename LogfileProvider, typename DataHandlerProvider>
    class request_handler {
    public:
-      request_handler(LogfileProvider&& logfile_provider, DataHandlerProvider&& data_handler_provider, log_handler log)
+      request_handler(LogfileProvider&& logfile_provider, DataHandlerProvider&& data_handler_provider, log_handler log, size_t json_cache_max_bytes = 0)
       :logfile_provider(std::move(logfile_provider))
       ,data_handler_provider(std::move(data_handler_provider))
       ,_log(log)
+      ,json_cache(json_cache_max_bytes)
       {
          _log("Constructed request_handler");
       }
@@ -42,13 +47,35 @@ namespace eosio::trace_api {
             return {};
          }
 
-         auto data_handler = [this](const auto& action) -> std::tuple<fc::variant, std::optional<fc::variant>> {
-            return std::visit([&](const auto& action_trace_t) {
-               return data_handler_provider.serialize_to_variant(action_trace_t);
-            }, action);
-         };
+         return detail::response_formatter::process_block(std::get<0>(*data), std::get<1>(*data), make_data_handler());
+      }
+
+      /**
+       * Fetch the trace for a given block height rendered as JSON, the same JSON get_block_trace() converts to.
+       * Irreversible blocks are served from, and added to, the JSON cache.
+       *
+       * @param block_height - the height of the block whose trace is requested
+       * @return the JSON of the trace for the given block height if it exists, nullptr otherwise.
+       * @throws bad_data_exception when there are issues with the underlying data preventing processing.
+       */
+      block_json_cache::json_ptr get_block_trace_json( uint32_t block_height ) {
+         if (auto json = json_cache.find(block_height)) {
+            return json;
+         }
 
-         return detail::response_formatter::process_block(std::get<0>(*data), std::get<1>(*data), data_handler);
+         auto data = logfile_provider.get_block(block_height);
+         if (!data) {
+            _log("No block found at block height " + std::to_string(block_height) );
+            return {};
+         }
+
+         const bool irreversible = std::get<1>(*data);
+         auto json = std::make_shared<const std::string>(
+            detail::response_formatter::process_block_json(std::get<0>(*data), irreversible, make_data_handler()));
+         if (irreversible && json_cache.enabled()) {
+            json_cache.insert(block_height, json);
+         }
+         return json;
       }
 
       /**
@@ -90,9 +117,18 @@ namespace eosio::trace_api {
       }
 
    private:
+      data_handler_function make_data_handler() {
+         return [this](const auto& action) -> std::tuple<fc::variant, std::optional<fc::variant>> {
+            return std::visit([&](const auto& action_trace_t) {
+               return data_handler_provider.serialize_to_variant(action_trace_t);
+            }, action);
+         };
+      }
+
       LogfileProvider logfile_provider;
       DataHandlerProvider data_handler_provider;
       log_handler _log;
+      block_json_cache json_cache;
    };
 
 
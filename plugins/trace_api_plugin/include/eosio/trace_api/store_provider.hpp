@@ -1,6 +1,8 @@
 #pragma once
 
 #include <ios>
+#include <map>
+#include <memory>
 #include <thread>
 #include <mutex>
 #include <condition_variable>
@@ -96,6 +98,28 @@ namespace eosio::trace_api {
          uint32_t version = 0;
       };
 
+      /**
+       * Header of the block offset table of an irreversible slice.  It is followed by num_blocks 64 bit offsets into
+       * the slice's trace file, one per block number starting at first_block, all bits set for a missing block.
+       */
+      struct block_offsets_header {
+         uint32_t version     = 0;
+         uint32_t first_block = 0;
+         uint32_t num_blocks  = 0;
+      };
+
+      /**
+       * Header of the trx id index of an irreversible slice.  It is followed by a Bloom filter of bloom_words 64 bit
+       * words, the fence pointers (the first id of every fence_stride entries) and the num_entries entries, each a
+       * transaction id and the number of the block containing it, sorted by transaction id.
+       */
+      struct trx_id_index_header {
+         uint32_t version      = 0;
+         uint32_t num_entries  = 0;
+         uint32_t bloom_words  = 0;
+         uint32_t fence_stride = 0;
+      };
+
       enum class open_state { read /*read from front to back*/, write /*write to end of file*/ };
       slice_directory(const std::filesystem::path& slice_dir, uint32_t width, std::optional<uint32_t> minimum_irreversible_history_blocks,
                       std::optional<uint32_t> minimum_uncompressed_irreversible_history_blocks, size_t compression_seek_point_stride);
@@ -201,6 +225,45 @@ namespace eosio::trace_api {
        */
       bool find_trx_id_slice(uint32_t slice_number, open_state state, fc::cfile& trx_id_file, bool open_file = true) const;
 
+      /**
+       * Create the block offset table of a slice from its index file.  Only valid once all the blocks of the slice
+       * are irreversible.
+       *
+       * @param slice_number : slice number of the requested slice file
+       * @return true if the table was created, false if the slice has no index file
+       */
+      bool create_block_offsets(uint32_t slice_number) const;
+
+      /**
+       * Look up the offset of a block in the trace file using the block offset table of its slice
+       *
+       * @param block_height : height of the requested block
+       * @param offset : set to the offset of the block in the trace file if the slice contains it, reset otherwise
+       * @return true if the slice has a block offset table, if not offset is left unchanged and the index file
+       *         has to be scanned instead
+       */
+      bool find_block_offset(uint32_t block_height, std::optional<uint64_t>& offset) const;
+
+      /**
+       * Create the trx id index of a slice from its trx id file.  Only valid once all the blocks of the slice are
+       * irreversible, since the trx id file is not read again after that.
+       *
+       * @param slice_number : slice number of the requested slice file
+       * @return true if the index was created, false if the slice has no trx id file
+       */
+      bool create_trx_id_index(uint32_t slice_number) const;
+
+      /**
+       * Look up a transaction id in the trx id index of a slice
+       *
+       * @param slice_number : slice number of the requested slice file
+       * @param trx_id : the transaction id to look up
+       * @param block_num : set to the number of the block containing trx_id if it is in the index, reset otherwise
+       * @return true if the slice has a trx id index, if not block_num is left unchanged and the trx id file
+       *         has to be scanned instead
+       */
+      bool find_trx_id_in_index(uint32_t slice_number, const chain::transaction_id_type& trx_id, get_block_n& block_num) const;
+
       /**
        * set the LIB for maintenance
        * @param lib
@@ -219,6 +282,7 @@ namespace eosio::trace_api {
 
       /**
        * Cleans up all slices that are no longer needed to maintain the minimum number of blocks past lib
+       * Indexes the block offsets and trx ids of all slices that are irreversible
        * Compresses up all slices that can be compressed
        *
        * @param lib : block number of the current lib
@@ -230,6 +294,21 @@ namespace eosio::trace_api {
       // the slice_prefix and slice_number, but will only be opened if found
       bool find_slice(const char* slice_prefix, uint32_t slice_number, fc::cfile& slice_file, bool open_file) const;
 
+      std::filesystem::path block_offsets_path(uint32_t slice_number) const;
+
+      std::filesystem::path trx_id_index_path(uint32_t slice_number) const;
+
+      // read only mapping of a lookup file of an irreversible slice, which does not change once created
+      struct mapped_slice_file;
+      using mapped_slice_file_ptr = std::shared_ptr<const mapped_slice_file>;
+
+      // returns the mapping of the lookup file at path, mapped on first use and kept until unmap_slice_file(), or
+      // nullptr if there is no such file
+      mapped_slice_file_ptr map_slice_file(const std::filesystem::path& path) const;
+
+      // drops the mapping of the lookup file at path, lookups in progress keep theirs
+      void unmap_slice_file(const std::filesystem::path& path) const;
+
       // take an index file that is initialized to a file and open it and write its header
       void create_new_index_slice_file(fc::cfile& index_file) const;
 
@@ -244,10 +323,14 @@ namespace eosio::trace_api {
       const uint32_t _width;
       const std::optional<uint32_t> _minimum_irreversible_history_blocks;
       std::optional<uint32_t> _last_cleaned_up_slice;
+      std::optional<uint32_t> _last_indexed_slice;
       const std::optional<uint32_t> _minimum_uncompressed_irreversible_history_blocks;
       std::optional<uint32_t> _last_compressed_slice;
       const size_t _compression_seek_point_stride;
 
+      mutable std::mutex _mapped_files_mtx;
+      mutable std::map<std::filesystem::path, mapped_slice_file_ptr> _mapped_files;
+
       std::mutex _maintenance_mtx;
       std::condition_variable _maintenance_condition;
       std::thread _maintenance_thread;
@@ -378,3 +461,5 @@ namespace eosio::trace_api {
 }
 
 FC_REFLECT(eosio::trace_api::slice_directory::index_header, (version))
+FC_REFLECT(eosio::trace_api::slice_directory::block_offsets_header, (version)(first_block)(num_blocks))
+FC_REFLECT(eosio::trace_api::slice_directory::trx_id_index_header, (version)(num_entries)(bloom_words)(fence_stride))
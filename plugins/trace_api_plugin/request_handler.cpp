@@ -3,6 +3,7 @@
 #include <algorithm>
 
 #include <fc/variant_object.hpp>
+#include <fc/io/json.hpp>
 
 namespace {
    using namespace eosio::trace_api;
@@ -114,9 +115,206 @@ namespace {
 
       return result;
    }
+
+   /**
+    * Appends JSON to a buffer as it goes, producing the same text fc::json::to_string produces for the equivalent
+    * variant, so that a response is rendered without building the variant first
+    */
+   class json_writer {
+   public:
+      explicit json_writer( std::string& out )
+      :out(out)
+      {}
+
+      json_writer& begin_object() { separate(); out += '{'; need_separator = false; return *this; }
+      json_writer& end_object()   { out += '}'; need_separator = true; return *this; }
+      json_writer& begin_array()  { separate(); out += '['; need_separator = false; return *this; }
+      json_writer& end_array()    { out += ']'; need_separator = true; return *this; }
+
+      json_writer& key( std::string_view k ) {
+         separate();
+         append_string(k);
+         out += ':';
+         need_separator = false;
+         return *this;
+      }
+
+      json_writer& value( std::string_view v ) {
+         separate();
+         append_string(v);
+         need_separator = true;
+         return *this;
+      }
+
+      json_writer& value( const char* v ) {
+         return value(std::string_view(v));
+      }
+
+      json_writer& value( uint64_t v ) {
+         separate();
+         // fc::json stringifies the integers a javascript number can not hold
+         if (v > 0xffffffff) {
+            out += '"';
+            out += std::to_string(v);
+            out += '"';
+         } else {
+            out += std::to_string(v);
+         }
+         need_separator = true;
+         return *this;
+      }
+
+      json_writer& value( const fc::variant& v ) {
+         separate();
+         out += fc::json::to_string(v, fc::json::yield_function_t{});
+         need_separator = true;
+         return *this;
+      }
+
+      template<typename T>
+      json_writer& member( std::string_view k, const T& v ) {
+         key(k);
+         if constexpr (std::is_same_v<T, std::string> || std::is_same_v<T, std::string_view> || std::is_same_v<T, const char*>) {
+            return value(std::string_view(v));
+         } else if constexpr (std::is_unsigned_v<T>) {
+            return value(static_cast<uint64_t>(v));
+         } else {
+            return value(fc::variant(v));
+         }
+      }
+
+   private:
+      void separate() {
+         if (need_separator) {
+            out += ',';
+         }
+      }
+
+      void append_string( std::string_view s ) {
+         out += '"';
+         out += fc::escape_string(s, fc::json::yield_function_t{});
+         out += '"';
+      }
+
+      std::string& out;
+      bool need_separator = false;
+   };
+
+   void write_authorizations(json_writer& w, const std::vector<authorization_trace_v0>& authorizations) {
+      w.begin_array();
+      for ( const auto& a: authorizations) {
+         w.begin_object()
+            .member("account", a.account.to_string())
+            .member("permission", a.permission.to_string())
+         .end_object();
+      }
+      w.end_array();
+   }
+
+   template<typename ActionTrace>
+   void write_actions(json_writer& w, const std::vector<ActionTrace>& actions, const data_handler_function & data_handler) {
+      std::vector<int> indices(actions.size());
+      std::iota(indices.begin(), indices.end(), 0);
+      std::sort(indices.begin(), indices.end(), [&actions](const int& lhs, const int& rhs) -> bool {
+         return actions.at(lhs).global_sequence < actions.at(rhs).global_sequence;
+      });
+      w.begin_array();
+      for ( int index : indices) {
+         const auto& a = actions.at(index);
+         w.begin_object()
+            .member("global_sequence", a.global_sequence)
+            .member("receiver", a.receiver.to_string())
+            .member("account", a.account.to_string())
+            .member("action", a.action.to_string())
+            .key("authorization");
+         write_authorizations(w, a.authorization);
+         w.member("data", fc::to_hex(a.data.data(), a.data.size()));
+
+         if constexpr(std::is_same_v<ActionTrace, action_trace_v1>){
+            w.member("return_value", fc::to_hex(a.return_value.data(), a.return_value.size()));
+         }
+         // the ABI decoded data is still produced as a variant by the abi_serializer
+         auto [params, return_data] = data_handler(a);
+         if (!params.is_null()) {
+            w.key("params").value(params);
+         }
+         if constexpr(std::is_same_v<ActionTrace, action_trace_v1>){
+            if(return_data.has_value()){
+               w.key("return_data").value(*return_data);
+            }
+         }
+         w.end_object();
+      }
+      w.end_array();
+   }
+
+   template<typename TransactionTrace>
+   void write_transactions(json_writer& w, const std::vector<TransactionTrace>& transactions, const data_handler_function& data_handler) {
+      w.begin_array();
+      for ( const auto& t: transactions) {
+         w.begin_object().member("id", t.id.str());
+         if constexpr(std::is_same_v<TransactionTrace, transaction_trace_v3>){
+            w.member("block_num", t.block_num)
+             .member("block_time", t.block_time)
+             .member("producer_block_id", t.producer_block_id);
+         }
+         w.key("actions");
+         if constexpr(std::is_same_v<TransactionTrace, transaction_trace_v0> || std::is_same_v<TransactionTrace, transaction_trace_v1>){
+            write_actions<action_trace_v0>(w, t.actions, data_handler);
+         } else {
+            write_actions<action_trace_v1>(w, std::get<std::vector<action_trace_v1>>(t.actions), data_handler);
+         }
+         if constexpr(!std::is_same_v<TransactionTrace, transaction_trace_v0>){
+            w.member("status", t.status)
+             .member("cpu_usage_us", t.cpu_usage_us)
+             .member("net_usage_words", t.net_usage_words)
+             .member("signatures", t.signatures)
+             .member("transaction_header", t.trx_header);
+         }
+         w.end_object();
+      }
+      w.end_array();
+   }
 }
 
 namespace eosio::trace_api::detail {
+    std::string response_formatter::process_block_json( const data_log_entry& trace, bool irreversible, const data_handler_function& data_handler ) {
+       std::string result;
+       json_writer w(result);
+       std::visit([&](auto&& arg) {
+          w.begin_object()
+             .member("id", arg.id.str())
+             .member("number", arg.number )
+             .member("previous_id", arg.previous_id.str())
+             .member("status", irreversible ? "irreversible" : "pending" )
+             .member("timestamp", to_iso8601_datetime(arg.timestamp))
+             .member("producer", arg.producer.to_string());}, trace);
+       if  (std::holds_alternative<block_trace_v0> (trace)){
+          auto& block_trace = std::get<block_trace_v0>(trace);
+          w.key("transactions");
+          write_transactions<transaction_trace_v0>(w, block_trace.transactions, data_handler);
+       }else if(std::holds_alternative<block_trace_v1>(trace)){
+          auto& block_trace = std::get<block_trace_v1>(trace);
+          w.member("transaction_mroot", block_trace.transaction_mroot)
+           .member("action_mroot", block_trace.action_mroot)
+           .member("schedule_version", block_trace.schedule_version)
+           .key("transactions");
+          write_transactions<transaction_trace_v1>(w, block_trace.transactions_v1, data_handler);
+       }else if(std::holds_alternative<block_trace_v2>(trace)){
+          auto& block_trace = std::get<block_trace_v2>(trace);
+          w.member("transaction_mroot", block_trace.transaction_mroot)
+           .member("action_mroot", block_trace.action_mroot)
+           .member("schedule_version", block_trace.schedule_version)
+           .key("transactions");
+          std::visit([&](auto&& arg){
+             write_transactions(w, arg, data_handler);
+          }, block_trace.transactions);
+       }
+       w.end_object();
+       return result;
+    }
+
+
     fc::variant response_formatter::process_block( const data_log_entry& trace, bool irreversible, const data_handler_function& data_handler ) {
        auto common_mvo  = std::visit([&](auto&& arg) -> fc::mutable_variant_object {
           return fc::mutable_variant_object()
@@ -3,6 +3,9 @@
 #include <fc/variant_object.hpp>
 #include <fc/log/logger_config.hpp>
 
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
 namespace {
       static constexpr uint32_t _current_version = 1;
       static constexpr const char* _trace_prefix = "trace_";
@@ -10,6 +13,8 @@ namespace {
       static constexpr const char* _trace_trx_id_prefix = "trace_trx_id_";
       static constexpr const char* _trace_ext = ".log";
       static constexpr const char* _compressed_trace_ext = ".clog";
+      static constexpr const char* _trx_id_index_ext = ".idx";
+      static constexpr const char* _block_offsets_ext = ".blk";
       static constexpr int _max_filename_size = std::char_traits<char>::length(_trace_index_prefix) + 10 + 1 + 10 + std::char_traits<char>::length(_compressed_trace_ext) + 1; // "trace_index_" + 10-digits + '-' + 10-digits + ".clog" + null-char
 
       std::string make_filename(const char* slice_prefix, const char* slice_ext, uint32_t slice_number, uint32_t slice_width) {
@@ -27,6 +32,53 @@ namespace {
 
          return std::string(filename);
       }
+
+      static constexpr uint32_t _trx_id_index_version = 1;
+      static constexpr uint32_t _trx_id_index_fence_stride = 64;        // entries per fence pointer, 2304 bytes of entries
+      static constexpr uint32_t _trx_id_index_bloom_bits_per_entry = 10;
+      static constexpr uint32_t _trx_id_index_bloom_hashes = 7;         // ~1% false positives at 10 bits per entry
+      static constexpr size_t _trx_id_size = sizeof(eosio::chain::transaction_id_type);
+      static constexpr size_t _trx_id_index_entry_size = _trx_id_size + sizeof(uint32_t);
+
+      // transaction ids are already hashes, so two of their words serve as the base hashes of the Bloom filter
+      template<typename F>
+      void for_each_bloom_bit(const eosio::chain::transaction_id_type& trx_id, uint64_t num_bits, F&& f) {
+         const uint64_t h1 = trx_id._hash[0];
+         const uint64_t h2 = trx_id._hash[1] | 1;
+         for (uint32_t i = 0; i < _trx_id_index_bloom_hashes; ++i) {
+            f((h1 + i * h2) % num_bits);
+         }
+      }
+
+      static constexpr uint32_t _block_offsets_version = 1;
+      static constexpr uint64_t _no_block_offset = std::numeric_limits<uint64_t>::max();
+
+      // write to a temporary file first, so a reader only ever finds a complete file
+      void write_slice_index_file(const std::filesystem::path& path, const std::vector<char>& data) {
+         auto tmp_path = path;
+         tmp_path += ".tmp";
+         fc::cfile file;
+         file.set_file_path(tmp_path);
+         file.open(fc::cfile::truncate_rw_mode);
+         file.write(data.data(), data.size());
+         file.flush();
+         file.close();
+         std::filesystem::rename(tmp_path, path);
+      }
+
+      // first position in [first, last) for which pred is false, pred being true for a prefix of the range
+      template<typename Pred>
+      uint32_t partition_point(uint32_t first, uint32_t last, Pred&& pred) {
+         while (first < last) {
+            const uint32_t mid = first + (last - first) / 2;
+            if (pred(mid)) {
+               first = mid + 1;
+            } else {
+               last = mid;
+            }
+         }
+         return first;
+      }
 }
 
 namespace eosio::trace_api {
@@ -73,21 +125,26 @@ namespace eosio::trace_api {
    get_block_t store_provider::get_block(uint32_t block_height, const yield_function& yield) {
       std::optional<uint64_t> trace_offset;
       bool irreversible = false;
-      scan_metadata_log_from(block_height, 0, [&block_height, &trace_offset, &irreversible](const metadata_log_entry& e) -> bool {
-         if (std::holds_alternative<block_entry_v0>(e)) {
-            const auto& block = std::get<block_entry_v0>(e);
-            if (block.number == block_height) {
-               trace_offset = block.offset;
-            }
-         } else if (std::holds_alternative<lib_entry_v0>(e)) {
-            auto lib = std::get<lib_entry_v0>(e).lib;
-            if (lib >= block_height) {
-               irreversible = true;
-               return false;
+      // only irreversible slices have a block offset table, the slice still being written is scanned
+      if (_slice_directory.find_block_offset(block_height, trace_offset)) {
+         irreversible = true;
+      } else {
+         scan_metadata_log_from(block_height, 0, [&block_height, &trace_offset, &irreversible](const metadata_log_entry& e) -> bool {
+            if (std::holds_alternative<block_entry_v0>(e)) {
+               const auto& block = std::get<block_entry_v0>(e);
+               if (block.number == block_height) {
+                  trace_offset = block.offset;
+               }
+            } else if (std::holds_alternative<lib_entry_v0>(e)) {
+               auto lib = std::get<lib_entry_v0>(e).lib;
+               if (lib >= block_height) {
+                  irreversible = true;
+                  return false;
+               }
             }
-         }
-         return true;
-      }, yield);
+            return true;
+         }, yield);
+      }
       if (!trace_offset) {
          return get_block_t{};
       }
@@ -110,6 +167,16 @@ namespace eosio::trace_api {
       uint32_t trx_block_num = 0; // number of the block that contains the target trx
       uint32_t trx_entries = 0;   // number of entries that contain the target trx
       while (true){
+         get_block_n indexed_block_num;
+         if (_slice_directory.find_trx_id_in_index(slice_number, trx_id, indexed_block_num)) {
+            yield();
+            // only irreversible slices are indexed
+            if (indexed_block_num)
+               return indexed_block_num;
+            slice_number++;
+            continue;
+         }
+
          const bool found = _slice_directory.find_trx_id_slice(slice_number, open_state::read, trx_id_file);
          if( !found )
             break; // traversed all slices
@@ -287,6 +354,228 @@ namespace eosio::trace_api {
       return true;
    }
 
+   std::filesystem::path slice_directory::trx_id_index_path(uint32_t slice_number) const {
+      return _slice_dir / make_filename(_trace_trx_id_prefix, _trx_id_index_ext, slice_number, _width);
+   }
+
+   struct slice_directory::mapped_slice_file {
+      boost::interprocess::mapped_region region;
+
+      const char* data() const { return static_cast<const char*>(region.get_address()); }
+      size_t size() const { return region.get_size(); }
+   };
+
+   slice_directory::mapped_slice_file_ptr slice_directory::map_slice_file(const std::filesystem::path& path) const {
+      namespace bip = boost::interprocess;
+
+      std::scoped_lock lock(_mapped_files_mtx);
+      auto itr = _mapped_files.find(path);
+      if (itr != _mapped_files.end()) {
+         return itr->second;
+      }
+      if (!exists(path)) {
+         return {};
+      }
+      // the region stays valid once the file mapping is closed
+      const bip::file_mapping mapping(path.generic_string().c_str(), bip::read_only);
+      auto mapped = std::make_shared<const mapped_slice_file>(mapped_slice_file{ .region = bip::mapped_region(mapping, bip::read_only) });
+      _mapped_files.emplace(path, mapped);
+      return mapped;
+   }
+
+   void slice_directory::unmap_slice_file(const std::filesystem::path& path) const {
+      std::scoped_lock lock(_mapped_files_mtx);
+      _mapped_files.erase(path);
+   }
+
+   std::filesystem::path slice_directory::block_offsets_path(uint32_t slice_number) const {
+      return _slice_dir / make_filename(_trace_index_prefix, _block_offsets_ext, slice_number, _width);
+   }
+
+   bool slice_directory::create_block_offsets(uint32_t slice_number) const {
+      fc::cfile index;
+      if (!find_index_slice(slice_number, open_state::read, index)) {
+         return false;
+      }
+
+      const uint32_t first_block = slice_number * _width;
+      std::vector<uint64_t> offsets(_width, _no_block_offset);
+      const uint64_t end = file_size(index.get_file_path());
+      while (index.tellp() < end) {
+         const auto entry = extract_store<metadata_log_entry>(index);
+         if (std::holds_alternative<block_entry_v0>(entry)) {
+            // the last entry of a block number is the one of the irreversible block, as in a scan of the index
+            const auto& block = std::get<block_entry_v0>(entry);
+            if (block.number >= first_block && block.number - first_block < _width) {
+               offsets[block.number - first_block] = block.offset;
+            }
+         }
+      }
+
+      fc::datastream<std::vector<char>> out;
+      fc::raw::pack(out, block_offsets_header{ .version = _block_offsets_version, .first_block = first_block, .num_blocks = _width });
+      for (uint64_t offset : offsets) {
+         fc::raw::pack(out, offset);
+      }
+      write_slice_index_file(block_offsets_path(slice_number), out.storage());
+      return true;
+   }
+
+   bool slice_directory::find_block_offset(uint32_t block_height, std::optional<uint64_t>& offset) const {
+      const auto table_path = block_offsets_path(slice_number(block_height));
+      const mapped_slice_file_ptr table = map_slice_file(table_path);
+      if (!table) {
+         return false;
+      }
+      const char* const data = table->data();
+      const size_t size = table->size();
+
+      block_offsets_header header;
+      fc::datastream<const char*> ds(data, size);
+      fc::raw::unpack(ds, header);
+      if (header.version != _block_offsets_version) {
+         throw old_slice_version("Old block offset table with version: " + std::to_string(header.version) +
+                                 " is in directory, only supporting version: " + std::to_string(_block_offsets_version));
+      }
+      if (ds.tellp() + uint64_t(header.num_blocks) * sizeof(uint64_t) != size ||
+          block_height < header.first_block || block_height - header.first_block >= header.num_blocks) {
+         throw malformed_slice_file("Block offset table: " + table_path.generic_string() + " of " + std::to_string(size) +
+                                    " bytes does not match its header or does not contain block: " + std::to_string(block_height));
+      }
+
+      uint64_t block_offset;
+      memcpy(&block_offset, data + ds.tellp() + (block_height - header.first_block) * sizeof(uint64_t), sizeof(block_offset));
+      offset.reset();
+      if (block_offset != _no_block_offset) {
+         offset = block_offset;
+      }
+      return true;
+   }
+
+   bool slice_directory::create_trx_id_index(uint32_t slice_number) const {
+      fc::cfile trx_id_file;
+      if (!find_trx_id_slice(slice_number, open_state::read, trx_id_file)) {
+         return false;
+      }
+
+      struct trx_block_t {
+         chain::transaction_id_type id;
+         uint32_t block_num = 0;
+      };
+      std::vector<trx_block_t> entries;
+      metadata_log_entry entry;
+      auto ds = trx_id_file.create_datastream();
+      const uint64_t end = file_size(trx_id_file.get_file_path());
+      while (trx_id_file.tellp() < end) {
+         fc::raw::unpack(ds, entry);
+         if (std::holds_alternative<block_trxs_entry>(entry)) {
+            const auto& trxs_entry = std::get<block_trxs_entry>(entry);
+            for (const auto& id : trxs_entry.ids) {
+               entries.push_back(trx_block_t{ .id = id, .block_num = trxs_entry.block_num });
+            }
+         }
+      }
+
+      // a transaction of a forked out block is appended again with the block that replaced it, keep the last one
+      // like a scan of the trx id file does
+      std::stable_sort(entries.begin(), entries.end(), [](const trx_block_t& a, const trx_block_t& b) { return a.id < b.id; });
+      auto last = entries.begin();
+      for (auto itr = entries.begin(); itr != entries.end(); ++itr) {
+         if (std::next(itr) == entries.end() || std::next(itr)->id != itr->id) {
+            *last++ = *itr;
+         }
+      }
+      entries.erase(last, entries.end());
+
+      const trx_id_index_header header {
+         .version      = _trx_id_index_version,
+         .num_entries  = static_cast<uint32_t>(entries.size()),
+         .bloom_words  = static_cast<uint32_t>(std::max<size_t>(1, (entries.size() * _trx_id_index_bloom_bits_per_entry + 63) / 64)),
+         .fence_stride = _trx_id_index_fence_stride
+      };
+      std::vector<uint64_t> bloom(header.bloom_words);
+      for (const auto& e : entries) {
+         for_each_bloom_bit(e.id, bloom.size() * 64, [&bloom](uint64_t bit) {
+            bloom[bit / 64] |= uint64_t(1) << (bit % 64);
+         });
+      }
+
+      fc::datastream<std::vector<char>> out;
+      fc::raw::pack(out, header);
+      for (uint64_t word : bloom) {
+         fc::raw::pack(out, word);
+      }
+      for (size_t i = 0; i < entries.size(); i += header.fence_stride) {
+         out.write(entries[i].id.data(), _trx_id_size);
+      }
+      for (const auto& e : entries) {
+         out.write(e.id.data(), _trx_id_size);
+         fc::raw::pack(out, e.block_num);
+      }
+
+      write_slice_index_file(trx_id_index_path(slice_number), out.storage());
+      return true;
+   }
+
+   bool slice_directory::find_trx_id_in_index(uint32_t slice_number, const chain::transaction_id_type& trx_id, get_block_n& block_num) const {
+      const auto index_path = trx_id_index_path(slice_number);
+      const mapped_slice_file_ptr index = map_slice_file(index_path);
+      if (!index) {
+         return false;
+      }
+      const char* const data = index->data();
+      const size_t size = index->size();
+
+      trx_id_index_header header;
+      fc::datastream<const char*> ds(data, size);
+      fc::raw::unpack(ds, header);
+      if (header.version != _trx_id_index_version) {
+         throw old_slice_version("Old trx id index with version: " + std::to_string(header.version) +
+                                 " is in directory, only supporting version: " + std::to_string(_trx_id_index_version));
+      }
+      const uint32_t num_fences = header.fence_stride ? (header.num_entries + header.fence_stride - 1) / header.fence_stride : 0;
+      const uint64_t expected_size = ds.tellp() + uint64_t(header.bloom_words) * sizeof(uint64_t) +
+                                     uint64_t(num_fences) * _trx_id_size + uint64_t(header.num_entries) * _trx_id_index_entry_size;
+      if (header.bloom_words == 0 || header.fence_stride == 0 || expected_size != size) {
+         throw malformed_slice_file("Trx id index: " + index_path.generic_string() + " of " + std::to_string(size) +
+                                    " bytes does not match its header");
+      }
+      const char* const bloom = data + ds.tellp();
+      const char* const fences = bloom + header.bloom_words * sizeof(uint64_t);
+      const char* const entries = fences + num_fences * _trx_id_size;
+
+      block_num.reset();
+      bool maybe_present = true;
+      for_each_bloom_bit(trx_id, uint64_t(header.bloom_words) * 64, [&](uint64_t bit) {
+         uint64_t word;
+         memcpy(&word, bloom + (bit / 64) * sizeof(word), sizeof(word));
+         maybe_present = maybe_present && ((word >> (bit % 64)) & 1);
+      });
+      if (!maybe_present) {
+         return true;
+      }
+
+      // the fence pointers narrow the search down to the fence_stride entries following the last fence <= trx_id
+      const uint32_t next_fence = partition_point(0, num_fences, [&](uint32_t i) {
+         return memcmp(fences + i * _trx_id_size, trx_id.data(), _trx_id_size) <= 0;
+      });
+      if (next_fence == 0) {
+         return true;
+      }
+      const uint32_t first = (next_fence - 1) * header.fence_stride;
+      const uint32_t last = std::min(first + header.fence_stride, header.num_entries);
+      const uint32_t pos = partition_point(first, last, [&](uint32_t i) {
+         return memcmp(entries + i * _trx_id_index_entry_size, trx_id.data(), _trx_id_size) < 0;
+      });
+      const char* const found = entries + pos * _trx_id_index_entry_size;
+      if (pos < last && memcmp(found, trx_id.data(), _trx_id_size) == 0) {
+         uint32_t n;
+         memcpy(&n, found + _trx_id_size, sizeof(n));
+         block_num = n;
+      }
+      return true;
+   }
+
    void slice_directory::set_lib(uint32_t lib) {
       {
          std::scoped_lock lock(_maintenance_mtx);
@@ -362,6 +651,12 @@ namespace eosio::trace_api {
 
             // cleanup index first to reduce the likelihood of reader finding index, but not finding trace
             const bool dont_open_file = false;
+            const auto block_offsets = block_offsets_path(slice_to_clean);
+            unmap_slice_file(block_offsets);
+            if (exists(block_offsets)) {
+               log(std::string("Removing: ") + block_offsets.generic_string());
+               std::filesystem::remove(block_offsets);
+            }
             const bool index_found = find_index_slice(slice_to_clean, open_state::read, index, dont_open_file);
             if (index_found) {
                log(std::string("Removing: ") + index.get_file_path().generic_string());
@@ -377,6 +672,12 @@ namespace eosio::trace_api {
                log(std::string("Removing: ") + trx_id.get_file_path().generic_string());
                std::filesystem::remove(trx_id.get_file_path());
             }
+            const auto trx_id_index = trx_id_index_path(slice_to_clean);
+            unmap_slice_file(trx_id_index);
+            if (exists(trx_id_index)) {
+               log(std::string("Removing: ") + trx_id_index.generic_string());
+               std::filesystem::remove(trx_id_index);
+            }
 
             auto ctrace = find_compressed_trace_slice(slice_to_clean, dont_open_file);
             if (ctrace) {
@@ -386,6 +687,18 @@ namespace eosio::trace_api {
          });
       }
 
+      // a slice is indexed as soon as all of its blocks are irreversible, since its index and trx id files are complete by then
+      process_irreversible_slice_range(lib, 0, _last_indexed_slice, [this, &log](uint32_t slice_to_index){
+         log(std::string("Attempting indexing of slice: ") + std::to_string(slice_to_index));
+
+         if (!exists(block_offsets_path(slice_to_index)) && create_block_offsets(slice_to_index)) {
+            log(std::string("Created: ") + block_offsets_path(slice_to_index).generic_string());
+         }
+         if (!exists(trx_id_index_path(slice_to_index)) && create_trx_id_index(slice_to_index)) {
+            log(std::string("Created: ") + trx_id_index_path(slice_to_index).generic_string());
+         }
+      });
+
       // Only process compression if its configured AND there is a range of irreversible blocks which would not also
       // be deleted
       if (_minimum_uncompressed_irreversible_history_blocks &&
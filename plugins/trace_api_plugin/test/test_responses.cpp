@@ -1,6 +1,7 @@
 #include <boost/test/unit_test.hpp>
 
 #include <fc/variant_object.hpp>
+#include <fc/io/json.hpp>
 
 #include <eosio/trace_api/request_handler.hpp>
 #include <eosio/trace_api/test_common.hpp>
@@ -69,7 +70,14 @@ struct response_test_fixture {
    }
 
    fc::variant get_block_trace( uint32_t block_height ) {
-      return response_impl.get_block_trace( block_height );
+      auto result = response_impl.get_block_trace( block_height );
+      // the JSON written directly must be the JSON of the variant, down to the order of the fields
+      auto json = response_impl.get_block_trace_json( block_height );
+      BOOST_REQUIRE_EQUAL( bool(json), !result.is_null() );
+      if (json) {
+         BOOST_REQUIRE_EQUAL( *json, fc::json::to_string( result, fc::time_point::maximum() ) );
+      }
+      return result;
    }
 
    // fixture data and methods
@@ -952,4 +960,62 @@ BOOST_AUTO_TEST_SUITE(trace_responses)
 
    }
 
+   BOOST_FIXTURE_TEST_CASE(block_json_cache_irreversible_only, response_test_fixture)
+   {
+      auto block_trace = block_trace_v1{
+         {
+            "b000000000000000000000000000000000000000000000000000000000000001"_h,
+            1,
+            "0000000000000000000000000000000000000000000000000000000000000000"_h,
+            chain::block_timestamp_type(0),
+            "bp.one"_n
+         },
+         "0000000000000000000000000000000000000000000000000000000000000000"_h,
+         "0000000000000000000000000000000000000000000000000000000000000000"_h,
+         0,
+         {}
+      };
+
+      uint32_t lib = 0;
+      uint32_t reads = 0;
+      mock_get_block = [&]( uint32_t height ) -> get_block_t {
+         ++reads;
+         auto bt = block_trace;
+         bt.number = height;
+         return std::make_tuple(data_log_entry(bt), height <= lib);
+      };
+      response_impl_type cached_impl(mock_logfile_provider(*this), mock_data_handler_provider(*this),
+                                     [](const std::string& msg ){ fc_dlog( fc::logger::get(DEFAULT_LOGGER), msg );}, 1024);
+
+      // pending blocks are read every time
+      auto pending = cached_impl.get_block_trace_json( 1 );
+      BOOST_REQUIRE( pending );
+      BOOST_REQUIRE( pending->find("\"pending\"") != std::string::npos );
+      cached_impl.get_block_trace_json( 1 );
+      BOOST_REQUIRE_EQUAL( reads, 2u );
+
+      // once irreversible, a block is read once
+      lib = 1;
+      auto irreversible = cached_impl.get_block_trace_json( 1 );
+      BOOST_REQUIRE( irreversible->find("\"irreversible\"") != std::string::npos );
+      BOOST_REQUIRE( cached_impl.get_block_trace_json( 1 ) == irreversible );
+      BOOST_REQUIRE_EQUAL( reads, 3u );
+
+      // the least recently used block is evicted once the cache is full
+      lib = 100;
+      const uint32_t per_block = irreversible->size();
+      const uint32_t capacity = 1024 / per_block;
+      for (uint32_t height = 2; height <= capacity; ++height) {
+         cached_impl.get_block_trace_json( height );
+      }
+      BOOST_REQUIRE_EQUAL( reads, 3u + capacity - 1 );
+      cached_impl.get_block_trace_json( 1 );
+      cached_impl.get_block_trace_json( capacity + 1 );
+      BOOST_REQUIRE_EQUAL( reads, 3u + capacity );
+      cached_impl.get_block_trace_json( 1 );
+      BOOST_REQUIRE_EQUAL( reads, 3u + capacity );
+      cached_impl.get_block_trace_json( 2 );
+      BOOST_REQUIRE_EQUAL( reads, 4u + capacity );
+   }
+
 BOOST_AUTO_TEST_SUITE_END()
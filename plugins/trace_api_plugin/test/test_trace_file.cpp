@@ -210,6 +210,7 @@ namespace {
       }
       using store_provider::scan_metadata_log_from;
       using store_provider::read_data_log;
+      using store_provider::_slice_directory;
    };
 
    class vslice_datastream;
@@ -1067,4 +1068,114 @@ BOOST_AUTO_TEST_SUITE(slice_tests)
    }
 
 
+   // Verifies that the lookup files maintenance creates for the slices below the slice of lib answer lookups alone:
+   // lookups are verified before maintenance, then the lookup files are checked directly, which maps them, and the
+   // source files they replace are removed, then lookups are verified again through the kept mappings.
+   template<typename Verify, typename CheckLookupFiles, typename FindSourceFile>
+   void verify_slice_lookup_files(test_store_provider& sp, uint32_t lib, Verify&& verify,
+                                  CheckLookupFiles&& check_lookup_files, FindSourceFile&& find_source_file) {
+      verify();
+
+      // only the slices whose blocks are all irreversible get lookup files
+      sp._slice_directory.run_maintenance_tasks(lib, {});
+      check_lookup_files();
+
+      for (uint32_t slice = 0; slice < sp._slice_directory.slice_number(lib); ++slice) {
+         fc::cfile source;
+         BOOST_REQUIRE(find_source_file(slice, source));
+         std::filesystem::remove(source.get_file_path());
+      }
+      verify();
+   }
+
+   BOOST_FIXTURE_TEST_CASE(store_provider_block_offsets, test_fixture)
+   {
+      fc::temp_directory tempdir;
+      const uint32_t width = 10;
+      test_store_provider sp(tempdir.path(), width);
+
+      // every block but 13, block 7 is forked out and replaced
+      std::vector<block_trace_v2> block_traces;
+      for (uint32_t block_num = 1; block_num < 3 * width; ++block_num) {
+         if (block_num == 13) {
+            continue;
+         }
+         auto bt = block_trace1_v2;
+         bt.number = block_num;
+         if (block_num == 7) {
+            bt.producer = "bp.two"_n;
+            sp.append(bt);
+            bt.producer = block_trace1_v2.producer;
+         }
+         sp.append(bt);
+         sp.append_lib(block_num - 1);
+         block_traces.push_back(bt);
+      }
+
+      const auto verify_blocks = [&]() {
+         for (const auto& bt : block_traces) {
+            get_block_t block = sp.get_block(bt.number);
+            BOOST_REQUIRE(block);
+            BOOST_REQUIRE_EQUAL(std::get<block_trace_v2>(std::get<0>(*block)), bt);
+            BOOST_REQUIRE_EQUAL(std::get<1>(*block), bt.number <= 3 * width - 2);
+         }
+         BOOST_REQUIRE(!sp.get_block(13));
+      };
+
+      verify_slice_lookup_files(sp, 3 * width - 2, verify_blocks,
+         [&]() {
+            std::optional<uint64_t> offset;
+            BOOST_REQUIRE(sp._slice_directory.find_block_offset(7, offset));
+            BOOST_REQUIRE(offset);
+            BOOST_REQUIRE(sp._slice_directory.find_block_offset(13, offset));
+            BOOST_REQUIRE(!offset);
+            BOOST_REQUIRE(!sp._slice_directory.find_block_offset(21, offset));
+         },
+         [&](uint32_t slice, fc::cfile& file) { return sp._slice_directory.find_index_slice(slice, open_state::read, file, false); });
+   }
+
+   BOOST_FIXTURE_TEST_CASE(store_provider_trx_id_index, test_fixture)
+   {
+      fc::temp_directory tempdir;
+      const uint32_t width = 10;
+      test_store_provider sp(tempdir.path(), width);
+      const auto trx_id = [](uint32_t n) { return fc::sha256::hash(std::to_string(n)); };
+      const auto forked_trx_id = trx_id(0);
+
+      // 100 trxs in each of the blocks 1 to 29, the forked trx is in block 5 and then again in block 6
+      for (uint32_t block_num = 1; block_num < 3 * width; ++block_num) {
+         block_trxs_entry entry { .block_num = block_num };
+         for (uint32_t i = 0; i < 100; ++i) {
+            entry.ids.push_back(trx_id(block_num * 100 + i));
+         }
+         if (block_num == 5 || block_num == 6) {
+            entry.ids.push_back(forked_trx_id);
+         }
+         sp.append_trx_ids(entry);
+         sp.append_lib(block_num - 1);
+      }
+
+      const auto verify_lookups = [&]() {
+         for (uint32_t block_num = 1; block_num < 3 * width; ++block_num) {
+            for (uint32_t i = 0; i < 100; i += 7) {
+               BOOST_REQUIRE_EQUAL(*sp.get_trx_block_number(trx_id(block_num * 100 + i), {}), block_num);
+            }
+         }
+         BOOST_REQUIRE_EQUAL(*sp.get_trx_block_number(forked_trx_id, {}), 6u);
+         BOOST_REQUIRE(!sp.get_trx_block_number(trx_id(99), {}));
+         BOOST_REQUIRE(!sp.get_trx_block_number(trx_id(100 * 3 * width), {}));
+      };
+
+      verify_slice_lookup_files(sp, 28, verify_lookups,
+         [&]() {
+            get_block_n block_num;
+            BOOST_REQUIRE(sp._slice_directory.find_trx_id_in_index(0, trx_id(512), block_num));
+            BOOST_REQUIRE_EQUAL(*block_num, 5u);
+            BOOST_REQUIRE(sp._slice_directory.find_trx_id_in_index(1, trx_id(512), block_num));
+            BOOST_REQUIRE(!block_num);
+            BOOST_REQUIRE(!sp._slice_directory.find_trx_id_in_index(2, trx_id(2512), block_num));
+         },
+         [&](uint32_t slice, fc::cfile& file) { return sp._slice_directory.find_trx_id_slice(slice, open_state::read, file, false); });
+   }
+
 BOOST_AUTO_TEST_SUITE_END()
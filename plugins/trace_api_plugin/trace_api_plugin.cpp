@@ -196,6 +196,8 @@ struct trace_api_rpc_plugin_impl : public std::enable_shared_from_this<trace_api
             "Failure to specify this option when there are no trace-rpc-abi configuations will result in an Error.\n"
             "This option is mutually exclusive with trace-rpc-api"
       );
+      cfg_options("trace-rpc-block-cache-mb", bpo::value<uint32_t>()->default_value(64),
+                  "Maximum size (in MiB) of the cache of get_block responses for irreversible blocks. 0 disables the cache.");
    }
 
    void plugin_initialize(const appbase::variables_map& options) {
@@ -232,7 +234,8 @@ struct trace_api_rpc_plugin_impl : public std::enable_shared_from_this<trace_api
          abi_data_handler::shared_provider(data_handler),
          [](const std::string& msg ) {
             fc_dlog( _log, msg );
-         }
+         },
+         size_t(options.at("trace-rpc-block-cache-mb").as<uint32_t>()) * 1024 * 1024
       );
    }
 
@@ -273,17 +276,17 @@ struct trace_api_rpc_plugin_impl : public std::enable_shared_from_this<trace_api
 
          try {
 
-            auto resp = that->req_handler->get_block_trace(*block_number);
-            if (resp.is_null()) {
+            auto json = that->req_handler->get_block_trace_json(*block_number);
+            if (!json) {
                error_results results{404, "Trace API: block trace missing"};
                cb( 404, fc::variant( results ));
             } else {
-               cb( 200, std::move(resp) );
+               cb( 200, fc::variant( *json ) );
             }
          } catch (...) {
             http_plugin::handle_exception("trace_api", "get_block", body, cb);
          }
-      }});
+      }}, http_content_type::json_text);
 
 
       http.add_async_handler({"/v1/trace_api/get_transaction_trace",
@@ -14,6 +14,7 @@
 #include <boost/program_options.hpp>
 
 #include <chrono>
+#include <thread>
 
 #ifndef _WIN32
 #define FOPEN(p, m) fopen(p, m)
@@ -38,6 +39,13 @@ struct report_time {
       ilog("spring-util - ${desc} took ${t} msec", ("desc", _desc)("t", duration));
    }
 
+   void report(uint64_t bytes_processed) {
+      const auto duration = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now() - _start).count();
+      const double gb_per_sec = duration > 0 ? double(bytes_processed) / duration / 1000 : 0; // bytes/us == MB/s
+      ilog("spring-util - ${desc} took ${t} msec, ${b} bytes at ${r} GB/s",
+           ("desc", _desc)("t", duration / 1000)("b", bytes_processed)("r", gb_per_sec));
+   }
+
    const std::chrono::high_resolution_clock::time_point _start;
    const std::string _desc;
 };
@@ -75,6 +83,7 @@ void blocklog_actions::setup(CLI::App& app) {
    // subcommand - make index
    auto* make_index = sub->add_subcommand("make-index", "Create blocks.index from blocks.log. Must give 'blocks-dir'. Give 'output-file' relative to current directory or absolute path (default is <blocks-dir>/blocks.index).")->callback([err_guard]() { err_guard(&blocklog_actions::make_index); });
    make_index->add_option("--output-file,-o", opt->output_file, "The file to write the output to (absolute or relative path).  If not specified then output is to stdout.");
+   make_index->add_option("--threads,-t", opt->threads, "Number of threads indexing blocks.log concurrently, 0 for one per hardware thread.")->capture_default_str();
 
    // subcommand - trim blocklog
    auto* trim_blocklog = sub->add_subcommand("trim-blocklog", "Trim blocks.log and blocks.index. Must give 'blocks-dir' and 'first' and/or 'last'.")->callback([err_guard]() { err_guard(&blocklog_actions::trim_blocklog); });
@@ -99,9 +108,20 @@ void blocklog_actions::setup(CLI::App& app) {
    merge_blocks->add_option("--blocks-dir", opt->blocks_dir, "The location of the blocks directory (absolute path or relative to the current directory).");
    merge_blocks->add_option("--output-dir", opt->output_dir, "The output directory for the merged block log.")->required();
 
+   // subcommand - convert blocks
+   auto* convert_blocks = sub->add_subcommand("convert", "Rewrite blocks.log and blocks.index in 'blocks-dir' to 'output-dir' as a compressed block log, "
+          "where each block is an independently compressed entry, or back to an uncompressed block log with '--compression-level 0'. "
+          "A pruned block log must be vacuumed before it can be converted.")->callback([err_guard]() { err_guard(&blocklog_actions::convert_blocks); });
+   convert_blocks->add_option("--output-dir", opt->output_dir, "The output directory for the converted block log.")->required();
+   convert_blocks->add_option("--compression-level", opt->compression_level, "zlib compression level 1-9 of each block, 0 writes an uncompressed block log.")->capture_default_str();
+
    // subcommand - smoke test
    sub->add_subcommand("smoke-test", "Quick test that blocks.log and blocks.index are well formed and agree with each other.")->callback([err_guard]() { err_guard(&blocklog_actions::smoke_test); });
 
+   // subcommand - verify
+   auto* verify = sub->add_subcommand("verify", "Deserialize every block of blocks.log, verifying block ids, previous linkage and blocks.index.")->callback([err_guard]() { err_guard(&blocklog_actions::verify_blocks); });
+   verify->add_option("--threads,-t", opt->threads, "Number of threads verifying block ranges concurrently, 0 for one per hardware thread.")->capture_default_str();
+
    // subcommand - vacuum
    sub->add_subcommand("vacuum", "Vacuum a pruned blocks.log in to an un-pruned blocks.log")->callback([err_guard]() { err_guard(&blocklog_actions::do_vacuum); });
 
@@ -140,12 +160,13 @@ int blocklog_actions::make_index() {
    const std::filesystem::path block_file = blocks_dir / "blocks.log";
    if(!opt->output_file.empty()) out_file = opt->output_file;
 
+   const uint32_t threads = opt->threads ? opt->threads : std::thread::hardware_concurrency();
    report_time rt("making index");
    const auto log_level = fc::logger::get(DEFAULT_LOGGER).get_log_level();
    fc::logger::get(DEFAULT_LOGGER).set_log_level(fc::log_level::debug);
-   block_log::construct_index(block_file.generic_string(), out_file.generic_string());
+   block_log::construct_index(block_file.generic_string(), out_file.generic_string(), threads);
    fc::logger::get(DEFAULT_LOGGER).set_log_level(log_level);
-   rt.report();
+   rt.report(std::filesystem::file_size(block_file));
 
    return 0;
 }
@@ -233,6 +254,16 @@ int blocklog_actions::smoke_test() {
    return 0;
 }
 
+int blocklog_actions::verify_blocks() {
+   const std::filesystem::path block_dir = opt->blocks_dir;
+   const uint32_t threads = opt->threads ? opt->threads : std::thread::hardware_concurrency();
+   report_time rt("verifying block log");
+   block_log::verify_blocklog(block_dir, threads);
+   rt.report(std::filesystem::file_size(block_dir / "blocks.log"));
+   std::cout << "\nno problems found\n"; // if get here there were no exceptions
+   return 0;
+}
+
 int blocklog_actions::do_vacuum() {
    std::filesystem::path bld = opt->blocks_dir;
    auto full_path = (bld / "blocks.log").generic_string();
@@ -358,4 +389,11 @@ int blocklog_actions::split_blocks() {
 int blocklog_actions::merge_blocks() {
    block_log::merge_blocklogs(opt->blocks_dir, opt->output_dir);
    return 0;
-}
\ No newline at end of file
+}
+
+int blocklog_actions::convert_blocks() {
+   report_time rt(opt->compression_level > 0 ? "compressing block log" : "decompressing block log");
+   block_log::convert_blocklog(opt->blocks_dir, opt->output_dir, opt->compression_level);
+   rt.report();
+   return 0;
+}
@@ -11,6 +11,8 @@ struct blocklog_options {
    uint32_t last_block = std::numeric_limits<uint32_t>::max();
    std::string output_dir = "";
    uint32_t stride = 100000;
+   int compression_level = 6;
+   uint32_t threads = 1;
 
    // flags
    bool no_pretty_print = false;
@@ -34,10 +36,12 @@ protected:
    int trim_blocklog();
    int extract_blocks();
    int smoke_test();
+   int verify_blocks();
    int do_vacuum();
    int do_genesis();
    int read_log();
 
    int split_blocks();
    int merge_blocks();
+   int convert_blocks();
 };
\ No newline at end of file
@@ -11,6 +11,9 @@
 #include <eosio/chain/block_log.hpp>
 #include <eosio/chain/exceptions.hpp>
 #include <eosio/chain/chainbase_environment.hpp>
+#ifdef EOSIO_EOS_VM_OC_RUNTIME_ENABLED
+#include <eosio/chain/webassembly/eos-vm-oc/code_cache.hpp>
+#endif
 
 #include <boost/algorithm/string.hpp>
 #include <boost/lexical_cast.hpp>
@@ -41,6 +44,31 @@ void chain_actions::setup(CLI::App& app) {
       // properly return err code in main
       if(rc) throw(CLI::RuntimeError(rc));
    });
+
+#ifdef EOSIO_EOS_VM_OC_RUNTIME_ENABLED
+   auto* oc_export = sub->add_subcommand("export-oc-cache", "export the EOS VM OC code cache of the state directory for the eos-vm-oc-cache-import option of other nodes");
+   oc_export->add_option("--output-file,-o", opt->oc_export_output_file, "write into specified file")->required();
+   oc_export->callback([&]() {
+      int rc = run_subcommand_export_oc_cache();
+      // properly return err code in main
+      if(rc) throw(CLI::RuntimeError(rc));
+   });
+#endif
+}
+
+std::filesystem::path chain_actions::state_dir() const {
+   // default state dir, if none specified
+   if(opt->sstate_state_dir.empty()) {
+      auto root = fc::app_path();
+      auto default_data_dir = root / "eosio" / "nodeos" / "data" ;
+      return default_data_dir / config::default_state_dir_name;
+   }
+   // adjust if path relative
+   std::filesystem::path state_dir = opt->sstate_state_dir;
+   if(state_dir.is_relative()) {
+      state_dir = std::filesystem::current_path() / state_dir;
+   }
+   return state_dir;
 }
 
 int chain_actions::run_subcommand_build() {
@@ -60,21 +88,7 @@ int chain_actions::run_subcommand_build() {
 }
 
 int chain_actions::run_subcommand_sstate() {
-   std::filesystem::path state_dir = "";
-
-   // default state dir, if none specified
-   if(opt->sstate_state_dir.empty()) {
-      auto root = fc::app_path();
-      auto default_data_dir = root / "eosio" / "nodeos" / "data" ;
-      state_dir  = default_data_dir / config::default_state_dir_name;
-   }
-   else {
-      // adjust if path relative
-      state_dir = opt->sstate_state_dir;
-      if(state_dir.is_relative()) {
-         state_dir = std::filesystem::current_path() / state_dir;
-      }
-   }
+   std::filesystem::path state_dir = this->state_dir();
 
    auto shared_mem_path = state_dir / "shared_memory.bin";
 
@@ -104,4 +118,25 @@ int chain_actions::run_subcommand_sstate() {
 
    std::cout << "Database state is clean" << std::endl;
    return 0;
-}
\ No newline at end of file
+}
+
+#ifdef EOSIO_EOS_VM_OC_RUNTIME_ENABLED
+int chain_actions::run_subcommand_export_oc_cache() {
+   std::filesystem::path output_file = opt->oc_export_output_file;
+   if(output_file.is_relative()) {
+      output_file = std::filesystem::current_path() / output_file;
+   }
+
+   try {
+      size_t entries = eosvmoc::export_code_cache(state_dir(), output_file);
+      std::cout << "Exported " << entries << " EOS VM OC code cache entries to '" << output_file.generic_string() << "'" << std::endl;
+   } catch(const fc::exception& e) {
+      std::cerr << "Unable to export EOS VM OC code cache: " << e.to_detail_string() << std::endl;
+      return -1;
+   } catch(const std::exception& e) {
+      std::cerr << "Unable to export EOS VM OC code cache: " << e.what() << std::endl;
+      return -1;
+   }
+   return 0;
+}
+#endif
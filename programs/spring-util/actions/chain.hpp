@@ -1,9 +1,11 @@
 #include "subcommand.hpp"
+#include <filesystem>
 
 struct chain_options {
    bool build_just_print = false;
    std::string build_output_file = "";
    std::string sstate_state_dir = "";
+   std::string oc_export_output_file = "";
 };
 
 class chain_actions : public sub_command<chain_options> {
@@ -14,4 +16,10 @@ public:
    // callbacks
    int run_subcommand_build();
    int run_subcommand_sstate();
+#ifdef EOSIO_EOS_VM_OC_RUNTIME_ENABLED
+   int run_subcommand_export_oc_cache();
+#endif
+
+private:
+   std::filesystem::path state_dir() const;
 };
\ No newline at end of file
@@ -38,6 +38,51 @@ void snapshot_actions::setup(CLI::App& app) {
          throw(CLI::RuntimeError(-1));
       }
    });
+
+   // subcommand - convert between the binary snapshot containers
+   auto convert_cmd = sub->add_subcommand("convert", "Convert a binary snapshot between the plain container and the compressed container with a table of contents");
+   convert_cmd->add_option("--input-file,-i", opt->input_file, "Binary snapshot file to convert, in either container.")->required();
+   convert_cmd->add_option("--output-file,-o", opt->output_file, "The file to write the converted snapshot to.")->required();
+   convert_cmd->add_option("--container", opt->container, "Container of the output file: \"binary\" or \"compressed\".")->capture_default_str();
+
+   convert_cmd->callback([this]() {
+      try {
+         int rc = convert();
+         if(rc) throw(CLI::RuntimeError(rc));
+      } catch(...) {
+         print_exception();
+         throw(CLI::RuntimeError(-1));
+      }
+   });
+}
+
+int snapshot_actions::convert() {
+   snapshot_container to;
+   if(opt->container == "binary") {
+      to = snapshot_container::binary;
+   } else if(opt->container == "compressed") {
+      to = snapshot_container::compressed;
+   } else {
+      std::cerr << "unknown snapshot container " << opt->container << ", expected binary or compressed" << std::endl;
+      return -1;
+   }
+   if(!std::filesystem::exists(opt->input_file)) {
+      std::cerr << "cannot convert snapshot, " << opt->input_file << " does not exist" << std::endl;
+      return -1;
+   }
+   if(std::filesystem::exists(opt->output_file)) {
+      std::cerr << "cannot convert snapshot, " << opt->output_file << " already exists" << std::endl;
+      return -1;
+   }
+
+   auto infile = std::ifstream(opt->input_file, (std::ios::in | std::ios::binary));
+   auto outfile = std::ofstream(opt->output_file, (std::ios::out | std::ios::binary));
+   convert_snapshot(infile, outfile, to);
+   outfile.close();
+   EOS_ASSERT(outfile, snapshot_exception, "Failed to write ${f}", ("f", opt->output_file));
+
+   ilog("Converted snapshot ${i} to ${o}", ("i", opt->input_file)("o", opt->output_file));
+   return 0;
 }
 
 int snapshot_actions::run_subcommand() {
@@ -6,6 +6,7 @@ struct snapshot_options {
    uint64_t db_size = 65536ull;
    uint64_t guard_size = 1;
    std::string chain_id = "";
+   std::string container = "compressed";
 };
 
 class snapshot_actions : public sub_command<snapshot_options> {
@@ -15,4 +16,5 @@ public:
 
    // callbacks
    int run_subcommand();
+   int convert();
 };
\ No newline at end of file
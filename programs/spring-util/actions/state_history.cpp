@@ -0,0 +1,57 @@
+#include "state_history.hpp"
+#include <eosio/state_history/log.hpp>
+
+#include <filesystem>
+#include <iostream>
+
+using namespace eosio;
+using namespace eosio::chain;
+
+void state_history_actions::setup(CLI::App& app) {
+   auto* sub = app.add_subcommand("state-history", "State history log utility");
+   sub->require_subcommand();
+   sub->fallthrough();
+
+   auto* convert = sub->add_subcommand("convert", "Rewrite the zlib compressed entries of every log of the state history directory, "
+                                                  "retained logs included, in to the stored entry format: the trace_history, "
+                                                  "chain_state_history, finality_data_history and filter_index_history logs");
+   convert->add_option("--state-history-dir", opt->state_history_dir, "The location of the state history directory holding the logs to convert.")->capture_default_str();
+   convert->add_option("--output-dir", opt->output_dir, "The directory the converted logs are written to, which must not already contain them.")->required();
+
+   convert->callback([this]() {
+      try {
+         int rc = convert();
+         if(rc) throw(CLI::RuntimeError(rc));
+      } catch(...) {
+         print_exception();
+         throw(CLI::RuntimeError(-1));
+      }
+   });
+}
+
+int state_history_actions::convert() {
+   const std::filesystem::path src_dir = opt->state_history_dir;
+   const std::filesystem::path dest_dir = opt->output_dir;
+   if(!std::filesystem::is_directory(src_dir)) {
+      std::cerr << "cannot convert state history, " << src_dir << " is not a directory" << std::endl;
+      return -1;
+   }
+   if(std::filesystem::exists(dest_dir) && std::filesystem::equivalent(src_dir, dest_dir)) {
+      std::cerr << "cannot convert state history in place, --output-dir must differ from --state-history-dir" << std::endl;
+      return -1;
+   }
+
+   // the head logs live in the state history directory and the retained ones in its subdirectories
+   for(const std::filesystem::directory_entry& entry : std::filesystem::recursive_directory_iterator(src_dir)) {
+      if(!entry.is_regular_file() || entry.path().extension() != ".log")
+         continue;
+      const std::filesystem::path relative_stem = std::filesystem::relative(entry.path(), src_dir).replace_extension();
+      const std::filesystem::path dest_stem = dest_dir / relative_stem;
+      std::filesystem::create_directories(dest_stem.parent_path());
+
+      std::cout << "converting " << entry.path() << std::endl;
+      const uint32_t num_entries = state_history::state_history_log::convert_log(src_dir / relative_stem, dest_stem);
+      std::cout << "wrote " << num_entries << " entries to " << std::filesystem::path(dest_stem).replace_extension("log") << std::endl;
+   }
+   return 0;
+}
@@ -0,0 +1,15 @@
+#include "subcommand.hpp"
+
+struct state_history_options {
+   std::string state_history_dir = "state-history";
+   std::string output_dir        = "";
+};
+
+class state_history_actions : public sub_command<state_history_options> {
+public:
+   state_history_actions() : sub_command() {}
+   void setup(CLI::App& app);
+
+   // callbacks
+   int convert();
+};
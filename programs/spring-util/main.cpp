@@ -10,6 +10,7 @@
 #include "actions/chain.hpp"
 #include "actions/generic.hpp"
 #include "actions/snapshot.hpp"
+#include "actions/state_history.hpp"
 
 #include <memory>
 
@@ -42,6 +43,10 @@ int main(int argc, char** argv) {
    auto snapshot_subcommand = std::make_shared<snapshot_actions>();
    snapshot_subcommand->setup(app);
 
+   // state history sc tree
+   auto state_history_subcommand = std::make_shared<state_history_actions>();
+   state_history_subcommand->setup(app);
+
    // chain subcommand from nodeos chain_plugin
    auto chain_subcommand = std::make_shared<chain_actions>();
    chain_subcommand->setup(app);
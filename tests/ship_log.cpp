@@ -1173,32 +1173,47 @@ BOOST_DATA_TEST_CASE(split_forks, bdata::xrange(1u, 6u), fork_size) try {
    }
 } FC_LOG_AND_RETHROW();
 
-//(manually) fabricate a leap 3.x ship log format and make sure it's readable
+//(manually) fabricate a leap 3.x ship log format of zlib compressed entries
+static std::map<block_num_type, sha256> write_old_log_format(const std::filesystem::path& log_path, unsigned begin_block, unsigned end_block) {
+   std::map<block_num_type, sha256> wrote_data_for_blocknum;
+
+   random_access_file file(log_path);
+   for(unsigned blocknum = begin_block; blocknum < end_block; ++blocknum) {
+      const size_t insertpos = file.size();
+      std::pair<state_history::log_header, uint32_t> legacy_header = {};
+      legacy_header.first.block_id = fake_blockid_for_num(blocknum);
+
+      bio::filtering_istreambuf hashed_randomness(sha256_filter() | bio::restrict(random_source(), 0, 128*1024));
+      bio::filtering_ostreambuf output(bio::zlib_compressor() | eosio::detail::counter() | bio::restrict(file.seekable_device(), insertpos + raw::pack_size(legacy_header)));
+      bio::copy(hashed_randomness, output);
+      wrote_data_for_blocknum[blocknum] = hashed_randomness.component<sha256_filter>(0)->enc->result();
+      legacy_header.first.payload_size = output.component<eosio::detail::counter>(1)->characters() + sizeof(decltype(legacy_header.second));
+
+      file.pack_to(legacy_header, insertpos);
+      file.pack_to_end(insertpos);
+   }
+   return wrote_data_for_blocknum;
+}
+
+static void check_log_entries(eosio::state_history::log_catalog& lc, const std::map<block_num_type, sha256>& wrote_data_for_blocknum) {
+   for(const auto& [blocknum, hash] : wrote_data_for_blocknum) {
+      std::optional<state_history::ship_log_entry> entry = lc.get_entry(blocknum);
+      BOOST_REQUIRE(!!entry);
+
+      bio::filtering_ostreambuf hashed_null(sha256_filter() | bio::null_sink());
+      bio::filtering_istreambuf log_stream = entry->get_stream();
+      bio::copy(log_stream, hashed_null);
+      BOOST_REQUIRE_EQUAL(hashed_null.component<sha256_filter>(0)->enc->result(), hash);
+   }
+}
+
 BOOST_AUTO_TEST_CASE(old_log_format) try {
    const temp_directory tmpdir;
 
    const unsigned begin_block = 2;
    const unsigned end_block = 45;
 
-   std::map<block_num_type, sha256> wrote_data_for_blocknum;
-
-   {
-      random_access_file file(tmpdir.path() / "old.log");
-      for(unsigned blocknum = begin_block; blocknum < end_block; ++blocknum) {
-         const size_t insertpos = file.size();
-         std::pair<state_history::log_header, uint32_t> legacy_header = {};
-         legacy_header.first.block_id = fake_blockid_for_num(blocknum);
-
-         bio::filtering_istreambuf hashed_randomness(sha256_filter() | bio::restrict(random_source(), 0, 128*1024));
-         bio::filtering_ostreambuf output(bio::zlib_compressor() | eosio::detail::counter() | bio::restrict(file.seekable_device(), insertpos + raw::pack_size(legacy_header)));
-         bio::copy(hashed_randomness, output);
-         wrote_data_for_blocknum[blocknum] = hashed_randomness.component<sha256_filter>(0)->enc->result();
-         legacy_header.first.payload_size = output.component<eosio::detail::counter>(1)->characters() + sizeof(decltype(legacy_header.second));
-
-         file.pack_to(legacy_header, insertpos);
-         file.pack_to_end(insertpos);
-      }
-   }
+   std::map<block_num_type, sha256> wrote_data_for_blocknum = write_old_log_format(tmpdir.path() / "old.log", begin_block, end_block);
 
    {
       //will regenerate index too
@@ -1207,15 +1222,48 @@ BOOST_AUTO_TEST_CASE(old_log_format) try {
       BOOST_REQUIRE_EQUAL(begin_block, lc.block_range().first);
       BOOST_REQUIRE_EQUAL(end_block, lc.block_range().second);
 
-      for(unsigned i = begin_block; i < end_block; ++i) {
-         std::optional<state_history::ship_log_entry> entry = lc.get_entry(i);
-         BOOST_REQUIRE(!!entry);
+      check_log_entries(lc, wrote_data_for_blocknum);
+   }
+} FC_LOG_AND_RETHROW();
 
-         bio::filtering_ostreambuf hashed_null(sha256_filter() | bio::null_sink());
-         bio::filtering_istreambuf log_stream = entry->get_stream();
-         bio::copy(log_stream, hashed_null);
-         BOOST_REQUIRE_EQUAL(hashed_null.component<sha256_filter>(0)->enc->result(), wrote_data_for_blocknum[i]);
+//zlib entries followed by stored entries in the same log, then the whole log converted to stored entries
+BOOST_AUTO_TEST_CASE(convert_old_log_format) try {
+   const temp_directory tmpdir;
+   const std::filesystem::path converted_dir = tmpdir.path() / "converted";
+   std::filesystem::create_directories(converted_dir);
+
+   const unsigned begin_block = 2;
+   const unsigned old_end_block = 20;
+   const unsigned end_block = 45;
+
+   std::map<block_num_type, sha256> wrote_data_for_blocknum = write_old_log_format(tmpdir.path() / "mixed.log", begin_block, old_end_block);
+
+   {
+      eosio::state_history::log_catalog lc(tmpdir.path(), std::monostate(), "mixed");
+      for(unsigned blocknum = old_end_block; blocknum < end_block; ++blocknum) {
+         lc.pack_and_write_entry(fake_blockid_for_num(blocknum), fake_blockid_for_num(blocknum-1), [&](bio::filtering_ostreambuf& obuf) {
+            bio::filtering_istreambuf hashed_randomness(sha256_filter() | bio::restrict(random_source(), 0, 64*1024));
+            bio::copy(hashed_randomness, obuf);
+            wrote_data_for_blocknum[blocknum] = hashed_randomness.component<sha256_filter>(0)->enc->result();
+         });
       }
+
+      BOOST_REQUIRE(!lc.get_entry(begin_block)->stored);
+      BOOST_REQUIRE(lc.get_entry(old_end_block)->stored);
+      BOOST_REQUIRE_EQUAL(lc.get_entry(old_end_block)->get_uncompressed_size(), 64*1024u);
+      check_log_entries(lc, wrote_data_for_blocknum);
+   }
+
+   BOOST_REQUIRE_EQUAL(state_history::state_history_log::convert_log(tmpdir.path() / "mixed", converted_dir / "mixed"), end_block - begin_block);
+   BOOST_REQUIRE_THROW(state_history::state_history_log::convert_log(tmpdir.path() / "mixed", converted_dir / "mixed"), eosio::chain::plugin_exception);
+
+   {
+      eosio::state_history::log_catalog lc(converted_dir, std::monostate(), "mixed");
+      BOOST_REQUIRE_EQUAL(begin_block, lc.block_range().first);
+      BOOST_REQUIRE_EQUAL(end_block, lc.block_range().second);
+      for(unsigned blocknum = begin_block; blocknum < end_block; ++blocknum)
+         BOOST_REQUIRE(lc.get_entry(blocknum)->stored);
+      check_log_entries(lc, wrote_data_for_blocknum);
    }
 } FC_LOG_AND_RETHROW();
 
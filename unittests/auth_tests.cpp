@@ -97,6 +97,57 @@ BOOST_AUTO_TEST_CASE_TEMPLATE( delegate_auth, TESTER, validating_testers ) { try
 } FC_LOG_AND_RETHROW() }
 
 
+// authorizations checked earlier in the block are reused by later transactions, until a permission changes
+BOOST_AUTO_TEST_CASE_TEMPLATE( cached_delegate_auth, TESTER, validating_testers ) { try {
+   TESTER chain;
+
+   chain.create_accounts( {"alice"_n,"bob"_n,"carol"_n} );
+   auto delegate_to = []( account_name delegate ) {
+      return authority( 1, {}, { { .permission = {delegate, config::active_name}, .weight = 1} } );
+   };
+   chain.set_authority( "alice"_n, config::active_name, delegate_to("bob"_n) );
+   chain.produce_block();
+
+   uint32_t expiration = 60;
+   auto push_reqauth = [&]( const vector<private_key_type>& keys ) {
+      signed_transaction trx;
+      trx.actions.emplace_back( chain.get_action( config::system_account_name, "reqauth"_n,
+                                                  { permission_level{"alice"_n, config::active_name} },
+                                                  fc::mutable_variant_object()("from", "alice") ) );
+      chain.set_transaction_headers( trx, ++expiration ); // a distinct transaction each time
+      for( const auto& key : keys )
+         trx.sign( key, chain.get_chain_id() );
+      return chain.push_transaction( trx );
+   };
+   const auto bob_key   = chain.get_private_key( "bob"_n, "active" );
+   const auto carol_key = chain.get_private_key( "carol"_n, "active" );
+
+   push_reqauth( {bob_key} );
+   push_reqauth( {bob_key} );
+   BOOST_CHECK_THROW( push_reqauth( {carol_key} ), unsatisfied_authorization );
+   // the unused key is still reported when the check is reused
+   BOOST_CHECK_THROW( push_reqauth( {bob_key, carol_key} ), tx_irrelevant_sig );
+   BOOST_CHECK_THROW( push_reqauth( {bob_key, carol_key} ), tx_irrelevant_sig );
+
+   // delegated to carol instead in the same block
+   chain.set_authority( "alice"_n, config::active_name, delegate_to("carol"_n) );
+   BOOST_CHECK_THROW( push_reqauth( {bob_key} ), unsatisfied_authorization );
+   push_reqauth( {carol_key} );
+   chain.produce_block();
+
+   BOOST_CHECK_THROW( push_reqauth( {bob_key} ), unsatisfied_authorization );
+   push_reqauth( {carol_key} );
+   push_reqauth( {carol_key} );
+   chain.produce_block();
+
+   // a permission further down the delegation changes
+   chain.set_authority( "carol"_n, config::active_name, authority( chain.get_public_key( "carol"_n, "new_active" ) ), config::owner_name,
+                        { permission_level{"carol"_n, config::active_name} }, { carol_key } );
+   BOOST_CHECK_THROW( push_reqauth( {carol_key} ), unsatisfied_authorization );
+   push_reqauth( {chain.get_private_key( "carol"_n, "new_active" )} );
+   chain.produce_block();
+} FC_LOG_AND_RETHROW() }
+
 BOOST_AUTO_TEST_CASE_TEMPLATE( update_auths, TESTER, validating_testers ) { try {
    TESTER chain;
 
@@ -457,6 +508,8 @@ try {
    };
 
    create_acc(acc2);
+   // the usage of the accounts is written to their rows when the block is completed
+   chain.produce_block();
 
    const auto &usage = db.get<resource_usage_object,by_owner>(acc1);
 
@@ -466,7 +519,6 @@ try {
    BOOST_TEST(usage.net_usage.average() > 0U);
    BOOST_REQUIRE_EQUAL(usage.cpu_usage.average(), usage2.cpu_usage.average());
    BOOST_REQUIRE_EQUAL(usage.net_usage.average(), usage2.net_usage.average());
-   chain.produce_block();
 
 } FC_LOG_AND_RETHROW() }
 
@@ -4,6 +4,7 @@
 
 #include <eosio/chain/block_log.hpp>
 #include <eosio/chain/block.hpp>
+#include <fstream>
 #include <regex>
 
 using namespace eosio::chain;
@@ -121,4 +122,91 @@ BOOST_FIXTURE_TEST_CASE(extract_to_end, block_log_extract_fixture) try {
 
 } FC_LOG_AND_RETHROW()
 
+BOOST_FIXTURE_TEST_CASE(convert_compressed_round_trip, block_log_extract_fixture) try {
+
+   auto file_content = [](const std::filesystem::path& path) {
+      std::ifstream in(path, std::ios::binary);
+      return std::string(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+   };
+
+   fc::temp_directory compressed_dir;
+   block_log::convert_blocklog(dir.path(), compressed_dir.path(), 9);
+   BOOST_REQUIRE(block_log::is_compressed_log(compressed_dir.path()));
+   block_log::smoke_test(compressed_dir.path(), 1);
+
+   {
+      block_log compressed_log(compressed_dir.path());
+      BOOST_REQUIRE_EQUAL(compressed_log.first_block_num(), 1u);
+      BOOST_REQUIRE_EQUAL(compressed_log.head()->block_num(), 12u);
+      for(uint32_t i = 1; i <= 12; ++i) {
+         BOOST_CHECK(compressed_log.read_block_id_by_num(i) == log->read_block_id_by_num(i));
+         BOOST_CHECK(compressed_log.read_serialized_block_by_num(i) == log->read_serialized_block_by_num(i));
+      }
+      BOOST_CHECK(compressed_log.read_serialized_block_range(1, 12) == log->read_serialized_block_range(1, 12));
+
+      // blocks appended to a compressed log are compressed as well
+      signed_block_ptr p = std::make_shared<signed_block>();
+      p->previous._hash[0] = fc::endian_reverse_u32(12);
+      compressed_log.append(p, p->calculate_id());
+      log->append(p, p->calculate_id());
+      BOOST_CHECK(compressed_log.read_block_id_by_num(13) == p->calculate_id());
+   }
+   BOOST_REQUIRE(block_log::is_compressed_log(compressed_dir.path()));
+
+   fc::temp_directory extract_dir;
+   block_log::extract_block_range(compressed_dir.path(), extract_dir.path(), 3, 7);
+   rename_blocks_files(extract_dir.path());
+   BOOST_REQUIRE(block_log::is_compressed_log(extract_dir.path()));
+   block_log::smoke_test(extract_dir.path(), 1);
+
+   // converting back yields the original log byte for byte
+   fc::temp_directory uncompressed_dir;
+   block_log::convert_blocklog(compressed_dir.path(), uncompressed_dir.path(), 0);
+   BOOST_REQUIRE(!block_log::is_compressed_log(uncompressed_dir.path()));
+   BOOST_CHECK(file_content(uncompressed_dir.path() / "blocks.log") == file_content(dir.path() / "blocks.log"));
+   BOOST_CHECK(file_content(uncompressed_dir.path() / "blocks.index") == file_content(dir.path() / "blocks.index"));
+
+} FC_LOG_AND_RETHROW()
+
+BOOST_AUTO_TEST_CASE(convert_rejects_pruned_log) try {
+
+   fc::temp_directory pruned_dir;
+   {
+      // small threshold so the log is pruned to the last 4 blocks while appending
+      block_log pruned_log(pruned_dir.path(), prune_blocklog_config{.prune_blocks = 4, .prune_threshold = 64});
+      pruned_log.reset(genesis_state(), std::make_shared<signed_block>());
+      for(uint32_t i = 2; i < 13; ++i) {
+         signed_block_ptr p = std::make_shared<signed_block>();
+         p->previous._hash[0] = fc::endian_reverse_u32(i-1);
+         pruned_log.append(p, p->calculate_id());
+      }
+   }
+   BOOST_REQUIRE(block_log::is_pruned_log(pruned_dir.path()));
+
+   fc::temp_directory output_dir;
+   BOOST_CHECK_EXCEPTION(block_log::convert_blocklog(pruned_dir.path(), output_dir.path(), 9), block_log_unsupported_version,
+                         [](const block_log_unsupported_version& e) {
+                            return e.to_detail_string().find("vacuum") != std::string::npos;
+                         });
+   BOOST_CHECK(!std::filesystem::exists(output_dir.path() / "blocks.log"));
+
+   // once vacuumed, the retained blocks are converted
+   { block_log vacuumed(pruned_dir.path()); }
+   BOOST_REQUIRE(!block_log::is_pruned_log(pruned_dir.path()));
+   block_log::convert_blocklog(pruned_dir.path(), output_dir.path(), 9);
+   BOOST_REQUIRE(block_log::is_compressed_log(output_dir.path()));
+   block_log converted(output_dir.path());
+   BOOST_REQUIRE_EQUAL(converted.first_block_num(), 9u);
+   BOOST_REQUIRE_EQUAL(converted.head()->block_num(), 12u);
+
+} FC_LOG_AND_RETHROW()
+
+BOOST_FIXTURE_TEST_CASE(verify_detects_broken_linkage, block_log_extract_fixture) try {
+
+   // the fixture blocks only carry the previous block number, not the previous block id
+   BOOST_CHECK_THROW(block_log::verify_blocklog(dir.path(), 1), block_log_exception);
+   BOOST_CHECK_THROW(block_log::verify_blocklog(dir.path(), 4), block_log_exception);
+
+} FC_LOG_AND_RETHROW()
+
 BOOST_AUTO_TEST_SUITE_END()
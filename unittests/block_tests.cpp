@@ -384,4 +384,60 @@ BOOST_AUTO_TEST_CASE_TEMPLATE(no_onblock_test, T, testers) { try {
 } FC_LOG_AND_RETHROW() }
 
 
+// Verify trx keys of syncing blocks are only recovered within sync_recover_keys_blocks of head, recovery of the
+// following blocks is started as blocks are applied, and applying a block uses the recovery started for it
+BOOST_AUTO_TEST_CASE_TEMPLATE(recover_keys_ahead_of_head_test, T, testers) { try {
+   constexpr uint32_t window = 4;
+   constexpr uint32_t num_blocks = 10;
+
+   T main;
+   fc::temp_directory tempdir;
+   T validator(tempdir, [&](controller::config& cfg) { cfg.sync_recover_keys_blocks = window; }, true);
+   for (uint32_t n = 2; n <= main.control->head_block_num(); ++n)
+      validator.push_block(main.control->fetch_block_by_number(n));
+
+   std::vector<signed_block_ptr> blocks;
+   for (uint32_t i = 0; i < num_blocks; ++i) {
+      main.create_account(account_name("recoverkey" + std::string(1, char('a' + i))));
+      blocks.emplace_back(main.produce_block());
+   }
+   BOOST_REQUIRE(blocks.front()->timestamp.to_time_point() < fc::time_point::now() - fc::seconds(30)); // syncing
+
+   // blocks received while syncing, added to the fork database ahead of being applied
+   const uint32_t head = validator.control->head_block_num();
+   for (const auto& b : blocks)
+      validator.control->create_block_handle_future(b->calculate_id(), b).get();
+
+   auto recovering = validator.control->get_recovering_keys();
+   BOOST_REQUIRE_EQUAL(recovering.size(), window);
+   BOOST_REQUIRE_EQUAL(recovering.begin()->first, head + 1);
+   BOOST_REQUIRE_EQUAL(recovering.rbegin()->first, head + window);
+   transaction_metadata_ptr first_trx = recovering.at(head + 1).at(0).get();
+   recovering.clear();
+
+   uint32_t applied = 0;
+   auto c = validator.control->accepted_block().connect([&](block_signal_params t) {
+      const auto& [ block, id ] = t;
+      const uint32_t block_num = block->block_num();
+      ++applied;
+      // the window moved along with head
+      const auto recovering = validator.control->get_recovering_keys();
+      BOOST_TEST(recovering.size() == std::min(window - 1, head + num_blocks - block_num));
+      for (const auto& [num, futures] : recovering) {
+         BOOST_TEST(num > block_num);
+         BOOST_TEST(num < block_num + window);
+      }
+      // the first block keeps the trx metadata it was applied with, the one recovered ahead only if apply used it
+      if (block_num == head + 2)
+         BOOST_TEST(first_trx.use_count() > 1);
+   });
+
+   validator.push_block(blocks.back());
+   c.disconnect();
+   BOOST_REQUIRE_EQUAL(applied, num_blocks);
+   BOOST_REQUIRE_EQUAL(validator.control->head_block_num(), head + num_blocks);
+   BOOST_TEST(validator.control->get_recovering_keys().empty());
+
+} FC_LOG_AND_RETHROW() }
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,303 @@
+#ifdef EOSIO_EOS_VM_OC_RUNTIME_ENABLED
+
+#include <eosio/chain/webassembly/eos-vm-oc/code_cache.hpp>
+#include <eosio/chain/webassembly/eos-vm-oc/config.hpp>
+#include <eosio/testing/tester.hpp>
+#include <fc/io/cfile.hpp>
+#include <test_contracts.hpp>
+#include <boost/test/unit_test.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <set>
+#include <thread>
+
+using namespace eosio;
+using namespace eosio::chain;
+using namespace eosio::testing;
+using mvo = fc::mutable_variant_object;
+
+BOOST_AUTO_TEST_SUITE(eosvmoc_code_cache_tests)
+
+static wasm_interface::vm_type test_runtime() {
+   fc::temp_directory tempdir;
+   return base_tester::default_config(tempdir).first.wasm_runtime;
+}
+
+// precondition of the tests of the code cache of the eos-vm-oc runtime, which are skipped on the other runtimes
+static boost::test_tools::assertion_result eos_vm_oc_runtime(boost::unit_test::test_unit_id) {
+   boost::test_tools::assertion_result result(test_runtime() == wasm_interface::vm_type::eos_vm_oc);
+   result.message() << "needs the eos-vm-oc runtime";
+   return result;
+}
+
+// precondition of the tests of EOS VM OC tier-up, which needs another base runtime than eos-vm-oc
+static boost::test_tools::assertion_result eos_vm_oc_tierup(boost::unit_test::test_unit_id) {
+   boost::test_tools::assertion_result result(test_runtime() != wasm_interface::vm_type::eos_vm_oc);
+   result.message() << "EOS VM OC tier-up needs another base runtime than eos-vm-oc";
+   return result;
+}
+
+// chain with EOS VM OC tier-up enabled for all contracts, its EOS VM OC config edited by edit_config
+struct tierup_tester : tester {
+   tierup_tester(const fc::temp_directory& tempdir, const std::function<void(eosvmoc::config&)>& edit_config)
+      : tester(
+           tempdir,
+           [&](controller::config& cfg) {
+              cfg.eosvmoc_tierup = wasm_interface::vm_oc_enable::oc_all;
+              edit_config(cfg.eosvmoc_config);
+           },
+           true) {
+      BOOST_REQUIRE(control->is_eos_vm_oc_enabled());
+   }
+};
+
+// opens a chain in tempdir, with the code cache importing import_file if not empty, and runs eosio.token on it if run_token
+static void open_chain(const fc::temp_directory& tempdir, const std::filesystem::path& import_file, bool run_token) {
+   tester chain(
+      tempdir,
+      [&](controller::config& cfg) {
+         cfg.eosvmoc_config.import_file = import_file;
+      },
+      true
+   );
+   BOOST_REQUIRE(chain.control->is_eos_vm_oc_enabled());
+   if (run_token) {
+      chain.create_accounts({"eosio.token"_n});
+      chain.set_code("eosio.token"_n, test_contracts::eosio_token_wasm());
+      chain.set_abi("eosio.token"_n, test_contracts::eosio_token_abi());
+      chain.push_action( "eosio.token"_n, "create"_n, "eosio.token"_n, mvo()
+         ( "issuer", "eosio.token" )
+         ( "maximum_supply", "1000000.00 TOK" )
+      );
+      chain.produce_block();
+   }
+   chain.close();
+}
+
+static std::set<digest_type> exported_code_hashes(const std::filesystem::path& export_file) {
+   fc::datastream<fc::cfile> ds;
+   ds.set_file_path(export_file);
+   ds.open("rb");
+   eosvmoc::code_cache_export_header header;
+   fc::raw::unpack(ds, header);
+   BOOST_REQUIRE_EQUAL(header.id, eosvmoc::code_cache_export_header::id_value);
+
+   std::set<digest_type> result;
+   for (uint32_t i = 0; i < header.num_entries; ++i) {
+      std::vector<char> packed;
+      fc::sha256        checksum;
+      fc::raw::unpack(ds, packed);
+      fc::raw::unpack(ds, checksum);
+      BOOST_REQUIRE(fc::sha256::hash(packed.data(), packed.size()) == checksum);
+      result.insert(fc::raw::unpack<eosvmoc::exported_code>(packed).code_hash);
+   }
+   return result;
+}
+
+// code compiled by one node is exported, imported by another node at startup and executed by it
+BOOST_AUTO_TEST_CASE( export_import, * boost::unit_test::precondition(eos_vm_oc_runtime) ) { try {
+   fc::temp_directory source_dir;
+   open_chain(source_dir, {}, true);
+
+   fc::temp_directory export_dir;
+   const std::filesystem::path export_file = export_dir.path() / "code_cache.export";
+   BOOST_REQUIRE_GT(eosvmoc::export_code_cache(source_dir.path() / config::default_state_dir_name, export_file), 0u);
+   const std::set<digest_type> exported = exported_code_hashes(export_file);
+
+   // all of the export is in the code cache at startup, before any of its code is executed
+   fc::temp_directory import_dir;
+   open_chain(import_dir, export_file, false);
+   const std::filesystem::path import_export_file = export_dir.path() / "import_code_cache.export";
+   BOOST_REQUIRE_EQUAL(eosvmoc::export_code_cache(import_dir.path() / config::default_state_dir_name, import_export_file), exported.size());
+   BOOST_TEST((exported_code_hashes(import_export_file) == exported));
+
+   fc::temp_directory warm_dir;
+   open_chain(warm_dir, export_file, true);
+
+   const std::filesystem::path warm_export_file = export_dir.path() / "warm_code_cache.export";
+   eosvmoc::export_code_cache(warm_dir.path() / config::default_state_dir_name, warm_export_file);
+   const std::set<digest_type> warm_exported = exported_code_hashes(warm_export_file);
+   BOOST_TEST(std::includes(warm_exported.begin(), warm_exported.end(), exported.begin(), exported.end()));
+} FC_LOG_AND_RETHROW() }
+
+// a corrupt export is not loaded, and does not stop the node from starting
+BOOST_AUTO_TEST_CASE( corrupt_import, * boost::unit_test::precondition(eos_vm_oc_runtime) ) { try {
+   fc::temp_directory source_dir;
+   open_chain(source_dir, {}, true);
+
+   fc::temp_directory export_dir;
+   const std::filesystem::path export_file = export_dir.path() / "code_cache.export";
+   eosvmoc::export_code_cache(source_dir.path() / config::default_state_dir_name, export_file);
+
+   {
+      fc::datastream<fc::cfile> f;
+      f.set_file_path(export_file);
+      f.open(fc::cfile::update_rw_mode);
+      f.seek(std::filesystem::file_size(export_file) / 2);
+      char c;
+      f.read(&c, 1);
+      f.seek(std::filesystem::file_size(export_file) / 2);
+      c = ~c;
+      f.write(&c, 1);
+   }
+
+   fc::temp_directory warm_dir;
+   open_chain(warm_dir, export_file, true);
+} FC_LOG_AND_RETHROW() }
+
+// code is only compiled by tier-up once it has been executed compile_threshold times
+BOOST_AUTO_TEST_CASE( compile_threshold, * boost::unit_test::precondition(eos_vm_oc_tierup) ) { try {
+   fc::temp_directory tempdir;
+   tierup_tester chain(tempdir, [](eosvmoc::config& cfg) { cfg.compile_threshold = 3; });
+
+   chain.create_accounts({"tokenacct"_n});
+   const auto wasm = test_contracts::eosio_token_wasm();
+   chain.set_code("tokenacct"_n, wasm);
+   chain.set_abi("tokenacct"_n, test_contracts::eosio_token_abi());
+   const digest_type code_hash = fc::sha256::hash((const char*)wasm.data(), wasm.size());
+
+   auto token_stats = [&]() {
+      const auto stats = chain.control->get_eos_vm_oc_stats(100);
+      auto it = std::find_if(stats.codes.begin(), stats.codes.end(), [&](const auto& c) { return c.code_hash == code_hash; });
+      BOOST_REQUIRE(it != stats.codes.end());
+      return *it;
+   };
+   auto create = [&](const std::string& supply) {
+      chain.push_action("tokenacct"_n, "create"_n, "tokenacct"_n, mvo()("issuer", "tokenacct")("maximum_supply", supply));
+   };
+
+   create("1000.00 AAA");
+   create("1000.00 BBB");
+   BOOST_TEST(token_stats().executions == 2u);
+   BOOST_TEST(!token_stats().cached);
+   auto compiles = [](const wasm_interface::eosvmoc_stats& s) { return s.queued_compiles + s.outstanding_compiles + s.cached_codes; };
+   const uint64_t compiles_before = compiles(chain.control->get_eos_vm_oc_stats(0));
+
+   create("1000.00 CCC");
+   BOOST_TEST(token_stats().executions == 3u);
+   const auto stats = chain.control->get_eos_vm_oc_stats(0);
+   BOOST_TEST(stats.compile_threshold == 3u);
+   BOOST_TEST(stats.codes.empty());
+   BOOST_TEST(compiles(stats) == compiles_before + 1);
+} FC_LOG_AND_RETHROW() }
+
+// code already in the code cache, here imported at startup, is executed by tier-up before it reaches compile_threshold
+BOOST_AUTO_TEST_CASE( cached_code_below_threshold, * boost::unit_test::precondition(eos_vm_oc_tierup) ) { try {
+   fc::temp_directory export_dir;
+   const std::filesystem::path export_file = export_dir.path() / "code_cache.export";
+   const auto wasm = test_contracts::eosio_token_wasm();
+   const digest_type code_hash = fc::sha256::hash((const char*)wasm.data(), wasm.size());
+
+   auto run_token = [&](const fc::temp_directory& tempdir, uint32_t compile_threshold, const std::filesystem::path& import_file,
+                        auto&& check) {
+      tierup_tester chain(tempdir, [&](eosvmoc::config& cfg) {
+         cfg.compile_threshold = compile_threshold;
+         cfg.import_file = import_file;
+      });
+      chain.create_accounts({"tokenacct"_n});
+      chain.set_code("tokenacct"_n, wasm);
+      chain.set_abi("tokenacct"_n, test_contracts::eosio_token_abi());
+      chain.push_action("tokenacct"_n, "create"_n, "tokenacct"_n, mvo()("issuer", "tokenacct")("maximum_supply", "1000.00 TOK"));
+      check(chain);
+      chain.close();
+   };
+   auto is_cached = [&](tester& chain) { return chain.control->get_eos_vm_oc_stats(0).cached_codes > 0; };
+
+   // compile the code on one node, issuing until the compile is done
+   fc::temp_directory source_dir;
+   run_token(source_dir, 1, {}, [&](tester& chain) {
+      for (uint32_t i = 0; i < 200 && !is_cached(chain); ++i) {
+         chain.push_action("tokenacct"_n, "issue"_n, "tokenacct"_n, mvo()("to", "tokenacct")("quantity", "1.00 TOK")("memo", std::to_string(i)));
+         chain.produce_block();
+         std::this_thread::sleep_for(std::chrono::milliseconds(50));
+      }
+      BOOST_REQUIRE(is_cached(chain));
+   });
+   BOOST_REQUIRE_GT(eosvmoc::export_code_cache(source_dir.path() / config::default_state_dir_name, export_file), 0u);
+
+   // the node importing it executes it far below its compile_threshold, without instantiating it on the base runtime
+   fc::temp_directory import_dir;
+   run_token(import_dir, 1000, export_file, [&](tester& chain) {
+      const auto stats = chain.control->get_eos_vm_oc_stats(100);
+      BOOST_REQUIRE_EQUAL(stats.codes.size(), 1u);
+      BOOST_TEST(stats.codes[0].code_hash == code_hash);
+      BOOST_TEST(stats.codes[0].executions == 1u);
+      BOOST_TEST(stats.codes[0].cached);
+      BOOST_TEST(!chain.is_code_cached("tokenacct"_n));
+   });
+} FC_LOG_AND_RETHROW() }
+
+// compiles use the burst threads, except while limited to the compile threads for block production
+BOOST_AUTO_TEST_CASE( compile_burst_threads, * boost::unit_test::precondition(eos_vm_oc_tierup) ) { try {
+   fc::temp_directory tempdir;
+   tierup_tester chain(tempdir, [](eosvmoc::config& cfg) {
+      cfg.compile_threshold = 1;
+      cfg.threads = 1;
+      cfg.burst_threads = 4;
+   });
+
+   BOOST_TEST(chain.control->get_eos_vm_oc_stats(0).compile_threads == 4u);
+   chain.control->limit_eos_vm_oc_compile_threads(true);
+   BOOST_TEST(chain.control->get_eos_vm_oc_stats(0).compile_threads == 1u);
+
+   // each execution of a contract not yet compiled asks for its compile, whether or not the action succeeds
+   const std::vector<std::vector<uint8_t>> wasms = {
+      test_contracts::eosio_token_wasm(), test_contracts::noop_wasm(), test_contracts::payloadless_wasm(),
+      test_contracts::asserter_wasm(), test_contracts::proxy_wasm(), test_contracts::reject_all_wasm(),
+      test_contracts::get_sender_test_wasm(), test_contracts::snapshot_test_wasm()
+   };
+   std::vector<account_name> accounts;
+   for (size_t i = 0; i < wasms.size(); ++i)
+      accounts.push_back(account_name(std::string("occode") + char('a' + i)));
+   chain.create_accounts(accounts);
+   for (size_t i = 0; i < wasms.size(); ++i)
+      chain.set_code(accounts[i], wasms[i]);
+   chain.produce_block();
+
+   auto execute = [&](account_name account) {
+      signed_transaction trx;
+      trx.actions.emplace_back(vector<permission_level>{{account, config::active_name}}, account, "oc"_n, bytes{});
+      chain.set_transaction_headers(trx);
+      trx.sign(chain.get_private_key(account, "active"), chain.control->get_chain_id());
+      try {
+         chain.push_transaction(trx);
+      } catch (const fc::exception&) {
+      }
+   };
+
+   // limited, the compiles beyond the compile threads are queued
+   for (const auto& account : accounts) {
+      execute(account);
+      BOOST_TEST(chain.control->get_eos_vm_oc_stats(0).outstanding_compiles <= 1u);
+   }
+   BOOST_TEST(chain.control->get_eos_vm_oc_stats(0).queued_compiles > 0u);
+
+   // once lifted, the queued compiles fill the burst threads
+   chain.control->limit_eos_vm_oc_compile_threads(false);
+   execute(accounts.front());
+   const auto stats = chain.control->get_eos_vm_oc_stats(0);
+   BOOST_TEST(stats.compile_threads == 4u);
+   BOOST_TEST(stats.outstanding_compiles > 1u);
+   BOOST_TEST(stats.outstanding_compiles == std::min<uint64_t>(4u, stats.outstanding_compiles + stats.queued_compiles));
+} FC_LOG_AND_RETHROW() }
+
+// the burst is opt-in, without burst threads compiles only use the compile threads
+BOOST_AUTO_TEST_CASE( compile_burst_disabled, * boost::unit_test::precondition(eos_vm_oc_tierup) ) { try {
+   fc::temp_directory tempdir;
+   tierup_tester chain(tempdir, [](eosvmoc::config& cfg) {
+      cfg.threads = 2;
+      cfg.burst_threads = 0;
+   });
+
+   BOOST_TEST(chain.control->get_eos_vm_oc_stats(0).compile_threads == 2u);
+   chain.control->limit_eos_vm_oc_compile_threads(true);
+   BOOST_TEST(chain.control->get_eos_vm_oc_stats(0).compile_threads == 2u);
+   chain.control->limit_eos_vm_oc_compile_threads(false);
+   BOOST_TEST(chain.control->get_eos_vm_oc_stats(0).compile_threads == 2u);
+} FC_LOG_AND_RETHROW() }
+
+BOOST_AUTO_TEST_SUITE_END()
+
+#endif
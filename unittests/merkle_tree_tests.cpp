@@ -1,5 +1,6 @@
 #include <eosio/chain/incremental_merkle.hpp>
 #include <eosio/chain/incremental_merkle_legacy.hpp>
+#include <eosio/chain/merkle_builder.hpp>
 #include <boost/test/unit_test.hpp>
 #include <fc/crypto/sha256.hpp>
 
@@ -180,4 +181,52 @@ BOOST_AUTO_TEST_CASE(consistency_over_large_range) {
    }
 }
 
+BOOST_AUTO_TEST_CASE(merkle_builder_matches_calculate_merkle) {
+   constexpr size_t num_digests = 1001ull;
+   const std::vector<digest_type> digests = create_test_digests(num_digests);
+
+   merkle_builder builder(merkle_builder::algorithm::savanna);
+   merkle_builder builder_legacy(merkle_builder::algorithm::legacy);
+   deque<digest_type> ids;
+   BOOST_CHECK_EQUAL(builder.root(ids), digest_type());
+   BOOST_CHECK_EQUAL(builder_legacy.root(ids), digest_type());
+
+   // fold in batches of varying size, as transactions with a varying number of actions would
+   for (size_t i = 0, batch = 1; i < num_digests; batch = batch % 13 + 1) {
+      for (size_t j = 0; j < batch && i < num_digests; ++j, ++i)
+         ids.push_back(digests[i]);
+      builder.update(ids);
+      builder_legacy.update(ids);
+      BOOST_CHECK_EQUAL(builder.num_leaves(), ids.size());
+      BOOST_CHECK_EQUAL(builder.root(ids), calculate_merkle(ids));
+      BOOST_CHECK_EQUAL(builder_legacy.root(ids), calculate_merkle_legacy(ids));
+   }
+}
+
+BOOST_AUTO_TEST_CASE(merkle_builder_resize) {
+   const std::vector<digest_type> digests = create_test_digests(300);
+
+   for (auto alg : {merkle_builder::algorithm::savanna, merkle_builder::algorithm::legacy}) {
+      auto calc = [&](const deque<digest_type>& ids) {
+         return alg == merkle_builder::algorithm::savanna ? calculate_merkle(ids) : calculate_merkle_legacy(ids);
+      };
+
+      merkle_builder builder(alg);
+      deque<digest_type> ids;
+      for (size_t i = 0; i < digests.size(); ++i) {
+         ids.push_back(digests[i]);
+         builder.update(ids);
+         if (i % 17 == 16) {
+            // roll back the last few digests, then append different ones
+            const size_t keep = i - i / 3;
+            ids.resize(keep);
+            builder.resize(keep);
+            BOOST_CHECK_EQUAL(builder.root(ids), calc(ids));
+            ids.push_back(fc::sha256::hash(std::to_string(i)));
+         }
+         BOOST_CHECK_EQUAL(builder.root(ids), calc(ids));
+      }
+   }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
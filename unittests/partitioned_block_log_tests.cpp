@@ -131,6 +131,45 @@ BOOST_AUTO_TEST_CASE_TEMPLATE( test_split_log, T, eosio::testing::testers ) {
    BOOST_CHECK(!chain.control->fetch_block_by_number(160));
 }
 
+BOOST_AUTO_TEST_CASE_TEMPLATE( test_split_log_serialized_blocks, T, eosio::testing::testers ) {
+   fc::temp_directory temp_dir;
+   const auto blog_config = eosio::chain::partitioned_blocklog_config{ .archive_dir        = "archive",
+                                                                       .stride             = 20,
+                                                                       .max_retained_files = 5 };
+
+   T chain(
+         temp_dir,
+         [&](eosio::chain::controller::config& config) { config.blog = blog_config; },
+         true);
+   chain.produce_blocks(150);
+
+   BOOST_CHECK(chain.control->fetch_serialized_block_by_number(40).empty());
+   BOOST_CHECK(chain.control->fetch_serialized_block_by_number(160).empty());
+   // both retained, working and reversible blocks match a repack of the unpacked block
+   for (uint32_t block_num : {41u, 60u, 61u, 100u, 140u, 141u, 145u, chain.control->head_block_num()}) {
+      BOOST_CHECK(chain.control->fetch_serialized_block_by_number(block_num) ==
+                  fc::raw::pack(*chain.control->fetch_block_by_number(block_num)));
+   }
+
+   auto blocks_dir = chain.get_config().blocks_dir;
+   chain.close();
+
+   eosio::chain::block_log blog(blocks_dir, blog_config);
+   const uint32_t last_block_num = blog.head()->block_num();
+
+   // range spanning retained files and the working block file
+   auto blocks = blog.read_serialized_block_range(55, last_block_num);
+   BOOST_REQUIRE_EQUAL(blocks.size(), last_block_num - 55 + 1);
+   for (uint32_t i = 0; i < blocks.size(); ++i) {
+      BOOST_CHECK(blocks[i] == blog.read_serialized_block_by_num(55 + i));
+      BOOST_CHECK(blocks[i] == fc::raw::pack(*blog.read_block_by_num(55 + i)));
+   }
+
+   // range is truncated at the first unavailable block
+   BOOST_CHECK(blog.read_serialized_block_range(30, 50).empty());
+   BOOST_CHECK_EQUAL(blog.read_serialized_block_range(last_block_num - 1, last_block_num + 10).size(), 2u);
+}
+
 BOOST_AUTO_TEST_CASE_TEMPLATE( test_split_log_zero_retained_file, T, eosio::testing::testers ) {
    fc::temp_directory temp_dir;
    T chain(
@@ -488,6 +527,35 @@ BOOST_AUTO_TEST_CASE_TEMPLATE( test_trim_blocklog_front_v2, T, eosio::testing::t
    trim_blocklog_front<T>(2);
 }
 
+BOOST_AUTO_TEST_CASE_TEMPLATE( test_blocklog_parallel_index_and_verify, T, eosio::testing::testers ) {
+   using namespace eosio::chain;
+   T chain;
+   chain.create_account("alice"_n);
+   chain.produce_blocks(100);
+   chain.close();
+
+   auto blocks_dir = chain.get_config().blocks_dir;
+   fc::temp_directory temp;
+   std::filesystem::copy(blocks_dir / "blocks.log", temp.path() / "blocks.log");
+
+   for (uint32_t threads : {2u, 3u, 7u}) {
+      eosio::chain::block_log::construct_index(temp.path() / "blocks.log", temp.path() / "blocks.index", threads);
+      BOOST_CHECK_EQUAL(std::filesystem::file_size(temp.path() / "blocks.index"),
+                        std::filesystem::file_size(blocks_dir / "blocks.index"));
+      eosio::chain::block_log serial_log(blocks_dir);
+      eosio::chain::block_log parallel_log(temp.path());
+      for (uint32_t block_num = 1; block_num <= serial_log.head()->block_num(); ++block_num)
+         BOOST_CHECK_EQUAL(parallel_log.get_block_pos(block_num), serial_log.get_block_pos(block_num));
+   }
+
+   for (uint32_t threads : {1u, 4u, 1000u})
+      BOOST_CHECK_NO_THROW(eosio::chain::block_log::verify_blocklog(blocks_dir, threads));
+
+   fc::temp_directory compressed;
+   eosio::chain::block_log::convert_blocklog(blocks_dir, compressed.path(), 1);
+   BOOST_CHECK_NO_THROW(eosio::chain::block_log::verify_blocklog(compressed.path(), 4));
+}
+
 BOOST_AUTO_TEST_CASE_TEMPLATE( test_blocklog_split_then_merge, T, eosio::testing::testers ) {
 
    T chain;
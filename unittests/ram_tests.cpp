@@ -68,7 +68,7 @@ BOOST_AUTO_TEST_CASE_TEMPLATE( ram_tests, T, eosio_system_testers ) { try {
    auto total = chain.get_total_stake( "testram11111"_n );
    const auto init_bytes =  total["ram_bytes"].as_uint64();
 
-   auto rlm = chain.control->get_resource_limits_manager();
+   const auto& rlm = chain.control->get_resource_limits_manager();
    auto initial_ram_usage = rlm.get_account_ram_usage("testram11111"_n);
 
    // calculate how many more bytes we need to have table_allocation_bytes for database stores
@@ -2,6 +2,7 @@
 
 #include <eosio/chain/config.hpp>
 #include <eosio/chain/resource_limits.hpp>
+#include <eosio/chain/resource_limits_private.hpp>
 #include <eosio/chain/config.hpp>
 #include <eosio/testing/chainbase_fixture.hpp>
 
@@ -27,6 +28,16 @@ class resource_limits_fixture: private chainbase_fixture<1024*1024>, public reso
       chainbase::database::session start_session() {
          return chainbase_fixture::_db->start_undo_session(true);
       }
+
+      // number of resource usage rows in the undo state of the last undo session
+      size_t usage_undo_entries() const {
+         auto undo = chainbase_fixture::_db->get_index<resource_usage_index>().last_undo_session();
+         return std::distance(undo.old_values.begin(), undo.old_values.end());
+      }
+
+      const resource_usage_object& get_usage( const account_name& account ) const {
+         return chainbase_fixture::_db->get<resource_usage_object, by_owner>(account);
+      }
 };
 
 constexpr uint64_t expected_elastic_iterations(uint64_t from, uint64_t to, uint64_t rate_num, uint64_t rate_den ) {
@@ -168,6 +179,7 @@ BOOST_AUTO_TEST_SUITE(resource_limits_test)
                BOOST_REQUIRE_THROW(add_transaction_usage({account}, expected_limits.at(idx), 0, 0), block_resource_exhausted);
             }
             s.undo();
+            undo_transaction_usage();
          }
 
          // use too much, and expect failure;
@@ -208,6 +220,7 @@ BOOST_AUTO_TEST_SUITE(resource_limits_test)
                BOOST_REQUIRE_THROW(add_transaction_usage({account}, 0, expected_limits.at(idx), 0), block_resource_exhausted);
             }
             s.undo();
+            undo_transaction_usage();
          }
 
          // use too much, and expect failure;
@@ -428,5 +441,93 @@ BOOST_AUTO_TEST_SUITE(resource_limits_test)
 
    } FC_LOG_AND_RETHROW()
 
+   /**
+    * Test that the usage of the accounts billed in a block is accumulated in memory, read by the limits, dropped
+    * with a failed transaction or an aborted block, and written to the row of each account in process_block_usage
+    */
+   BOOST_FIXTURE_TEST_CASE(pending_block_usage, resource_limits_fixture) try {
+      const account_name account(1);
+      constexpr uint32_t net_window = config::account_net_usage_average_window_ms / config::block_interval_ms;
+      constexpr uint32_t cpu_window = config::account_cpu_usage_average_window_ms / config::block_interval_ms;
+      constexpr uint32_t slot = 5;
+      initialize_account(account, false);
+      set_account_limits(account, -1, 1, 1, false);
+      process_account_limit_updates();
+
+      const auto net_before = get_usage(account).net_usage;
+      const auto cpu_before = get_usage(account).cpu_usage;
+      usage_accumulator net_expected = net_before;
+      usage_accumulator cpu_expected = cpu_before;
+      auto bill = [&](uint64_t cpu, uint64_t net) {
+         update_account_usage({account}, slot);
+         add_transaction_usage({account}, cpu, net, slot);
+      };
+      auto check_pending = [&]() {
+         const auto cpu_limit = get_account_cpu_limit_ex(account).first;
+         const auto net_limit = get_account_net_limit_ex(account).first;
+         BOOST_REQUIRE_EQUAL(cpu_limit.last_usage_update_time.slot, cpu_expected.last_ordinal);
+         BOOST_REQUIRE_EQUAL(net_limit.last_usage_update_time.slot, net_expected.last_ordinal);
+         BOOST_REQUIRE_EQUAL(cpu_limit.used, (int64_t)impl::integer_divide_ceil((uint128_t)cpu_expected.value_ex * cpu_window, (uint128_t)config::rate_limiting_precision));
+         BOOST_REQUIRE_EQUAL(net_limit.used, (int64_t)impl::integer_divide_ceil((uint128_t)net_expected.value_ex * net_window, (uint128_t)config::rate_limiting_precision));
+         // the row is only written by process_block_usage
+         BOOST_REQUIRE_EQUAL(get_usage(account).cpu_usage.value_ex, cpu_before.value_ex);
+         BOOST_REQUIRE_EQUAL(get_usage(account).net_usage.value_ex, net_before.value_ex);
+      };
+
+      {
+         auto block = start_session();
+         for (uint64_t t = 1; t <= 3; ++t) {
+            auto trx = start_session();
+            bill(100 * t, 200 * t);
+            BOOST_REQUIRE_EQUAL(usage_undo_entries(), 0u);
+            trx.squash();
+            squash_transaction_usage();
+            net_expected.add(0, slot, net_window);
+            cpu_expected.add(0, slot, cpu_window);
+            net_expected.add(200 * t, slot, net_window);
+            cpu_expected.add(100 * t, slot, cpu_window);
+            check_pending();
+         }
+
+         {  // a failed transaction leaves no usage
+            auto trx = start_session();
+            bill(1000, 2000);
+            trx.undo();
+            undo_transaction_usage();
+            check_pending();
+         }
+
+         // nor does a block that is not completed
+         block.undo();
+         undo_block_usage();
+         net_expected = net_before;
+         cpu_expected = cpu_before;
+         check_pending();
+      }
+
+      auto block = start_session();
+      for (uint64_t t = 1; t <= 3; ++t) {
+         auto trx = start_session();
+         bill(100 * t, 200 * t);
+         trx.squash();
+         squash_transaction_usage();
+         net_expected.add(0, slot, net_window);
+         cpu_expected.add(0, slot, cpu_window);
+         net_expected.add(200 * t, slot, net_window);
+         cpu_expected.add(100 * t, slot, cpu_window);
+      }
+      check_pending();
+
+      // written once to the row, with the same values as if each transaction had modified it
+      process_block_usage(slot);
+      BOOST_REQUIRE_EQUAL(usage_undo_entries(), 1u);
+      BOOST_REQUIRE_EQUAL(get_usage(account).net_usage.value_ex, net_expected.value_ex);
+      BOOST_REQUIRE_EQUAL(get_usage(account).net_usage.consumed, net_expected.consumed);
+      BOOST_REQUIRE_EQUAL(get_usage(account).net_usage.last_ordinal, net_expected.last_ordinal);
+      BOOST_REQUIRE_EQUAL(get_usage(account).cpu_usage.value_ex, cpu_expected.value_ex);
+      BOOST_REQUIRE_EQUAL(get_usage(account).cpu_usage.consumed, cpu_expected.consumed);
+      BOOST_REQUIRE_EQUAL(get_usage(account).cpu_usage.last_ordinal, cpu_expected.last_ordinal);
+   } FC_LOG_AND_RETHROW()
+
 
    BOOST_AUTO_TEST_SUITE_END()
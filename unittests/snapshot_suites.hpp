@@ -106,6 +106,44 @@ struct buffered_snapshot_suite {
    }
 };
 
+// the same binary rows in the compressed container, the reference snapshots are converted to and from it
+struct compressed_snapshot_suite : buffered_snapshot_suite {
+   using writer_t = ostream_compressed_snapshot_writer;
+
+   struct writer : public writer_t {
+      writer( const std::shared_ptr<write_storage_t>& storage )
+      :writer_t(*storage)
+      ,storage(storage)
+      {
+
+      }
+
+      std::shared_ptr<write_storage_t> storage;
+   };
+
+   static auto get_writer() {
+      return std::make_shared<writer>(std::make_shared<write_storage_t>());
+   }
+
+   static auto finalize(const std::shared_ptr<writer>& w) {
+      w->finalize();
+      return w->storage->str();
+   }
+
+   static snapshot_t load_from_file(const std::string& filename) {
+      std::istringstream in(buffered_snapshot_suite::load_from_file(filename));
+      std::ostringstream out;
+      convert_snapshot(in, out, snapshot_container::compressed);
+      return out.str();
+   }
+
+   static void write_to_file( const std::string& basename, const snapshot_t& snapshot ) {
+      std::istringstream in(snapshot);
+      std::ostringstream out;
+      convert_snapshot(in, out, snapshot_container::binary);
+      buffered_snapshot_suite::write_to_file(basename, out.str());
+   }
+};
 
 struct json_snapshot_suite {
    using writer_t = ostream_json_snapshot_writer;
@@ -169,4 +207,4 @@ struct json_snapshot_suite {
    }
 };
 
-using snapshot_suites = boost::mpl::list<variant_snapshot_suite, buffered_snapshot_suite, json_snapshot_suite>;
+using snapshot_suites = boost::mpl::list<variant_snapshot_suite, buffered_snapshot_suite, compressed_snapshot_suite, json_snapshot_suite>;
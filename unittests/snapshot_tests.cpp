@@ -755,4 +755,103 @@ BOOST_AUTO_TEST_CASE_TEMPLATE(jumbo_row, SNAPSHOT_SUITE, snapshot_suites)
    jumbo_row_test<savanna_tester, SNAPSHOT_SUITE>();
 }
 
+// writers which do not pack their rows, so the controller writes their sections one row at a time on the calling thread
+struct sequential_ostream_snapshot_writer : ostream_snapshot_writer {
+   using ostream_snapshot_writer::ostream_snapshot_writer;
+protected:
+   bool supports_packed_rows() const override { return false; }
+};
+
+struct sequential_integrity_hash_snapshot_writer : integrity_hash_snapshot_writer {
+   using integrity_hash_snapshot_writer::integrity_hash_snapshot_writer;
+protected:
+   bool supports_packed_rows() const override { return false; }
+};
+
+template<typename TESTER>
+void parallel_sections_test()
+{
+   TESTER chain;
+   chain.create_accounts({"snapshot"_n, "alice"_n, "bob"_n, "carol"_n});
+   chain.produce_block();
+   chain.set_code("snapshot"_n, test_contracts::snapshot_test_wasm());
+   chain.set_abi("snapshot"_n, test_contracts::snapshot_test_abi());
+   chain.produce_block();
+   for (int itr = 0; itr < 8; itr++) {
+      chain.push_action("snapshot"_n, "increment"_n, "snapshot"_n, mutable_variant_object()
+         ( "value", 1 )
+      );
+      chain.produce_block();
+   }
+   chain.control->abort_block();
+
+   std::ostringstream parallel_stream;
+   auto parallel_writer = std::make_shared<ostream_snapshot_writer>(parallel_stream);
+   chain.control->write_snapshot(parallel_writer);
+   parallel_writer->finalize();
+
+   std::ostringstream sequential_stream;
+   auto sequential_writer = std::make_shared<sequential_ostream_snapshot_writer>(sequential_stream);
+   chain.control->write_snapshot(sequential_writer);
+   sequential_writer->finalize();
+
+   BOOST_REQUIRE(parallel_stream.str() == sequential_stream.str());
+
+   fc::sha256::encoder enc;
+   auto hash_writer = std::make_shared<sequential_integrity_hash_snapshot_writer>(enc);
+   chain.control->write_snapshot(hash_writer);
+   hash_writer->finalize();
+   BOOST_REQUIRE_EQUAL(chain.control->calculate_integrity_hash(), enc.result());
+}
+
+BOOST_AUTO_TEST_CASE(parallel_sections)
+{
+   parallel_sections_test<legacy_tester>();
+   parallel_sections_test<savanna_tester>();
+}
+
+// the integrity hash logged on stop packs the sections on the thread pool, which must still be running
+BOOST_AUTO_TEST_CASE(integrity_hash_on_stop)
+{
+   fc::temp_directory tempdir;
+   {
+      savanna_tester chain(tempdir, [](controller::config& cfg) {
+         cfg.integrity_hash_on_stop = true;
+      }, true);
+      chain.create_accounts({"snapshot"_n});
+      chain.produce_block();
+   }
+   // the tester is destroyed without hanging
+}
+
+BOOST_AUTO_TEST_CASE(convert_snapshot_container)
+{
+   savanna_tester chain;
+   chain.create_accounts({"snapshot"_n});
+   chain.produce_block();
+   chain.set_code("snapshot"_n, test_contracts::snapshot_test_wasm());
+   chain.set_abi("snapshot"_n, test_contracts::snapshot_test_abi());
+   chain.produce_block();
+   chain.control->abort_block();
+
+   auto writer = buffered_snapshot_suite::get_writer();
+   chain.control->write_snapshot(writer);
+   const auto binary = buffered_snapshot_suite::finalize(writer);
+
+   std::istringstream binary_in(binary);
+   std::ostringstream compressed_out;
+   convert_snapshot(binary_in, compressed_out, snapshot_container::compressed);
+   const auto compressed = compressed_out.str();
+   BOOST_REQUIRE_LT(compressed.size(), binary.size());
+
+   auto compressed_writer = compressed_snapshot_suite::get_writer();
+   chain.control->write_snapshot(compressed_writer);
+   BOOST_REQUIRE(compressed_snapshot_suite::finalize(compressed_writer) == compressed);
+
+   std::istringstream compressed_in(compressed);
+   std::ostringstream binary_out;
+   convert_snapshot(compressed_in, binary_out, snapshot_container::binary);
+   BOOST_REQUIRE(binary_out.str() == binary);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -4,6 +4,7 @@
 #include <contracts.hpp>
 #include <test_contracts.hpp>
 #include <eosio/state_history/create_deltas.hpp>
+#include <eosio/state_history/filter.hpp>
 #include <eosio/state_history/log_catalog.hpp>
 #include <eosio/state_history/trace_converter.hpp>
 #include <eosio/testing/tester.hpp>
@@ -52,18 +53,25 @@ datastream<ST>& operator>>(datastream<ST>& ds, eosio::state_history::big_vector_
    return ds;
 }
 
-std::vector<table_delta> create_deltas(const chainbase::database& db, bool full_snapshot) {
+std::vector<char> pack_deltas_entry(const chainbase::database& db, bool full_snapshot) {
    namespace bio = boost::iostreams;
    std::vector<char> buf;
    bio::filtering_ostreambuf obuf;
    obuf.push(bio::back_inserter(buf));
    pack_deltas(obuf, db, full_snapshot);
+   return buf;
+}
 
+std::vector<table_delta> unpack_deltas(const std::vector<char>& buf) {
    fc::datastream<const char*> is{buf.data(), buf.size()};
    std::vector<table_delta> result;
    fc::raw::unpack(is, result);
    return result;
 }
+
+std::vector<table_delta> create_deltas(const chainbase::database& db, bool full_snapshot) {
+   return unpack_deltas(pack_deltas_entry(db, full_snapshot));
+}
 }
 
 BOOST_AUTO_TEST_SUITE(test_state_history)
@@ -496,6 +504,55 @@ BOOST_AUTO_TEST_CASE(test_deltas_resources_history) {
       BOOST_REQUIRE(it==v.end());
    }
 
+   BOOST_AUTO_TEST_CASE(test_deltas_filter) {
+      table_deltas_tester chain;
+      chain.produce_block();
+
+      chain.create_account("tester"_n);
+      chain.set_code("tester"_n, test_contracts::get_table_test_wasm());
+      chain.set_abi("tester"_n, test_contracts::get_table_test_abi());
+      chain.produce_block();
+
+      chain.push_action("tester"_n, "addhashobj"_n, "tester"_n, mutable_variant_object()("hashinput", "hello" ));
+      chain.push_action("tester"_n, "addnumobj"_n, "tester"_n, mutable_variant_object()("input", 2));
+
+      using eosio::state_history::delta_filter;
+      const std::vector<char> entry = eosio::state_history::pack_deltas_entry(chain.control->db(), false);
+      const auto index = eosio::state_history::index_deltas(entry);
+      BOOST_REQUIRE_EQUAL(index.size(), eosio::state_history::unpack_deltas(entry).size());
+
+      // only the rows of the numobjs table, the secondary index tables are named numobjs.....1 etc
+      const std::vector<eosio::state_history::delta_index_entry> no_index; // rebuilt from the entry
+      for (const auto* filter_index : {&index, &no_index}) {
+         auto deltas = eosio::state_history::unpack_deltas(
+            eosio::state_history::filter_deltas(entry, *filter_index, {delta_filter{"tester"_n, name{}, "numobjs"_n}}));
+         BOOST_REQUIRE_EQUAL(deltas.size(), 2u);
+         BOOST_REQUIRE_EQUAL(deltas[0].name, "contract_table");
+         BOOST_REQUIRE_EQUAL(deltas[0].rows.obj.size(), 1u);
+         BOOST_REQUIRE_EQUAL(deltas[1].name, "contract_row");
+         BOOST_REQUIRE_EQUAL(deltas[1].rows.obj.size(), 1u);
+         eosio::input_stream stream{deltas[1].rows.obj[0].second.data(), deltas[1].rows.obj[0].second.size()};
+         auto row = std::get<eosio::ship_protocol::contract_row_v0>(eosio::from_bin<eosio::ship_protocol::contract_row>(stream));
+         BOOST_REQUIRE_EQUAL(row.table.to_string(), "numobjs");
+      }
+
+      // any table of the contract
+      auto deltas = eosio::state_history::unpack_deltas(
+         eosio::state_history::filter_deltas(entry, index, {delta_filter{"tester"_n, name{}, name{}}}));
+      auto all_deltas = eosio::state_history::unpack_deltas(entry);
+      std::erase_if(all_deltas, [](const auto& d) { return !d.name.starts_with("contract_"); });
+      BOOST_REQUIRE_EQUAL(deltas.size(), all_deltas.size());
+      for (size_t i = 0; i < deltas.size(); ++i) {
+         BOOST_REQUIRE_EQUAL(deltas[i].name, all_deltas[i].name);
+         BOOST_REQUIRE_EQUAL(deltas[i].rows.obj.size(), all_deltas[i].rows.obj.size());
+      }
+
+      // nothing matches
+      BOOST_REQUIRE(eosio::state_history::unpack_deltas(
+         eosio::state_history::filter_deltas(entry, index, {delta_filter{"eosio"_n, name{}, name{}}})).empty());
+   }
+
+
    BOOST_AUTO_TEST_CASE(test_deltas_contract_several_rows){
       table_deltas_tester chain(setup_policy::full);
 
@@ -614,6 +671,77 @@ BOOST_AUTO_TEST_CASE(test_deltas_resources_history) {
       BOOST_CHECK(std::any_of(partial_txns.begin(), partial_txns.end(), contains_transaction_extensions));
    }
 
+   BOOST_AUTO_TEST_CASE(test_trace_filter) {
+      legacy_tester c;
+      eosio::state_history::trace_converter converter;
+      c.control->applied_transaction().connect(
+            [&](std::tuple<const transaction_trace_ptr&, const packed_transaction_ptr&> t) {
+               converter.add_transaction(std::get<0>(t), std::get<1>(t));
+            });
+      c.control->block_start().connect([&](uint32_t) {
+         converter.cached_traces.clear();
+         converter.onblock_trace.reset();
+      });
+
+      c.create_account("tester"_n);
+      c.set_code("tester"_n, test_contracts::get_table_test_wasm());
+      c.set_abi("tester"_n, test_contracts::get_table_test_abi());
+      c.produce_block();
+
+      c.push_action("tester"_n, "addhashobj"_n, "tester"_n, mutable_variant_object()("hashinput", "hello"));
+      c.push_action("tester"_n, "addnumobj"_n, "tester"_n, mutable_variant_object()("input", 2));
+      c.push_action("tester"_n, "addnumobj"_n, "tester"_n, mutable_variant_object()("input", 3));
+      auto block = c.produce_block();
+
+      auto traces_converter = converter; // same cached traces for the unindexed entry
+      std::vector<eosio::state_history::trace_index_entry> index;
+      const std::vector<char> entry = converter.pack(false, block, &index);
+      BOOST_REQUIRE_EQUAL(index.size(), 4u); // onblock and the 3 transactions
+
+      namespace bio = boost::iostreams;
+      std::vector<char> unindexed;
+      bio::filtering_ostreambuf obuf(bio::back_inserter(unindexed));
+      traces_converter.pack(obuf, false, block);
+      bio::close(obuf);
+      BOOST_REQUIRE(entry == unindexed);
+
+      auto get_traces = [](const std::vector<char>& e) {
+         std::vector<eosio::ship_protocol::transaction_trace> traces;
+         eosio::input_stream bin{e.data(), e.data() + e.size()};
+         BOOST_REQUIRE_NO_THROW(from_bin(traces, bin));
+         return traces;
+      };
+      auto action_name = [](const eosio::ship_protocol::transaction_trace& t) {
+         const auto& trace = std::get<eosio::ship_protocol::transaction_trace_v0>(t);
+         return std::visit([](const auto& a) { return a.act.name.to_string(); }, trace.action_traces.at(0));
+      };
+
+      using eosio::state_history::trace_filter;
+      auto traces = get_traces(eosio::state_history::filter_traces(entry, index, {trace_filter{"tester"_n, name{}, "addnumobj"_n}}));
+      BOOST_REQUIRE_EQUAL(traces.size(), 2u);
+      BOOST_REQUIRE_EQUAL(action_name(traces[0]), "addnumobj");
+      BOOST_REQUIRE_EQUAL(action_name(traces[1]), "addnumobj");
+
+      traces = get_traces(eosio::state_history::filter_traces(entry, index, {trace_filter{name{}, name{}, "onblock"_n},
+                                                                              trace_filter{name{}, "tester"_n, "addhashobj"_n}}));
+      BOOST_REQUIRE_EQUAL(traces.size(), 2u);
+      BOOST_REQUIRE_EQUAL(action_name(traces[0]), "onblock");
+      BOOST_REQUIRE_EQUAL(action_name(traces[1]), "addhashobj");
+
+      // without an index for the entry, it can't be filtered
+      BOOST_REQUIRE_THROW(eosio::state_history::filter_traces(entry, {}, {trace_filter{"tester"_n, name{}, name{}}}),
+                          plugin_exception);
+
+      // ranges past the end of the entry are rejected rather than wrapped around
+      for (auto [offset, size] : {std::pair<uint64_t, uint64_t>{1ull << 32, 1}, {std::numeric_limits<uint64_t>::max(), 2}}) {
+         auto bad_index = index;
+         bad_index.back().offset = offset;
+         bad_index.back().size   = size;
+         BOOST_REQUIRE_THROW(eosio::state_history::filter_traces(entry, bad_index, {trace_filter{"tester"_n, name{}, name{}}}),
+                             plugin_exception);
+      }
+   }
+
 struct state_history_tester_logs  {
    state_history_tester_logs(const std::filesystem::path& dir, const eosio::state_history::state_history_log_config& config)
       : traces_log(dir, config, "trace_history") , chain_state_log(dir, config, "chain_state_history") {}
@@ -758,6 +886,7 @@ void push_blocks( tester& from, tester& to ) {
    }
 }
 
+template <typename StateHistoryTester>
 bool test_fork(uint32_t stride, uint32_t max_retained_files) {
 
    fc::temp_directory state_history_dir;
@@ -769,7 +898,7 @@ bool test_fork(uint32_t stride, uint32_t max_retained_files) {
       .max_retained_files = max_retained_files
    };
 
-   state_history_tester chain1(state_history_dir.path(), config);
+   StateHistoryTester chain1(state_history_dir.path(), config);
    chain1.produce_blocks(2, true);
 
    chain1.create_accounts( {"dan"_n,"sam"_n,"pam"_n} );
@@ -805,19 +934,19 @@ bool test_fork(uint32_t stride, uint32_t max_retained_files) {
 
 BOOST_AUTO_TEST_CASE(test_fork_no_stride) {
    // In this case, the chain fork would NOT trunk the trace log across the stride boundary.
-   BOOST_CHECK(test_fork(UINT32_MAX, 10));
+   BOOST_CHECK(test_fork<state_history_tester>(UINT32_MAX, 10));
 }
 BOOST_AUTO_TEST_CASE(test_fork_with_stride1) {
    // In this case, the chain fork would trunk the trace log across the stride boundary.
    // However, there are still some traces remains after the truncation.
-   BOOST_CHECK(test_fork(10, 10));
+   BOOST_CHECK(test_fork<state_history_tester>(10, 10));
 }
 BOOST_AUTO_TEST_CASE(test_fork_with_stride2) {
    // In this case, the chain fork would trunk the trace log across the stride boundary.
    // However, no existing trace remain after the truncation. Because we only keep a very
    // short history, the create_account_trace is not available to be found. We just need
    // to make sure no exception is throw.
-   BOOST_CHECK_NO_THROW(test_fork(5, 1));
+   BOOST_CHECK_NO_THROW(test_fork<state_history_tester>(5, 1));
 }
 
 BOOST_AUTO_TEST_CASE(test_corrupted_log_recovery) {
@@ -243,6 +243,66 @@ BOOST_AUTO_TEST_CASE( vote_processor_test ) {
    }
 }
 
+BOOST_AUTO_TEST_CASE( vote_processor_batch_test ) {
+   vote_signal_t voted_block;
+
+   std::mutex                    status_mtx;
+   std::map<uint32_t, vote_status> received; // connection_id -> status
+   std::atomic<size_t> signaled = 0;
+   std::mutex                               forkdb_mtx;
+   std::map<block_id_type, block_state_ptr> forkdb;
+
+   voted_block.connect( [&]( const vote_signal_params& vote_signal ) {
+      std::lock_guard g(status_mtx);
+      received[std::get<0>(vote_signal)] = std::get<1>(vote_signal);
+      ++signaled;
+   } );
+
+   vote_processor_t vp{voted_block, [&](const block_id_type& id) -> block_state_ptr {
+      std::lock_guard g(forkdb_mtx);
+      return forkdb[id];
+   }};
+   vp.start(2, [](const fc::exception& e) {
+      edump((e));
+      BOOST_REQUIRE(false);
+   });
+
+   auto gensis = create_genesis_block_state();
+   auto bsp = create_test_block_state(gensis);
+   auto make_vote = [&](size_t i, bool valid) {
+      vote_message_ptr vm = std::make_shared<vote_message>();
+      vm->block_id = bsp->id();
+      vm->strong = valid; // signed with strong_digest
+      vm->finalizer_key = bls_priv_keys.at(i).get_public_key();
+      vm->sig = bls_priv_keys.at(i).sign({(uint8_t*)bsp->strong_digest.data(), (uint8_t*)bsp->strong_digest.data() + bsp->strong_digest.data_size()});
+      return vm;
+   };
+
+   // queue all votes before the block is known so they are verified as one batch, one vote is invalid
+   vp.process_vote_message(1, make_vote(0, true), async_t::yes);
+   vp.process_vote_message(2, make_vote(1, false), async_t::yes);
+   vp.process_vote_message(3, make_vote(2, true), async_t::yes);
+   for (size_t i = 0; i < 50 && vp.index_size() < 3; ++i) {
+      std::this_thread::sleep_for(std::chrono::milliseconds{5});
+   }
+   BOOST_TEST(vp.index_size() == 3u);
+   {
+      std::lock_guard g(forkdb_mtx);
+      forkdb[bsp->id()] = bsp;
+   }
+   vp.notify_new_block(async_t::yes);
+   for (size_t i = 0; i < 50 && signaled.load() < 3; ++i) {
+      std::this_thread::sleep_for(std::chrono::milliseconds{5});
+   }
+   BOOST_TEST(signaled.load() == 3u);
+   std::lock_guard g(status_mtx);
+   BOOST_TEST(vote_status::success == received[1]);
+   BOOST_TEST(vote_status::invalid_signature == received[2]);
+   BOOST_TEST(vote_status::success == received[3]);
+   BOOST_CHECK(bsp->has_voted(bls_priv_keys.at(0).get_public_key()) == vote_status_t::voted);
+   BOOST_CHECK(bsp->has_voted(bls_priv_keys.at(1).get_public_key()) == vote_status_t::not_voted);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 }
@@ -1,10 +1,12 @@
 #include <array>
+#include <future>
 #include <utility>
 
 #include <eosio/chain/abi_serializer.hpp>
 #include <eosio/chain/exceptions.hpp>
 #include <eosio/chain/global_property_object.hpp>
 #include <eosio/chain/resource_limits.hpp>
+#include <eosio/chain/thread_utils.hpp>
 #include <eosio/chain/wasm_eosio_constraints.hpp>
 #include <eosio/chain/wast_to_wasm.hpp>
 #include <eosio/testing/tester.hpp>
@@ -2470,7 +2472,7 @@ BOOST_AUTO_TEST_CASE_TEMPLATE( weighted_net_usage_tests, T, validating_testers )
    };
    BOOST_REQUIRE_EQUAL(true, check(128)); // no limits, should pass
 
-   resource_limits_manager mgr = chain.control->get_mutable_resource_limits_manager();
+   auto& mgr = chain.control->get_mutable_resource_limits_manager();
    mgr.set_account_limits(account, -1, 1, -1, false); // set weight = 1 for account
 
    BOOST_REQUIRE_EQUAL(true, check(128));
@@ -2480,4 +2482,71 @@ BOOST_AUTO_TEST_CASE_TEMPLATE( weighted_net_usage_tests, T, validating_testers )
 
 } FC_LOG_AND_RETHROW()
 
+// Verify a module prefetched for the next block is used by it once instantiated on the thread pool, and that a prefetch
+// still queued on the thread pool does not block the main thread, which instantiates the module itself
+BOOST_AUTO_TEST_CASE( sync_prefetch_instantiation ) try {
+   fc::temp_directory tempdir;
+   tester chain(tempdir, [](controller::config& cfg) {
+      cfg.chain_thread_pool_size = 1; // tasks run in the order they are posted
+      cfg.eosvmoc_tierup = wasm_interface::vm_oc_enable::oc_none;
+   }, true);
+   chain.execute_setup_policy(setup_policy::full);
+   chain.create_accounts( {"prefetcha"_n, "prefetchb"_n} );
+   chain.set_code("prefetcha"_n, test_contracts::noop_wasm());
+   chain.set_code("prefetchb"_n, test_contracts::payloadless_wasm());
+   chain.produce_block();
+   BOOST_REQUIRE(!chain.is_code_cached("prefetcha"_n));
+   BOOST_REQUIRE(!chain.is_code_cached("prefetchb"_n));
+
+   auto& wasmif = chain.control->get_wasm_interface();
+   auto& thread_pool = chain.control->get_thread_pool();
+   auto prefetch = [&](account_name account) {
+      const auto& metadata = chain.control->db().get<account_metadata_object,by_name>(account);
+      wasmif.prefetch(metadata.code_hash, metadata.vm_type, metadata.vm_version, false, chain.control->head_block_num() + 1, thread_pool);
+   };
+   auto is_code_prefetched = [&](account_name account) {
+      const auto& metadata = chain.control->db().get<account_metadata_object,by_name>(account);
+      return wasmif.is_code_prefetched(metadata.code_hash, metadata.vm_type, metadata.vm_version);
+   };
+   // keys recovered up front, pushing the trx does not need the thread pool
+   auto make_trx = [&](account_name account, action_name act_name, bytes data) {
+      signed_transaction trx;
+      trx.actions.emplace_back(vector<permission_level>{{account, config::active_name}}, account, act_name, std::move(data));
+      chain.set_transaction_headers(trx);
+      trx.sign(chain.get_private_key(account, "active"), chain.control->get_chain_id());
+      return transaction_metadata::start_recover_keys(std::make_shared<packed_transaction>(std::move(trx)), thread_pool,
+                                                      chain.control->get_chain_id(), fc::microseconds::maximum(),
+                                                      transaction_metadata::trx_type::input).get();
+   };
+   auto push_trx = [&](const transaction_metadata_ptr& trx) {
+      auto trace = chain.control->push_transaction(trx, fc::time_point::maximum(), fc::microseconds::maximum(), 0, false, 0);
+      BOOST_REQUIRE(trace);
+      BOOST_REQUIRE(!trace->except);
+   };
+
+   auto trx_a = make_trx("prefetcha"_n, "anyaction"_n, fc::raw::pack("prefetcha"_n, std::string("type"), std::string("data")));
+   auto trx_b = make_trx("prefetchb"_n, "doit"_n, bytes{});
+
+   // prefetch done before the code is applied
+   prefetch("prefetcha"_n);
+   post_async_task(thread_pool, []() {}).wait();
+   push_trx(trx_a);
+   BOOST_TEST(chain.is_code_cached("prefetcha"_n));
+   BOOST_TEST(is_code_prefetched("prefetcha"_n));
+
+   // prefetch queued behind a task occupying the thread pool
+   std::promise<void> release;
+   auto blocker = post_async_task(thread_pool, [released = release.get_future().share()]() {
+      return released.wait_for(std::chrono::seconds(30)) == std::future_status::ready;
+   });
+   prefetch("prefetchb"_n);
+   push_trx(trx_b);
+   release.set_value();
+   BOOST_TEST(blocker.get()); // released above, not timed out waiting while the trx waited for the prefetch
+   BOOST_TEST(chain.is_code_cached("prefetchb"_n));
+   BOOST_TEST(!is_code_prefetched("prefetchb"_n));
+
+   chain.produce_block();
+} FC_LOG_AND_RETHROW()
+
 BOOST_AUTO_TEST_SUITE_END()